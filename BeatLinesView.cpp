@@ -1,49 +1,164 @@
 #include "BeatLinesView.h"
 
 #include <QFont>
+#include <QPainter>
 #include <QPen>
-#include <QGraphicsSimpleTextItem>
-#include <QGraphicsLineItem>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
 #include <QDebug>
 #include <qglobal.h>
+#include <cmath>
+
+namespace
+{
+
+/** Assume 4/4 time signature */
+const int BEATS_PER_BAR = 4;
+
+/** Space reserved for bar numbers next to the bar lines, in pixels */
+const QSizeF LABEL_SIZE(40, 14);
+
+}
 
 /**
- * @brief Graphics for a single vertical beat line
+ * @brief Graphics for all vertical beat lines.
+ *
+ * Lines are spaced evenly from the first beat until the end of the time range.
+ * Only the lines within the exposed area are painted.
  */
-class BeatLinesView::BeatLineView : private TransformationNode
+class BeatLinesView::BeatLinesItem : public QGraphicsItem
 {
 public:
-    BeatLineView(float position, int barIndex, int beatIndex, QGraphicsItem* parent);
-    ~BeatLineView();
+    BeatLinesItem(QGraphicsItem* parent);
+    ~BeatLinesItem();
+
+    /**
+     * @brief Set beats to draw
+     * @param timeRange Time range [start, end]
+     * @param firstBeat Time of the first beat
+     * @param beatIncrement Time between drawn beats
+     * @param beatIndexStep Number of beats between drawn beats
+     */
+    void setBeats(RangeF timeRange, double firstBeat, double beatIncrement, int beatIndexStep);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 
 private:
-    QGraphicsSimpleTextItem* m_text;
-    QGraphicsLineItem* m_line;
+    /** @return Size of a device pixel in item coordinates */
+    QSizeF pixelSize() const;
+
+    RangeF m_timeRange;
+    double m_firstBeat;
+    double m_beatIncrement;
+    int m_beatIndexStep;
 };
 
-BeatLinesView::BeatLineView::BeatLineView(float position, int barIndex, int beatIndex, QGraphicsItem* parent)
-: 	TransformationNode(parent),
-    m_text(new QGraphicsSimpleTextItem(QString("%1").arg(barIndex), this)),
-    m_line(new QGraphicsLineItem(0, 0, 0, 1, this))
+BeatLinesView::BeatLinesItem::BeatLinesItem(QGraphicsItem* parent)
+:   QGraphicsItem(parent),
+    m_timeRange(),
+    m_firstBeat(0),
+    m_beatIncrement(0),
+    m_beatIndexStep(1)
 {
-    QFont smaller(m_text->font());
-    smaller.setPointSize(8);
-    m_text->setFont(smaller);
-    m_text->setFlags(QGraphicsItem::ItemIgnoresTransformations);
-    m_text->setVisible(beatIndex == 0); // Show only for first beat in bar
-    m_text->setPos(0, 1);
+    // Paint only the exposed lines
+    setFlags(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+BeatLinesView::BeatLinesItem::~BeatLinesItem()
+{}
+
+void BeatLinesView::BeatLinesItem::setBeats(RangeF timeRange, double firstBeat, double beatIncrement, int beatIndexStep)
+{
+    prepareGeometryChange();
+    m_timeRange = timeRange;
+    m_firstBeat = firstBeat;
+    m_beatIncrement = beatIncrement;
+    m_beatIndexStep = beatIndexStep;
+    update();
+}
+
+QRectF BeatLinesView::BeatLinesItem::boundingRect() const
+{
+    if (!m_timeRange.isValid() || m_beatIncrement <= 0)
+        return QRectF();
+
+    // Lines span [0, 1], bar numbers are fixed size in pixels next to them
+    const QSizeF pixel = pixelSize();
+    const qreal labelWidth = LABEL_SIZE.width() * pixel.width();
+    const qreal labelHeight = LABEL_SIZE.height() * pixel.height();
+    return QRectF(QPointF(m_timeRange.min, -labelHeight), QPointF(m_timeRange.max + labelWidth, 1 + labelHeight));
+}
+
+void BeatLinesView::BeatLinesItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+
+    if (m_beatIncrement <= 0)
+        return;
+
+    // Beats within the exposed area, including the ones whose bar number reaches it
+    const qreal labelWidth = LABEL_SIZE.width() * pixelSize().width();
+    const qreal exposedStart = qMax<qreal>(option->exposedRect.left() - labelWidth, m_timeRange.min);
+    const qreal exposedEnd = qMin<qreal>(option->exposedRect.right(), m_timeRange.max);
+    const int firstIndex = qMax(static_cast<int>(std::ceil((exposedStart - m_firstBeat) / m_beatIncrement)), 0);
+
+    QVector<QLineF> barLines;
+    QVector<QLineF> beatLines;
+    QVector<QPair<qreal, int>> barNumbers;
+    for (int i = firstIndex; ; ++i)
+    {
+        const qreal beat = m_firstBeat + i * m_beatIncrement;
+        if (beat > exposedEnd || beat >= m_timeRange.max)
+            break;
+
+        // Emphasize the first beat in bar
+        const int beatNumber = i * m_beatIndexStep;
+        if (beatNumber % BEATS_PER_BAR == 0)
+        {
+            barLines.append(QLineF(beat, 0, beat, 1));
+            barNumbers.append(qMakePair(beat, beatNumber / BEATS_PER_BAR));
+        }
+        else
+        {
+            beatLines.append(QLineF(beat, 0, beat, 1));
+        }
+    }
+
+    painter->save();
 
     QPen pen(Qt::DotLine);
     pen.setCosmetic(true);
-    // Emphasize the first beat in bar
-    if (beatIndex == 0) pen.setStyle(Qt::SolidLine);
-    m_line->setPen(pen);
+    painter->setPen(pen);
+    painter->drawLines(beatLines);
+
+    pen.setStyle(Qt::SolidLine);
+    painter->setPen(pen);
+    painter->drawLines(barLines);
+
+    // Bar numbers are fixed size, draw in device coordinates
+    const QTransform deviceTransform = painter->worldTransform();
+    painter->resetTransform();
+    QFont smaller(painter->font());
+    smaller.setPointSize(8);
+    painter->setFont(smaller);
+    for (const auto& barNumber : barNumbers)
+    {
+        const QRectF labelRect(deviceTransform.map(QPointF(barNumber.first, 1)), LABEL_SIZE);
+        painter->drawText(labelRect, Qt::AlignLeft | Qt::AlignTop, QString::number(barNumber.second));
+    }
 
-    setPos(position, 0);
+    painter->restore();
 }
 
-BeatLinesView::BeatLineView::~BeatLineView()
-{}
+QSizeF BeatLinesView::BeatLinesItem::pixelSize() const
+{
+    // Scene is not scaled by the view, only flipped
+    const QTransform transform = sceneTransform();
+    const qreal width = std::fabs(transform.m11());
+    const qreal height = std::fabs(transform.m22());
+    return QSizeF(width > 0.0 ? 1.0 / width : 1.0, height > 0.0 ? 1.0 / height : 1.0);
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -54,7 +169,8 @@ BeatLinesView::BeatLinesView(RangeF timeRange, float timeScale, double beatOffse
     m_timeScale(timeScale),
     m_beatOffset(beatOffset),
     m_bpm(bpm),
-    m_snapGridRect(QRectF())
+    m_snapGridRect(QRectF()),
+    m_beatLines(new BeatLinesItem(this))
 {
     // Set transformation to scale y-axis to [0, 1] range
     qreal maxi = 1;
@@ -102,12 +218,10 @@ void BeatLinesView::setBpm(double bpm)
 
 void BeatLinesView::updateBeatLines()
 {
-    // Remove old lines
-    m_beatLines.clear();
-
     if (m_bpm <= 0)
     {
         qWarning() << "Invalid bpm for beat line drawing:" << m_bpm;
+        m_beatLines->setBeats(RangeF(), 0, 0, 1);
         return;
     }
 
@@ -120,8 +234,6 @@ void BeatLinesView::updateBeatLines()
     // Adjust so that first beats are always shown before intra-bar beats (beats 2,3,4).
     int beatIndexStep = qMax(minPointsBetweenBeats / beatIntervalInPoints, 1.0);
 
-    // Assume 4/4 time signature
-    const int beatsPerBar = 4;
     switch (beatIndexStep)
     {
     case 1:
@@ -140,26 +252,15 @@ void BeatLinesView::updateBeatLines()
         break;
     }
 
-    int barIndex = 0;
-    int beatIndex = 0;
     const float beatIncrement = beatStepInSecs * beatIndexStep;
-
-    QGraphicsItem* thisAsGraphicsItem = this;
-    for (float beat = m_timeRange.min + m_beatOffset; beat < m_timeRange.max; beat += beatIncrement)
-    {
-        m_beatLines.push_back(std::make_shared<BeatLineView>(beat, barIndex, beatIndex, thisAsGraphicsItem));
-
-        // Advance beats
-        beatIndex += beatIndexStep;
-        if ((beatIndex % beatsPerBar) == 0)
-        {
-            // If moving to a new bar advance the bar index
-            barIndex += beatIndex / beatsPerBar;
-            beatIndex = 0;
-        }
-    }
+    m_beatLines->setBeats(m_timeRange, m_timeRange.min + m_beatOffset, beatIncrement, beatIndexStep);
 
     // Calculate new snap grid (horizontal snap at every visible beat, no vertical snap)
-    m_snapGridRect = QRectF(m_beatOffset, 0, beatIncrement, 0);
+    // Scrolling keeps the grid, only notify when it actually changes
+    const QRectF snapGridRect(m_beatOffset, 0, beatIncrement, 0);
+    if (snapGridRect == m_snapGridRect)
+        return;
+
+    m_snapGridRect = snapGridRect;
     emit snapGridChanged(m_snapGridRect);
 }
@@ -4,7 +4,6 @@
 #include <QObject>
 #include "TransformationNode.h"
 #include "RangeF.h"
-#include <memory>
 
 QT_BEGIN_NAMESPACE
 class QGraphicsItem;
@@ -17,6 +16,9 @@ QT_END_NAMESPACE
  * interval defined by the bpm.
  *
  * Time scale can affect how low level beats are visible.
+ *
+ * All lines are painted by a single graphics item, which draws only the beats within
+ * the exposed area. Changing the time range, scale or tempo allocates no items.
  */
 class BeatLinesView :
     public QObject,
@@ -78,8 +80,8 @@ private:
     double m_bpm; ///< Beats per minute
     QRectF m_snapGridRect;
 
-    class BeatLineView;
-    QList<std::shared_ptr<BeatLineView>> m_beatLines;
+    class BeatLinesItem;
+    BeatLinesItem* m_beatLines; ///< Item painting the lines, owned by this graphics item
 };
 
 #endif // BEATLINESVIEW_H
@@ -0,0 +1,138 @@
+#include "CurveGeometry.h"
+#include <QDebug>
+#include <assert.h>
+
+namespace
+{
+
+/** Geometries by model. Geometries remove themselves when the last holder releases them. */
+QHash<const CurveModel*, std::weak_ptr<CurveGeometry>>& registry()
+{
+    static QHash<const CurveModel*, std::weak_ptr<CurveGeometry>> geometries;
+    return geometries;
+}
+
+}
+
+std::shared_ptr<CurveGeometry> CurveGeometry::forModel(std::shared_ptr<CurveModel> model)
+{
+    assert(model);
+
+    std::shared_ptr<CurveGeometry> geometry = registry().value(model.get()).lock();
+    if (!geometry)
+    {
+        geometry.reset(new CurveGeometry(model));
+        registry().insert(model.get(), geometry);
+    }
+    return geometry;
+}
+
+CurveGeometry::CurveGeometry(std::shared_ptr<CurveModel> model)
+:   m_model(model),
+    m_pointCount(static_cast<int>(model->spline().data().size()))
+{
+    connect(m_model.get(), &CurveModel::splineChanged, this, &CurveGeometry::updateSegments);
+}
+
+CurveGeometry::~CurveGeometry()
+{
+    registry().remove(m_model.get());
+}
+
+int CurveGeometry::segmentCount() const
+{
+    return qMax(m_pointCount - 1, 0);
+}
+
+void CurveGeometry::useDetailLevel(const QObject* user, DetailLevel level)
+{
+    m_users.insert(user, level);
+
+    if (!m_levels.contains(level))
+        m_levels.insert(level, QVector<QPolygonF>(segmentCount()));
+
+    m_recentLevels.removeOne(level);
+    m_recentLevels.append(level);
+
+    dropUnusedLevels(MAX_UNUSED_DETAIL_LEVELS);
+}
+
+void CurveGeometry::releaseDetailLevel(const QObject* user)
+{
+    m_users.remove(user);
+    dropUnusedLevels(MAX_UNUSED_DETAIL_LEVELS);
+}
+
+QVector<QPolygonF> CurveGeometry::segments(DetailLevel level) const
+{
+    return m_levels.value(level);
+}
+
+void CurveGeometry::storeSegments(DetailLevel level, int first, const QVector<QPolygonF>& segments)
+{
+    auto levelIter = m_levels.find(level);
+    if (levelIter == m_levels.end())
+        return;
+
+    if (first < 0 || first + segments.size() > levelIter->size())
+    {
+        qWarning() << "Tessellated segments" << first << segments.size() << "outside the spline" << levelIter->size();
+        return;
+    }
+
+    std::copy(segments.constBegin(), segments.constEnd(), levelIter->begin() + first);
+}
+
+void CurveGeometry::updateSegments(int index, int removedCount, int insertedCount, RangeF timeRange)
+{
+    // Segments from the one ending at the first changed point until the one starting
+    // from the last changed point are replaced
+    const int oldSegmentCount = segmentCount();
+    m_pointCount += insertedCount - removedCount;
+    const int newSegmentCount = segmentCount();
+
+    const int first = qMax(index - 1, 0);
+    const int oldEnd = qMax(qMin(index + removedCount, oldSegmentCount), first);
+    const int newEnd = qMax(qMin(index + insertedCount, newSegmentCount), first);
+
+    for (QVector<QPolygonF>& levelSegments : m_levels)
+    {
+        levelSegments.remove(first, oldEnd - first);
+        levelSegments.insert(first, newEnd - first, QPolygonF());
+    }
+
+    // Tangents of the neighbouring points change too, which affect the segments on both sides of them
+    invalidateSegments(index - 2, index + insertedCount);
+
+    emit changed(qMax(index - 2, 0), timeRange);
+}
+
+void CurveGeometry::invalidateSegments(int first, int last)
+{
+    // Curve changed, tessellation of levels not in use is outdated
+    dropUnusedLevels(0);
+
+    for (QVector<QPolygonF>& levelSegments : m_levels)
+    {
+        const int end = qMin(last, levelSegments.size() - 1);
+        for (int i = qMax(first, 0); i <= end; ++i)
+            levelSegments[i] = QPolygonF();
+    }
+}
+
+void CurveGeometry::dropUnusedLevels(int maxUnused)
+{
+    int unused = m_recentLevels.size() - m_users.values().toSet().size();
+    for (auto it = m_recentLevels.begin(); unused > maxUnused && it != m_recentLevels.end();)
+    {
+        if (m_users.key(*it, nullptr) != nullptr)
+        {
+            ++it;
+            continue;
+        }
+
+        m_levels.remove(*it);
+        it = m_recentLevels.erase(it);
+        --unused;
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef CURVEGEOMETRY_H
+#define CURVEGEOMETRY_H
+
+#include "CurveModel.h"
+#include "RangeF.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPolygonF>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Tessellated spline segments of a curve model, shared by all views of the curve.
+ *
+ * Each model has at most one geometry, which follows the spline changes of the model.
+ * Views showing the same curve in different editors thus tessellate the curve only once.
+ *
+ * Tessellation is cached per detail level (time and value scale of the tessellation).
+ * A view tells which level it uses; levels in use are kept up to date with point changes.
+ * A few recently used levels are kept for zooming back and dropped when the curve changes.
+ *
+ * Segment i spans spline points i and i + 1. Empty polygon marks a segment that needs
+ * tessellation.
+ */
+class CurveGeometry : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Tessellation time and value scale */
+    using DetailLevel = QPair<float, float>;
+
+    /** Maximum number of detail levels kept without a view using them */
+    static const int MAX_UNUSED_DETAIL_LEVELS = 3;
+
+    /**
+     * @brief Get the geometry of a curve, created on first use.
+     * @param model Curve model
+     * @return Geometry shared by all callers holding it for the same model
+     */
+    static std::shared_ptr<CurveGeometry> forModel(std::shared_ptr<CurveModel> model);
+
+    /** Destructor */
+    ~CurveGeometry();
+
+    /** @return Number of spline segments */
+    int segmentCount() const;
+
+    /**
+     * @brief Select the detail level a view uses. The previous level of the view may be dropped.
+     * @param user The view
+     * @param level Detail level
+     */
+    void useDetailLevel(const QObject* user, DetailLevel level);
+
+    /**
+     * @brief Stop using a detail level.
+     * @param user The view
+     */
+    void releaseDetailLevel(const QObject* user);
+
+    /**
+     * @param level Detail level
+     * @return Cached segments of a level, empty if the level is not in use
+     */
+    QVector<QPolygonF> segments(DetailLevel level) const;
+
+    /**
+     * @brief Store tessellated segments. Ignored if the level is no longer cached.
+     * @param level Detail level of the tessellation
+     * @param first Index of the first segment
+     * @param segments Segments starting from first
+     */
+    void storeSegments(DetailLevel level, int first, const QVector<QPolygonF>& segments);
+
+signals:
+    /**
+     * @brief Spline changed. Emitted before views of the model get the point change.
+     * @param firstSegment Index of the first changed segment, segments before it keep their index and tessellation
+     * @param timeRange Time range of the changed segments
+     */
+    void changed(int firstSegment, RangeF timeRange);
+
+private slots:
+    /** Spline points of the model changed, @see CurveModel::splineChanged */
+    void updateSegments(int index, int removedCount, int insertedCount, RangeF timeRange);
+
+private:
+    /**
+     * @brief Construct CurveGeometry for the current model spline.
+     * @param model Curve model
+     */
+    explicit CurveGeometry(std::shared_ptr<CurveModel> model);
+
+    /**
+     * @brief Mark segments of all cached levels to be tessellated again. Drops the unused levels.
+     * @param first First segment index, clamped to existing segments
+     * @param last Last segment index, clamped to existing segments
+     */
+    void invalidateSegments(int first, int last);
+
+    /** Drop least recently used levels no view is using, leaving at most maxUnused of them */
+    void dropUnusedLevels(int maxUnused);
+
+    std::shared_ptr<CurveModel> m_model;
+    int m_pointCount; ///< Number of spline points the cached segments are for
+
+    QHash<DetailLevel, QVector<QPolygonF>> m_levels; ///< Segment tessellation per detail level
+    QHash<const QObject*, DetailLevel> m_users; ///< Detail level used by each view
+    QList<DetailLevel> m_recentLevels; ///< Cached levels, most recently used last
+};
+
+#endif // CURVEGEOMETRY_H
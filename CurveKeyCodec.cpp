@@ -0,0 +1,472 @@
+#include "CurveKeyCodec.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/** Encoding format version */
+const quint8 FORMAT_VERSION = 1;
+
+/** Curve kinds */
+const quint8 KIND_SPLINE = 0;
+const quint8 KIND_STEP = 1;
+
+/** Time storage modes */
+const quint8 TIMES_AS_FLOATS = 0;
+const quint8 TIMES_ON_GRID = 1;
+
+/** Flags for stored Kochanek-Bartels parameters */
+const quint8 HAS_TENSION = 0x1;
+const quint8 HAS_BIAS = 0x2;
+const quint8 HAS_CONTINUITY = 0x4;
+
+/** Number of bits used for the trailing zero count of a float XOR delta */
+const int TRAILING_ZERO_BITS = 6;
+
+quint32 floatBits(float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(quint32 bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+quint64 zigZag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unZigZag(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+int trailingZeros(quint32 value)
+{
+    if (value == 0)
+        return 32;
+
+    int count = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+}
+
+/** Time of a grid tick. Encoder and decoder must use exactly the same arithmetic. */
+float tickTime(const CurveKeyCodec::TimeGrid& grid, qint64 tick)
+{
+    return static_cast<float>(grid.origin + static_cast<double>(tick) * grid.tickLength);
+}
+
+/** Appends encoded data to a byte array */
+class Writer
+{
+public:
+    explicit Writer(int expectedSize)
+    {
+        m_data.reserve(expectedSize);
+    }
+
+    void writeByte(quint8 value)
+    {
+        m_data.append(static_cast<char>(value));
+    }
+
+    void writeVarint(quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            writeByte(static_cast<quint8>(value | 0x80));
+            value >>= 7;
+        }
+        writeByte(static_cast<quint8>(value));
+    }
+
+    void writeDouble(double value)
+    {
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i)
+            writeByte(static_cast<quint8>(bits >> (8 * i)));
+    }
+
+    void writeFloat(float value)
+    {
+        const quint32 bits = floatBits(value);
+        for (int i = 0; i < 4; ++i)
+            writeByte(static_cast<quint8>(bits >> (8 * i)));
+    }
+
+    /** Write float as XOR with the previous float, trailing zero bits of the XOR elided */
+    void writeFloatDelta(float value, quint32& previousBits)
+    {
+        const quint32 bits = floatBits(value);
+        const quint32 delta = bits ^ previousBits;
+        const int zeros = trailingZeros(delta);
+        const quint64 significant = zeros < 32 ? (delta >> zeros) : 0;
+        writeVarint((significant << TRAILING_ZERO_BITS) | static_cast<quint64>(zeros));
+        previousBits = bits;
+    }
+
+    const QByteArray& data() const
+    {
+        return m_data;
+    }
+
+private:
+    QByteArray m_data;
+};
+
+/** Reads encoded data from a byte array. Once a read fails all following reads fail. */
+class Reader
+{
+public:
+    explicit Reader(const QByteArray& data)
+      : m_pos(reinterpret_cast<const quint8*>(data.constData())),
+        m_end(m_pos + data.size()),
+        m_ok(true)
+    {
+    }
+
+    bool ok() const
+    {
+        return m_ok;
+    }
+
+    bool atEnd() const
+    {
+        return m_pos == m_end;
+    }
+
+    quint64 bytesLeft() const
+    {
+        return static_cast<quint64>(m_end - m_pos);
+    }
+
+    quint8 readByte()
+    {
+        if (!m_ok || m_pos == m_end)
+        {
+            m_ok = false;
+            return 0;
+        }
+        return *m_pos++;
+    }
+
+    quint64 readVarint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const quint8 byte = readByte();
+            value |= static_cast<quint64>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+
+        // Too long
+        m_ok = false;
+        return 0;
+    }
+
+    double readDouble()
+    {
+        quint64 bits = 0;
+        for (int i = 0; i < 8; ++i)
+            bits |= static_cast<quint64>(readByte()) << (8 * i);
+
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    float readFloat()
+    {
+        quint32 bits = 0;
+        for (int i = 0; i < 4; ++i)
+            bits |= static_cast<quint32>(readByte()) << (8 * i);
+        return bitsToFloat(bits);
+    }
+
+    float readFloatDelta(quint32& previousBits)
+    {
+        const quint64 encoded = readVarint();
+        const int zeros = static_cast<int>(encoded & ((1 << TRAILING_ZERO_BITS) - 1));
+        const quint64 significant = encoded >> TRAILING_ZERO_BITS;
+        if (zeros > 32 || (zeros == 32 && significant != 0) || significant > 0xffffffffull)
+        {
+            m_ok = false;
+            return 0.0f;
+        }
+
+        const quint32 delta = zeros < 32 ? static_cast<quint32>(significant << zeros) : 0;
+        previousBits ^= delta;
+        return bitsToFloat(previousBits);
+    }
+
+private:
+    const quint8* m_pos;
+    const quint8* m_end;
+    bool m_ok;
+};
+
+/**
+ * Quantize key times to grid ticks.
+ * @return False if some time is not exactly on the grid.
+ */
+template <typename Key>
+bool quantizeTimes(const QVector<Key>& keys, const CurveKeyCodec::TimeGrid& grid, QVector<qint64>& ticks)
+{
+    if (!grid.isValid())
+        return false;
+
+    // Keep tick arithmetic exact in doubles
+    const double maxTick = 9007199254740992.0; // 2^53
+
+    ticks.reserve(keys.size());
+    for (const Key& key : keys)
+    {
+        if (!std::isfinite(key.time))
+            return false;
+
+        const double tick = std::floor((key.time - grid.origin) / grid.tickLength + 0.5);
+        if (!(std::fabs(tick) < maxTick))
+            return false;
+
+        ticks.push_back(static_cast<qint64>(tick));
+        if (floatBits(tickTime(grid, ticks.back())) != floatBits(key.time))
+            return false;
+    }
+
+    return true;
+}
+
+template <typename Key>
+void writeHeaderAndTimes(Writer& writer, quint8 kind, const QVector<Key>& keys, const CurveKeyCodec::TimeGrid& grid)
+{
+    QVector<qint64> ticks;
+    const bool onGrid = quantizeTimes(keys, grid, ticks);
+
+    writer.writeByte(FORMAT_VERSION);
+    writer.writeByte(kind);
+    writer.writeByte(onGrid ? TIMES_ON_GRID : TIMES_AS_FLOATS);
+    writer.writeVarint(static_cast<quint64>(keys.size()));
+
+    if (onGrid)
+    {
+        writer.writeDouble(grid.origin);
+        writer.writeDouble(grid.tickLength);
+
+        qint64 previous = 0;
+        for (qint64 tick : ticks)
+        {
+            writer.writeVarint(zigZag(tick - previous));
+            previous = tick;
+        }
+    }
+    else
+    {
+        quint32 previous = 0;
+        for (const Key& key : keys)
+            writer.writeFloatDelta(key.time, previous);
+    }
+}
+
+/** @return False if the header is corrupt or for an unexpected curve kind */
+template <typename Key>
+bool readHeaderAndTimes(Reader& reader, quint8 expectedKind, QVector<Key>& keys)
+{
+    if (reader.readByte() != FORMAT_VERSION || reader.readByte() != expectedKind)
+        return false;
+
+    const quint8 timeMode = reader.readByte();
+    const quint64 count = reader.readVarint();
+
+    // Every key takes at least a byte, don't trust larger counts
+    if (!reader.ok() || count > reader.bytesLeft() || count > static_cast<quint64>(std::numeric_limits<int>::max()))
+        return false;
+
+    keys.resize(static_cast<int>(count));
+
+    if (timeMode == TIMES_ON_GRID)
+    {
+        CurveKeyCodec::TimeGrid grid;
+        grid.origin = reader.readDouble();
+        grid.tickLength = reader.readDouble();
+
+        qint64 tick = 0;
+        for (Key& key : keys)
+        {
+            tick += unZigZag(reader.readVarint());
+            key.time = tickTime(grid, tick);
+        }
+    }
+    else if (timeMode == TIMES_AS_FLOATS)
+    {
+        quint32 previous = 0;
+        for (Key& key : keys)
+            key.time = reader.readFloatDelta(previous);
+    }
+    else
+    {
+        return false;
+    }
+
+    return reader.ok();
+}
+
+} // anonymous namespace
+
+CurveKeyCodec::TimeGrid CurveKeyCodec::TimeGrid::fromTempo(double beatOffset, double bpm)
+{
+    if (!(bpm > 0.0))
+        return TimeGrid();
+
+    const double beatLength = 60.0 / bpm;
+    return TimeGrid(beatOffset, beatLength / TICKS_PER_BEAT);
+}
+
+QByteArray CurveKeyCodec::encode(const QVector<SplineKey>& keys, const TimeGrid& grid)
+{
+    // Typically a couple of bytes per time and value
+    Writer writer(32 + keys.size() * 6);
+    writeHeaderAndTimes(writer, KIND_SPLINE, keys, grid);
+
+    quint32 previous = 0;
+    for (const SplineKey& key : keys)
+        writer.writeFloatDelta(key.value, previous);
+
+    // Parameters only for keys that have non-default ones
+    int paramCount = 0;
+    for (const SplineKey& key : keys)
+        if (key.tension != 0.0f || key.bias != 0.0f || key.continuity != 0.0f)
+            ++paramCount;
+
+    writer.writeVarint(static_cast<quint64>(paramCount));
+
+    int previousIndex = 0;
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        const SplineKey& key = keys[i];
+        const quint8 flags =
+            (key.tension != 0.0f ? HAS_TENSION : 0) |
+            (key.bias != 0.0f ? HAS_BIAS : 0) |
+            (key.continuity != 0.0f ? HAS_CONTINUITY : 0);
+        if (!flags)
+            continue;
+
+        writer.writeVarint(static_cast<quint64>(i - previousIndex));
+        writer.writeByte(flags);
+        if (flags & HAS_TENSION)
+            writer.writeFloat(key.tension);
+        if (flags & HAS_BIAS)
+            writer.writeFloat(key.bias);
+        if (flags & HAS_CONTINUITY)
+            writer.writeFloat(key.continuity);
+        previousIndex = i;
+    }
+
+    return writer.data();
+}
+
+QByteArray CurveKeyCodec::encode(const QVector<StepKey>& keys, const TimeGrid& grid)
+{
+    Writer writer(32 + keys.size() * 3);
+    writeHeaderAndTimes(writer, KIND_STEP, keys, grid);
+
+    qint64 previous = 0;
+    for (const StepKey& key : keys)
+    {
+        writer.writeVarint(zigZag(key.value - previous));
+        previous = key.value;
+    }
+
+    return writer.data();
+}
+
+bool CurveKeyCodec::decode(const QByteArray& data, QVector<SplineKey>& keys)
+{
+    keys.clear();
+
+    Reader reader(data);
+    if (!readHeaderAndTimes(reader, KIND_SPLINE, keys))
+    {
+        keys.clear();
+        return false;
+    }
+
+    quint32 previous = 0;
+    for (SplineKey& key : keys)
+    {
+        key.value = reader.readFloatDelta(previous);
+        key.tension = 0.0f;
+        key.bias = 0.0f;
+        key.continuity = 0.0f;
+    }
+
+    const quint64 paramCount = reader.readVarint();
+    quint64 index = 0;
+    bool indexOk = true;
+    for (quint64 i = 0; i < paramCount && reader.ok() && indexOk; ++i)
+    {
+        index += reader.readVarint();
+        const quint8 flags = reader.readByte();
+        indexOk = index < static_cast<quint64>(keys.size());
+        if (!indexOk)
+            break;
+
+        SplineKey& key = keys[static_cast<int>(index)];
+        if (flags & HAS_TENSION)
+            key.tension = reader.readFloat();
+        if (flags & HAS_BIAS)
+            key.bias = reader.readFloat();
+        if (flags & HAS_CONTINUITY)
+            key.continuity = reader.readFloat();
+    }
+
+    if (!reader.ok() || !indexOk || !reader.atEnd())
+    {
+        keys.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool CurveKeyCodec::decode(const QByteArray& data, QVector<StepKey>& keys)
+{
+    keys.clear();
+
+    Reader reader(data);
+    if (!readHeaderAndTimes(reader, KIND_STEP, keys))
+    {
+        keys.clear();
+        return false;
+    }
+
+    qint64 value = 0;
+    for (StepKey& key : keys)
+    {
+        value += unZigZag(reader.readVarint());
+        key.value = static_cast<int>(value);
+    }
+
+    if (!reader.ok() || !reader.atEnd())
+    {
+        keys.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef CURVEKEYCODEC_H
+#define CURVEKEYCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Compact lossless encoding for curve key arrays.
+ *
+ * Keys are expected in time order. Encoding exploits the typical structure of
+ * scene curves:
+ * - Key times are mostly on a beat grid. If all times of a curve are exactly
+ *   reproducible from the grid they are stored as zig-zag varint tick deltas,
+ *   otherwise as XOR deltas of the float bit patterns.
+ * - Spline values change smoothly and are stored as XOR deltas of the float
+ *   bit patterns, with trailing zero bits elided.
+ * - Step values are stored as zig-zag varint deltas.
+ * - Only spline keys with non-default Kochanek-Bartels parameters store them.
+ *
+ * Decoding reproduces the encoded floats bit by bit.
+ */
+class CurveKeyCodec
+{
+public:
+    /** Key of a spline curve */
+    struct SplineKey
+    {
+        float time;
+        float value;
+        float tension;
+        float bias;
+        float continuity;
+    };
+
+    /** Key of a step curve */
+    struct StepKey
+    {
+        float time;
+        int value;
+    };
+
+    /** Time quantization grid */
+    struct TimeGrid
+    {
+        double origin; ///< Time of tick 0
+        double tickLength; ///< Time between ticks
+
+        /** Make an invalid grid. Times are then always stored as floats. */
+        TimeGrid();
+        TimeGrid(double origin, double tickLength);
+
+        /** @return True if tick length is positive */
+        bool isValid() const;
+
+        /**
+         * @brief Make a grid dividing the beats of the given tempo into ticks.
+         * @param beatOffset Offset to first beat in seconds
+         * @param bpm Beats per minute
+         * @return Grid, invalid if bpm is not positive
+         */
+        static TimeGrid fromTempo(double beatOffset, double bpm);
+    };
+
+    /** Number of grid ticks per beat. Covers binary subdivisions down to 1/64 notes and triplets. */
+    static const int TICKS_PER_BEAT = 192;
+
+    /**
+     * @brief Encode spline keys.
+     * @param keys Keys in time order
+     * @param grid Grid for time quantization
+     * @return Encoded keys
+     */
+    static QByteArray encode(const QVector<SplineKey>& keys, const TimeGrid& grid);
+    /**
+     * @brief Encode step keys.
+     * @param keys Keys in time order
+     * @param grid Grid for time quantization
+     * @return Encoded keys
+     */
+    static QByteArray encode(const QVector<StepKey>& keys, const TimeGrid& grid);
+
+    /**
+     * @brief Decode spline keys.
+     * @param data Data created with encode()
+     * @param keys [out] Decoded keys
+     * @return False if the data is corrupt or not spline keys
+     */
+    static bool decode(const QByteArray& data, QVector<SplineKey>& keys);
+    /**
+     * @brief Decode step keys.
+     * @param data Data created with encode()
+     * @param keys [out] Decoded keys
+     * @return False if the data is corrupt or not step keys
+     */
+    static bool decode(const QByteArray& data, QVector<StepKey>& keys);
+};
+
+inline CurveKeyCodec::TimeGrid::TimeGrid()
+  : origin(0.0), tickLength(0.0)
+{
+}
+
+inline CurveKeyCodec::TimeGrid::TimeGrid(double origin_, double tickLength_)
+  : origin(origin_), tickLength(tickLength_)
+{
+}
+
+inline bool CurveKeyCodec::TimeGrid::isValid() const
+{
+    return tickLength > 0.0;
+}
+
+#endif // CURVEKEYCODEC_H
@@ -7,12 +7,15 @@
 //
 
 #include "CurveModel.h"
+#include <algorithm>
 #include <assert.h>
 #include <utility>
 
 CurveModel::CurveModel(const QString& name)
 :	CurveModelAbs(name),
-    m_valueRange(-100, 100)
+    m_valueRange(-100, 100),
+    m_spline(std::make_shared<Spline>()),
+    m_splineRebuildPending(false)
 {
 }
 
@@ -43,20 +46,38 @@ void CurveModel::updatePointParams(PointId id, float tension, float bias, float
     {
         // Params changed
         (*it) = p;
+
+        const Point changed = point(id);
+        replaceSplinePoint(changed, makeSplinePoint(id, changed.time(), changed.value()));
+        markChanged();
+
         emit pointUpdated(id);
     }
 }
 
 bool CurveModel::addPointInternal(PointId id, float time, QVariant value)
 {
-    Q_UNUSED(time)
-    Q_UNUSED(value)
-
     // Add point to param container
     ParamContainer::Iterator paramIt = m_params.insert(id, KbParams());
     if (paramIt == m_params.end())
         return false;
 
+    // Added to the spline when it is rebuilt at the end of a large batch
+    if (m_splineRebuildPending)
+        return true;
+
+    SplineDataSet& data = splineData();
+    auto splineIt = data.add(makeSplinePoint(id, time, value));
+    if (splineIt == data.end())
+    {
+        m_params.remove(id);
+        return false;
+    }
+
+    // Adding updates tangents of the new point and its neighbours
+    const int index = static_cast<int>(splineIt - data.begin());
+    emit splineChanged(index, 0, 1, splineTimeRange(index - 2, index + 2));
+
     return true;
 }
 
@@ -65,6 +86,172 @@ void CurveModel::removePointInternal(PointId id)
     int removedParams = m_params.remove(id);
     if (removedParams != 1)
         qWarning() << "Unable to remove parameters for " << id;
+
+    if (m_splineRebuildPending)
+        return;
+
+    const Point removed = point(id);
+    SplineDataSet& data = splineData();
+    auto splineIt = findSplinePoint(id, removed.time());
+    if (splineIt == data.end())
+    {
+        qWarning() << "Unable to remove spline point for" << id;
+        return;
+    }
+
+    // Erasing updates tangents of the previous and next points
+    const int index = static_cast<int>(splineIt - data.begin());
+    const RangeF changedTimeRange = splineTimeRange(index - 2, index + 2);
+    data.erase(splineIt);
+    emit splineChanged(index, 1, 0, changedTimeRange);
+}
+
+void CurveModel::movePointInternal(const Point& oldPoint, const Point& newPoint)
+{
+    if (m_splineRebuildPending)
+        return;
+
+    replaceSplinePoint(oldPoint, makeSplinePoint(newPoint.id(), newPoint.time(), newPoint.value()));
+}
+
+void CurveModel::beginPointUpdates(int count)
+{
+    // Each out of order move, add or remove shifts the spline points, so rebuilding
+    // in one ordered pass is cheaper when many points change at once
+    static const int REBUILD_THRESHOLD = 64;
+    m_splineRebuildPending = count >= REBUILD_THRESHOLD;
+}
+
+void CurveModel::endPointUpdates()
+{
+    if (!m_splineRebuildPending)
+        return;
+
+    m_splineRebuildPending = false;
+    rebuildSpline();
+}
+
+const CurveModel::Spline& CurveModel::spline() const
+{
+    return *m_spline;
+}
+
+float CurveModel::valueAt(float time) const
+{
+    if (m_spline->data().size() == 0)
+        return 0.0f;
+
+    return m_spline->value_at(time);
+}
+
+void CurveModel::sample(RangeF range, int count, float* out) const
+{
+    if (count <= 0)
+        return;
+
+    if (m_spline->data().size() == 0)
+    {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    const float step = count > 1 ? (range.max - range.min) / (count - 1) : 0.0f;
+    m_spline->sample(range.min, step, count, out);
+}
+
+CurveModel::SplineDataSet::point CurveModel::makeSplinePoint(PointId id, float time, QVariant value) const
+{
+    const KbParams p = params(id);
+    const pt::math::kochanek_bartels_parameters kbParams(p.tension(), p.bias(), p.continuity());
+    return SplineDataSet::point(id, time, value.toFloat(), kbParams);
+}
+
+CurveModel::SplineDataSet::iterator CurveModel::findSplinePoint(PointId id, float time)
+{
+    SplineDataSet& data = splineData();
+    auto splineIt = data.find(id, time);
+    if (splineIt != data.end())
+        return splineIt;
+
+    // Point not in the model (anymore), search by id only
+    return data.get_point(id);
+}
+
+void CurveModel::replaceSplinePoint(const Point& oldPoint, const SplineDataSet::point& newPoint)
+{
+    SplineDataSet& data = splineData();
+    auto splineIt = findSplinePoint(oldPoint.id(), oldPoint.time());
+    if (splineIt == data.end())
+    {
+        qWarning() << "Unable to update spline point for" << oldPoint.id();
+        return;
+    }
+
+    const int oldIndex = static_cast<int>(splineIt - data.begin());
+    const RangeF oldTimeRange = splineTimeRange(oldIndex - 2, oldIndex + 2);
+
+    splineIt = data.replace(splineIt, newPoint);
+    const int newIndex = static_cast<int>(splineIt - data.begin());
+    const RangeF newTimeRange = splineTimeRange(newIndex - 2, newIndex + 2);
+
+    if (newIndex == oldIndex)
+    {
+        emit splineChanged(oldIndex, 1, 1, RangeF::makeUnion(oldTimeRange, newTimeRange));
+    }
+    else
+    {
+        // Point passed its neighbours, notify as removed and inserted elsewhere
+        emit splineChanged(oldIndex, 1, 0, oldTimeRange);
+        emit splineChanged(newIndex, 0, 1, newTimeRange);
+    }
+}
+
+void CurveModel::rebuildSpline()
+{
+    const int oldSize = static_cast<int>(m_spline->data().size());
+    const RangeF oldTimeRange = splineTimeRange(0, oldSize - 1);
+
+    // Points are in time order, which is the fast path for adding spline points.
+    // Snapshots keep the old spline.
+    std::shared_ptr<Spline> spline = std::make_shared<Spline>();
+    for (const Point& p : points())
+        spline->data().add(makeSplinePoint(p.id(), p.time(), p.value()));
+    m_spline = spline;
+    markChanged();
+
+    const int newSize = static_cast<int>(m_spline->data().size());
+    emit splineChanged(0, oldSize, newSize, RangeF::makeUnion(oldTimeRange, splineTimeRange(0, newSize - 1)));
+}
+
+RangeF CurveModel::splineTimeRange(int first, int last) const
+{
+    const int size = static_cast<int>(m_spline->data().size());
+    if (size == 0)
+        return RangeF();
+
+    first = qBound(0, first, size - 1);
+    last = qBound(0, last, size - 1);
+    return RangeF(m_spline->data().get(first)->time(), m_spline->data().get(last)->time());
+}
+
+CurveModel::SplineDataSet& CurveModel::splineData()
+{
+    // Snapshots held elsewhere keep the current spline, modify a copy of it
+    releaseSnapshot();
+    if (m_spline.use_count() > 1)
+        m_spline = std::make_shared<Spline>(*m_spline);
+
+    return m_spline->data();
+}
+
+std::shared_ptr<const CurveSnapshot::Spline> CurveModel::snapshotSpline() const
+{
+    return m_spline;
+}
+
+RangeF CurveModel::snapshotValueRange() const
+{
+    return m_valueRange;
 }
 
 void CurveModel::setValueRange(RangeF newRange)
@@ -72,6 +259,7 @@ void CurveModel::setValueRange(RangeF newRange)
     if (m_valueRange != newRange)
     {
         m_valueRange = newRange;
+        markChanged();
 
         // Ensure all points fit to the new value range
         for (auto pid : pointIds())
@@ -12,11 +12,15 @@
 #include "PointId.h"
 #include "RangeF.h"
 #include "CurveModelAbs.h"
+#include "pt/math/kb_spline.h"
+#include "pt/math/spline_cursor.h"
 #include <QObject>
 #include <QDebug>
 
 /**
  * CurveModel represents a curve as its control points.
+ * The points are kept as a Kochanek-Bartels spline too, updated in place on point changes,
+ * for evaluating the curve.
  * Derived from QObject for signals and slots.
  */
 class CurveModel : public CurveModelAbs
@@ -69,10 +73,34 @@ public:
     /** @return Curve value range [min, max]. */
     RangeF valueRange() const;
 
+    using Spline = pt::math::kb_spline<float>;
+    /** Evaluates the spline at nearby times one after another, @see spline() */
+    using SplineCursor = pt::math::spline_cursor<Spline>;
+
+    /**
+     * @return Spline through the curve points for evaluating the curve. Shared by views and exporters.
+     * The spline is replaced by a copy when modified while a snapshot holds it, @see snapshot().
+     */
+    const Spline& spline() const;
+
+    /** @see CurveModelAbs::valueAt */
+    virtual float valueAt(float time) const override;
+    /** @see CurveModelAbs::sample */
+    virtual void sample(RangeF range, int count, float* out) const override;
+
 signals:
     /** @brief Curve value range changed. */
     void valueRangeChanged(RangeF newRange);
 
+    /**
+     * @brief Spline points changed. Emitted before the point change itself is notified.
+     * @param index Index of the first changed spline point
+     * @param removedCount Number of spline points removed from index
+     * @param insertedCount Number of spline points inserted to index in their place
+     * @param timeRange Time range where the curve shape changed
+     */
+    void splineChanged(int index, int removedCount, int insertedCount, RangeF timeRange);
+
 public slots:
     /**
      * @brief Update parameters for an existing point
@@ -99,14 +127,36 @@ protected:
 private:
     using PointContainer = QMultiMap<float, Point>;
     using ParamContainer = QMap<PointId, KbParams>;
+    using SplineDataSet = pt::math::kb_data_set<float>;
     
     virtual bool addPointInternal(PointId id, float time, QVariant value) override;
     virtual void removePointInternal(PointId id) override;
+    virtual void movePointInternal(const Point& oldPoint, const Point& newPoint) override;
+    virtual void beginPointUpdates(int count) override;
+    virtual void endPointUpdates() override;
 
     virtual QVariant limitValueToRange(const QVariant& value) const override;
+    virtual std::shared_ptr<const CurveSnapshot::Spline> snapshotSpline() const override;
+    virtual RangeF snapshotValueRange() const override;
+
+    /** @return Spline data for modification, copied first if a snapshot other than the cached one holds it */
+    SplineDataSet& splineData();
+    /** @return Spline point with the current params of the point */
+    SplineDataSet::point makeSplinePoint(PointId id, float time, QVariant value) const;
+    /** @return Spline point of a model point or end if not found */
+    SplineDataSet::iterator findSplinePoint(PointId id, float time);
+    /** Replace spline point of a model point, notifying the change */
+    void replaceSplinePoint(const Point& oldPoint, const SplineDataSet::point& newPoint);
+    /** Build spline again from all points */
+    void rebuildSpline();
+    /** @return Time range from spline point first to last, indices clamped to existing points */
+    RangeF splineTimeRange(int first, int last) const;
 
     ParamContainer m_params;
     RangeF m_valueRange;
+
+    std::shared_ptr<Spline> m_spline; ///< Shared with snapshots of the curve
+    bool m_splineRebuildPending; ///< Spline is rebuilt once after a large batched update
 };
 
 inline CurveModel::KbParams::KbParams(float tension, float bias, float continuity)
@@ -6,7 +6,8 @@
 CurveModelAbs::CurveModelAbs(const QString& name)
   : m_name(name),
     m_selected(false),
-    m_timeRange()
+    m_timeRange(),
+    m_version(0)
 {
 }
 
@@ -29,9 +30,22 @@ RangeF CurveModelAbs::timeRange() const
     return m_timeRange;
 }
 
+RangeF CurveModelAbs::pointTimeRange() const
+{
+    if (m_points.isEmpty())
+        return RangeF();
+
+    return RangeF(m_points.firstKey(), m_points.lastKey());
+}
+
 void CurveModelAbs::setName(QString name)
 {
-    m_name = name;
+    if (m_name != name)
+    {
+        m_name = name;
+        markChanged();
+        emit nameChanged(m_name);
+    }
 }
 
 void CurveModelAbs::setSelected(bool status)
@@ -48,6 +62,7 @@ void CurveModelAbs::setTimeRange(RangeF newRange)
     if (m_timeRange != newRange)
     {
         m_timeRange = newRange;
+        markChanged();
         forcePointsToTimeRange(m_timeRange);
         emit timeRangeChanged(m_timeRange);
     }
@@ -63,6 +78,48 @@ QList<PointId> CurveModelAbs::pointIds() const
     return std::move(output);
 }
 
+QList<Point> CurveModelAbs::points() const
+{
+    return m_points.values();
+}
+
+QList<Point> CurveModelAbs::pointsInRange(RangeF range, int margin) const
+{
+    QList<Point> points;
+    forEachPointInRange(range, margin, [&points](const Point& point) { points.append(point); });
+    return points;
+}
+
+void CurveModelAbs::forEachPointInRange(RangeF range, int margin, const std::function<void(const Point&)>& visit) const
+{
+    if (!range.isValid())
+        return;
+
+    PointContainer::ConstIterator first = m_points.lowerBound(range.min);
+    PointContainer::ConstIterator last = m_points.upperBound(range.max);
+
+    for (int i = 0; i < margin && first != m_points.begin(); ++i)
+        --first;
+    for (int i = 0; i < margin && last != m_points.end(); ++i)
+        ++last;
+
+    for (PointContainer::ConstIterator it = first; it != last; ++it)
+        visit(it.value());
+}
+
+int CurveModelAbs::numberOfPointsInRange(RangeF range, int limit) const
+{
+    if (!range.isValid())
+        return 0;
+
+    int count = 0;
+    PointContainer::ConstIterator last = m_points.upperBound(range.max);
+    for (PointContainer::ConstIterator it = m_points.lowerBound(range.min); it != last && count < limit; ++it)
+        ++count;
+
+    return count;
+}
+
 PointId CurveModelAbs::nextPointId(PointId id) const
 {
     PointContainer::ConstIterator it = findPoint(id);
@@ -97,6 +154,30 @@ int CurveModelAbs::numberOfPoints() const
     return m_points.size();
 }
 
+QList<PointId> CurveModelAbs::selectedPointIds() const
+{
+    return m_selectedPoints.values();
+}
+
+int CurveModelAbs::numberOfSelectedPoints() const
+{
+    return m_selectedPoints.size();
+}
+
+quint64 CurveModelAbs::version() const
+{
+    return m_version;
+}
+
+std::shared_ptr<const CurveSnapshot> CurveModelAbs::snapshot() const
+{
+    if (!m_snapshot)
+        m_snapshot.reset(new CurveSnapshot(m_name, m_version, m_timeRange, snapshotValueRange(),
+            snapshotOptions(), m_points, m_pointTimes, snapshotSpline()));
+
+    return m_snapshot;
+}
+
 std::shared_ptr<CurveModel> CurveModelAbs::getAsSplineCurve(std::shared_ptr<CurveModelAbs> curve)
 {
     if (curve->getAsSplineCurve())
@@ -115,6 +196,37 @@ std::shared_ptr<StepCurveModel> CurveModelAbs::getAsStepCurve(std::shared_ptr<Cu
 
 PointId CurveModelAbs::addPoint(float time, QVariant value)
 {
+    const PointId id = insertPoint(time, value);
+    if (id.isValid())
+        emit pointAdded(id);
+
+    return id;
+}
+
+QList<PointId> CurveModelAbs::addPoints(const QVector<NewPoint>& points)
+{
+    QList<PointId> added;
+    added.reserve(points.size());
+
+    beginPointUpdates(points.size());
+    for (const NewPoint& point : points)
+    {
+        const PointId id = insertPoint(point.time, point.value);
+        if (id.isValid())
+            added.append(id);
+    }
+    endPointUpdates();
+
+    if (!added.isEmpty())
+        emit pointsAdded(added);
+
+    return added;
+}
+
+PointId CurveModelAbs::insertPoint(float time, QVariant value)
+{
+    releaseSnapshot();
+
     // Add to point container
     value = limitValueToRange(value);
     Point p(time, value, false);
@@ -129,19 +241,42 @@ PointId CurveModelAbs::addPoint(float time, QVariant value)
         removePointInternal(p.id());
         return PointId::invalidId();
     }
-
-    emit pointAdded(p.id());
+    m_pointTimes.insert(p.id(), time);
+    markChanged();
 
     return p.id();
 }
 
 void CurveModelAbs::updatePoint(PointId id, float time, QVariant value)
+{
+    if (movePoint(id, time, value))
+        emit pointUpdated(id);
+}
+
+void CurveModelAbs::updatePoints(const QVector<PointUpdate>& updates)
+{
+    QList<PointId> updated;
+    updated.reserve(updates.size());
+
+    beginPointUpdates(updates.size());
+    for (const PointUpdate& update : updates)
+    {
+        if (movePoint(update.id, update.time, update.value))
+            updated.append(update.id);
+    }
+    endPointUpdates();
+
+    if (!updated.isEmpty())
+        emit pointsUpdated(updated);
+}
+
+bool CurveModelAbs::movePoint(PointId id, float time, QVariant value)
 {
     PointContainer::Iterator it = findPoint(id);
     if (it == m_points.end())
     {
         qWarning() << "Unknown point" << id;
-        return;
+        return false;
     }
 
     time = limitTimeToRange(time);
@@ -150,13 +285,16 @@ void CurveModelAbs::updatePoint(PointId id, float time, QVariant value)
     const Point old = *it;
     Point p(time, value, old.isSelected(), old.id());
     if (p == old)
-        return; // No change
+        return false; // No change
 
     // Remove/add to also update key (keep sorted)
     m_points.erase(it);
     m_points.insert(time, p);
+    m_pointTimes.insert(id, time);
+    movePointInternal(old, p);
+    markChanged();
 
-    emit pointUpdated(id);
+    return true;
 }
 
 void CurveModelAbs::pointSelectedChanged(PointId id, bool isSelected)
@@ -174,6 +312,15 @@ void CurveModelAbs::pointSelectedChanged(PointId id, bool isSelected)
     it->setSelected(isSelected);
     const bool newSelected = it->isSelected();
 
+    if (newSelected != oldSelected)
+    {
+        if (newSelected)
+            m_selectedPoints.insert(id);
+        else
+            m_selectedPoints.remove(id);
+        markChanged();
+    }
+
     if (newSelected && !oldSelected)
     {
         emit pointSelected(id);
@@ -184,6 +331,37 @@ void CurveModelAbs::pointSelectedChanged(PointId id, bool isSelected)
     }
 }
 
+void CurveModelAbs::setPointsSelected(const QList<PointId>& ids, bool isSelected)
+{
+    QList<PointId> changed;
+    for (PointId id : ids)
+    {
+        PointContainer::Iterator it = findPoint(id);
+        if (it == m_points.end())
+        {
+            qWarning() << "Unknown point selected changed" << id;
+            continue;
+        }
+
+        const bool oldSelected = it->isSelected();
+        it->setSelected(isSelected);
+        if (it->isSelected() == oldSelected)
+            continue;
+
+        if (isSelected)
+            m_selectedPoints.insert(id);
+        else
+            m_selectedPoints.remove(id);
+        changed.append(id);
+    }
+
+    if (changed.isEmpty())
+        return;
+
+    markChanged();
+    emit pointsSelectedChanged(changed, isSelected);
+}
+
 void CurveModelAbs::removePoint(PointId id)
 {
     PointContainer::Iterator it = findPoint(id);
@@ -197,32 +375,110 @@ void CurveModelAbs::removePoint(PointId id)
     if (it->isSelected())
         emit pointDeselected(id);
 
-    m_points.erase(it);
-    removePointInternal(id);
+    erasePoint(it);
 
     emit pointRemoved(id);
 }
 
+void CurveModelAbs::removePoints(const QList<PointId>& ids)
+{
+    // Deselect points before removing
+    for (PointId id : ids)
+        if (m_selectedPoints.contains(id))
+            emit pointDeselected(id);
+
+    QList<PointId> removed;
+    removed.reserve(ids.size());
+
+    beginPointUpdates(ids.size());
+    for (PointId id : ids)
+    {
+        PointContainer::Iterator it = findPoint(id);
+        if (it == m_points.end())
+        {
+            qWarning() << "Unknown point" << id;
+            continue;
+        }
+
+        erasePoint(it);
+        removed.append(id);
+    }
+    endPointUpdates();
+
+    if (!removed.isEmpty())
+        emit pointsRemoved(removed);
+}
+
+void CurveModelAbs::erasePoint(PointContainer::Iterator it)
+{
+    const PointId id = it->id();
+
+    removePointInternal(id);
+    m_points.erase(it);
+    m_pointTimes.remove(id);
+    m_selectedPoints.remove(id);
+    markChanged();
+}
+
 CurveModelAbs::PointContainer::Iterator CurveModelAbs::findPoint(PointId id)
 {
-    PointContainer::Iterator it = m_points.begin();
-    for (; it != m_points.end(); ++it)
+    // Non-const access detaches the points
+    releaseSnapshot();
+
+    auto timeIt = m_pointTimes.constFind(id);
+    if (timeIt == m_pointTimes.constEnd())
+        return m_points.end();
+
+    // Several points may share the same time
+    PointContainer::Iterator it = m_points.lowerBound(timeIt.value());
+    for (; it != m_points.end() && it.key() == timeIt.value(); ++it)
     {
         if ((*it).id() == id)
-            break;
+            return it;
     }
-    return it;
+    return m_points.end();
 }
 
 CurveModelAbs::PointContainer::ConstIterator CurveModelAbs::findPoint(PointId id) const
 {
-    PointContainer::ConstIterator it = m_points.begin();
-    for (; it != m_points.end(); ++it)
+    auto timeIt = m_pointTimes.constFind(id);
+    if (timeIt == m_pointTimes.constEnd())
+        return m_points.end();
+
+    // Several points may share the same time
+    PointContainer::ConstIterator it = m_points.lowerBound(timeIt.value());
+    for (; it != m_points.end() && it.key() == timeIt.value(); ++it)
     {
         if ((*it).id() == id)
-            break;
+            return it;
     }
-    return it;
+    return m_points.end();
+}
+
+void CurveModelAbs::markChanged()
+{
+    ++m_version;
+    m_snapshot.reset();
+}
+
+void CurveModelAbs::releaseSnapshot()
+{
+    m_snapshot.reset();
+}
+
+std::shared_ptr<const CurveSnapshot::Spline> CurveModelAbs::snapshotSpline() const
+{
+    return std::shared_ptr<const CurveSnapshot::Spline>();
+}
+
+RangeF CurveModelAbs::snapshotValueRange() const
+{
+    return RangeF();
+}
+
+CurveSnapshot::Options CurveModelAbs::snapshotOptions() const
+{
+    return CurveSnapshot::Options();
 }
 
 bool CurveModelAbs::addPointInternal(PointId id, float time, QVariant value)
@@ -236,6 +492,20 @@ void CurveModelAbs::removePointInternal(PointId id)
     Q_UNUSED(id)
 }
 
+void CurveModelAbs::movePointInternal(const Point& oldPoint, const Point& newPoint)
+{
+    Q_UNUSED(oldPoint) Q_UNUSED(newPoint)
+}
+
+void CurveModelAbs::beginPointUpdates(int count)
+{
+    Q_UNUSED(count)
+}
+
+void CurveModelAbs::endPointUpdates()
+{
+}
+
 QVariant CurveModelAbs::limitValueToRange(const QVariant& value) const
 {
     return value;
@@ -3,9 +3,14 @@
 
 #include "RangeF.h"
 #include "Point.h"
+#include "CurveSnapshot.h"
 #include <QObject>
+#include <QHash>
 #include <QMultiMap>
+#include <QSet>
 #include <QVariant>
+#include <QVector>
+#include <functional>
 #include <memory>
 
 class CurveModel;
@@ -26,6 +31,27 @@ protected:
 public:
     ~CurveModelAbs();
 
+    /** New time and value for a point in a batched update */
+    struct PointUpdate
+    {
+        PointUpdate() : id(PointId::invalidId()), time(0) {}
+        PointUpdate(PointId id_, float time_, QVariant value_) : id(id_), time(time_), value(value_) {}
+
+        PointId id;
+        float time;
+        QVariant value;
+    };
+
+    /** Time and value for a point in a batched add */
+    struct NewPoint
+    {
+        NewPoint() : time(0) {}
+        NewPoint(float time_, QVariant value_) : time(time_), value(value_) {}
+
+        float time;
+        QVariant value;
+    };
+
     /** @return Curve name. */
     const QString& name() const;
 
@@ -35,9 +61,31 @@ public:
     /** @return Curve time range [start, end]. */
     RangeF timeRange() const;
 
+    /** @return Time range from the first to the last point, invalid if there are no points. */
+    RangeF pointTimeRange() const;
+
     /** @return A list of point ids. */
     QList<PointId> pointIds() const;
 
+    /** @return All points in time order. Prefer over looking up points of pointIds() one by one. */
+    QList<Point> points() const;
+
+    /**
+     * @brief Get points within a time range.
+     * @param range Time range [min, max]
+     * @param margin Number of additional points to include on both sides outside the range
+     * @return Points in time order
+     */
+    QList<Point> pointsInRange(RangeF range, int margin = 0) const;
+
+    /**
+     * @brief Visit points within a time range without copying them to a list.
+     * @param range Time range [min, max]
+     * @param margin Number of additional points to visit on both sides outside the range
+     * @param visit Called for each point in time order
+     */
+    void forEachPointInRange(RangeF range, int margin, const std::function<void(const Point&)>& visit) const;
+
     /**
      * @brief Retrieve next point id from the given one.
      * @param id Original point
@@ -54,6 +102,48 @@ public:
     /** @return The number of point in the curve. */
     int numberOfPoints() const;
 
+    /**
+     * @brief Count points within a time range, stopping at a limit.
+     * @param range Time range [min, max]
+     * @param limit Maximum count, bounds the cost for dense ranges
+     * @return Number of points in the range, at most limit
+     */
+    int numberOfPointsInRange(RangeF range, int limit) const;
+
+    /** @return Ids of the selected points in no particular order. Kept as a set, no points are searched. */
+    QList<PointId> selectedPointIds() const;
+
+    /** @return The number of selected points in the curve. */
+    int numberOfSelectedPoints() const;
+
+    /** @return Content version. Incremented on every change to the name, time range or points. */
+    quint64 version() const;
+
+    /**
+     * @brief Take an immutable snapshot of the curve for reading in other threads.
+     *
+     * The snapshot is cached until the curve changes, so repeated calls are cheap.
+     * Must be called from the thread of the model.
+     *
+     * @return Curve data at the current version
+     */
+    std::shared_ptr<const CurveSnapshot> snapshot() const;
+
+    /**
+     * @brief Evaluate the curve.
+     * @param time Time
+     * @return Curve value at time, 0 if the curve has no points
+     */
+    virtual float valueAt(float time) const = 0;
+
+    /**
+     * @brief Evaluate the curve at evenly spaced times. Faster than valueAt for each time.
+     * @param range Sample times from range.min to range.max, both included
+     * @param count Number of samples. A single sample is taken at range.min.
+     * @param out Output for count values
+     */
+    virtual void sample(RangeF range, int count, float* out) const = 0;
+
 public:
     /** Downcast (shared) CurveModelAbs to CurveModel. Return nullptr if curve is not the correct type. */
     static std::shared_ptr<CurveModel> getAsSplineCurve(std::shared_ptr<CurveModelAbs> curve);
@@ -65,16 +155,31 @@ signals:
     void pointAdded(PointId id);
     /** @brief Data for an existing point was modified. */
     void pointUpdated(PointId id);
+    /** @brief Data for several existing points was modified in a batched update. */
+    void pointsUpdated(QList<PointId> ids);
+    /** @brief Several points were added in a batched add. */
+    void pointsAdded(QList<PointId> ids);
+    /** @brief Several points were removed in a batched remove. */
+    void pointsRemoved(QList<PointId> ids);
     /** @brief Point was selected. */
     void pointSelected(PointId id);
     /** @brief Point was deselected. */
     void pointDeselected(PointId id);
+    /**
+     * @brief Several points were selected or deselected in a batched selection.
+     * @param ids Points whose selection changed
+     * @param isSelected True if the points were selected
+     */
+    void pointsSelectedChanged(QList<PointId> ids, bool isSelected);
     /** @brief An existing point was removed. */
     void pointRemoved(PointId id);
 
     /** @brief Curve was selected or deselected. */
     void selectedChanged(bool status);
 
+    /** @brief Curve name changed. */
+    void nameChanged(QString name);
+
     /** @brief Curve time range changed. */
     void timeRangeChanged(RangeF newRange);
 
@@ -106,6 +211,14 @@ public slots:
      * @return Id of the new point or invalid in case add failed
      */
     PointId addPoint(float time, QVariant value);
+
+    /**
+     * @brief Add several points at once.
+     * Notifies all added points with a single pointsAdded() instead of pointAdded() per point.
+     * @param points Times and values of the new points
+     * @return Ids of the added points. Points whose add failed are left out.
+     */
+    QList<PointId> addPoints(const QVector<NewPoint>& points);
     /**
      * @brief Update point time and/or value for one dimension of an existing point.
      *
@@ -117,6 +230,13 @@ public slots:
      */
     void updatePoint(PointId id, float time, QVariant value);
 
+    /**
+     * @brief Update time and/or value of several points at once.
+     * Notifies all modified points with a single pointsUpdated() instead of pointUpdated() per point.
+     * @param updates New times and values. Unknown ids are skipped.
+     */
+    void updatePoints(const QVector<PointUpdate>& updates);
+
     /**
      * @brief Point selected state changed.
      * @param id Point id
@@ -124,6 +244,15 @@ public slots:
      */
     void pointSelectedChanged(PointId id, bool isSelected);
 
+    /**
+     * @brief Select or deselect several points at once.
+     * Notifies the points whose selection changed with a single pointsSelectedChanged()
+     * instead of pointSelected() or pointDeselected() per point.
+     * @param ids Point ids. Unknown ids are skipped.
+     * @param isSelected True to select the points
+     */
+    void setPointsSelected(const QList<PointId>& ids, bool isSelected);
+
     /**
      * @brief Remove a point.
      * @param id Point id.
@@ -132,7 +261,33 @@ public slots:
      */
     void removePoint(PointId id);
 
+    /**
+     * @brief Remove several points at once.
+     * Notifies all removed points with a single pointsRemoved() instead of pointRemoved() per point.
+     * Selected points are deselected before removing as with removePoint().
+     * @param ids Point ids. Unknown ids are skipped.
+     */
+    void removePoints(const QList<PointId>& ids);
+
 protected:
+    /** @brief Curve content changed. Increments version and drops the cached snapshot. */
+    void markChanged();
+
+    /**
+     * @brief Drop the cached snapshot before modifying data it shares, so the data is not copied for it.
+     * Snapshots held by others are still copied from on write.
+     */
+    void releaseSnapshot();
+
+    /** @return Spline shared with snapshots, null by default for curves without a spline */
+    virtual std::shared_ptr<const CurveSnapshot::Spline> snapshotSpline() const;
+
+    /** @return Value range for snapshots, invalid by default for curves without one */
+    virtual RangeF snapshotValueRange() const;
+
+    /** @return Value options for snapshots, empty by default for curves without them */
+    virtual CurveSnapshot::Options snapshotOptions() const;
+
     /**
      * @brief Chance for implementation classes to perform internal operations for adding a new point.
      * @param id New point id
@@ -143,9 +298,22 @@ protected:
     virtual bool addPointInternal(PointId id, float time, QVariant value);
     /**
      * @brief Chance for derived classes to perform internal operations for removing a new point. The point will be removed in any case.
-     * @param id Point id to be removed
+     * @param id Point id to be removed, still found with point()
      */
     virtual void removePointInternal(PointId id);
+    /**
+     * @brief Chance for derived classes to follow a point moving in time and/or value. Does nothing by default.
+     * @param oldPoint Point before the move
+     * @param newPoint Point after the move
+     */
+    virtual void movePointInternal(const Point& oldPoint, const Point& newPoint);
+    /**
+     * @brief A batched update is about to add, move or remove points. Does nothing by default.
+     * @param count Number of points in the batch
+     */
+    virtual void beginPointUpdates(int count);
+    /** @brief Points of a batched update have been added, moved or removed. Does nothing by default. */
+    virtual void endPointUpdates();
 
     /**
      * @brief Chance for derived classes to limit value range.
@@ -161,9 +329,17 @@ protected:
 
 private:
     using PointContainer = QMultiMap<float, Point>;
+    /** @return Point for modification, the cached snapshot is dropped first */
     PointContainer::Iterator findPoint(PointId id);
     PointContainer::ConstIterator findPoint(PointId id) const;
 
+    /** Add point to the container without notifying. @return Id of the new point or invalid if add failed */
+    PointId insertPoint(float time, QVariant value);
+    /** Move point in the container without notifying. @return True if the point changed */
+    bool movePoint(PointId id, float time, QVariant value);
+    /** Remove point from the container without notifying */
+    void erasePoint(PointContainer::Iterator it);
+
     void forcePointsToTimeRange(RangeF newRange);
     float limitTimeToRange(float time) const;
 
@@ -173,6 +349,13 @@ private:
     RangeF m_timeRange;
 
     PointContainer m_points;
+    /** Time key of each point, to find points by id without a linear search */
+    QHash<PointId, float> m_pointTimes;
+    /** Selected points, to find them without going through all points */
+    QSet<PointId> m_selectedPoints;
+
+    quint64 m_version;
+    mutable std::shared_ptr<const CurveSnapshot> m_snapshot; ///< Snapshot of the current version, taken on demand
 };
 
 #endif // CURVEMODELABS_H
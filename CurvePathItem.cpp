@@ -0,0 +1,244 @@
+#include "CurvePathItem.h"
+
+#include <QGenericMatrix>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QVector2D>
+#include <QDebug>
+
+namespace
+{
+
+const char* LINE_PROGRAM_NAME = "CurvePathItemLineProgram";
+
+const char* LINE_VERTEX_SHADER =
+    "attribute highp vec2 vertex;\n"
+    "uniform highp mat3 transform;\n"
+    "uniform highp vec2 viewportSize;\n"
+    "void main()\n"
+    "{\n"
+    "    highp vec3 device = transform * vec3(vertex, 1.0);\n"
+    "    highp vec2 normalized = device.xy / device.z / viewportSize * 2.0 - 1.0;\n"
+    "    gl_Position = vec4(normalized.x, -normalized.y, 0.0, 1.0);\n"
+    "}\n";
+
+const char* LINE_FRAGMENT_SHADER =
+    "uniform lowp vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+/**
+ * @brief Shader program for drawing lines, shared by all items drawn in a context.
+ * @param context Current OpenGL context, owns the program
+ * @return Linked program or null if building failed
+ */
+QOpenGLShaderProgram* lineProgram(QOpenGLContext* context)
+{
+    QOpenGLShaderProgram* program = context->findChild<QOpenGLShaderProgram*>(LINE_PROGRAM_NAME);
+    if (program)
+        return program->isLinked() ? program : nullptr;
+
+    program = new QOpenGLShaderProgram(context);
+    program->setObjectName(LINE_PROGRAM_NAME);
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, LINE_VERTEX_SHADER)
+        || !program->addShaderFromSourceCode(QOpenGLShader::Fragment, LINE_FRAGMENT_SHADER)
+        || !program->link())
+    {
+        // Keep the failed program around to not try again on every paint
+        qWarning() << "Failed to build curve line shaders:" << program->log();
+        return nullptr;
+    }
+
+    return program;
+}
+
+/** @return Transformation as a matrix multiplying column vectors */
+QMatrix3x3 toMatrix(const QTransform& transform)
+{
+    const float values[] = {
+        float(transform.m11()), float(transform.m21()), float(transform.m31()),
+        float(transform.m12()), float(transform.m22()), float(transform.m32()),
+        float(transform.m13()), float(transform.m23()), float(transform.m33())
+    };
+    return QMatrix3x3(values);
+}
+
+}
+
+CurvePathItem::CurvePathItem(QGraphicsItem* parent)
+:   QGraphicsItem(parent),
+    m_path(),
+    m_pen(),
+    m_buffer(QOpenGLBuffer::VertexBuffer),
+    m_bufferDirty(true)
+{
+}
+
+CurvePathItem::~CurvePathItem()
+{
+    // Buffer is released when its context is next current, if it is not now
+}
+
+QPainterPath CurvePathItem::path() const
+{
+    return m_path;
+}
+
+void CurvePathItem::setPath(const QPainterPath& path)
+{
+    prepareGeometryChange();
+    m_path = path;
+    update();
+
+    m_vertices.clear();
+    m_stripStarts.clear();
+    m_stripSizes.clear();
+
+    for (int i = 0; i < path.elementCount(); ++i)
+    {
+        const QPainterPath::Element element = path.elementAt(i);
+        if (element.isMoveTo())
+        {
+            m_stripStarts.append(m_vertices.size() / 2);
+            m_stripSizes.append(0);
+        }
+        else if (!element.isLineTo() || m_stripSizes.isEmpty())
+        {
+            // Views tessellate curves and start each strip with a move, skip anything else
+            continue;
+        }
+
+        m_vertices.append(float(element.x));
+        m_vertices.append(float(element.y));
+        ++m_stripSizes.last();
+    }
+
+    m_bufferDirty = true;
+}
+
+QPen CurvePathItem::pen() const
+{
+    return m_pen;
+}
+
+void CurvePathItem::setPen(const QPen& pen)
+{
+    if (pen == m_pen)
+        return;
+
+    prepareGeometryChange();
+    m_pen = pen;
+    update();
+}
+
+QRectF CurvePathItem::boundingRect() const
+{
+    // Half of the pen width outside the path, like QGraphicsPathItem
+    const qreal halfPenWidth = m_pen.style() == Qt::NoPen ? 0.0 : m_pen.widthF() / 2.0;
+    return m_path.controlPointRect().adjusted(-halfPenWidth, -halfPenWidth, halfPenWidth, halfPenWidth);
+}
+
+QPainterPath CurvePathItem::shape() const
+{
+    if (m_path.isEmpty() || m_pen.style() == Qt::NoPen)
+        return m_path;
+
+    // Stroked path like QGraphicsPathItem, so only the lines catch mouse presses
+    QPainterPathStroker stroker;
+    stroker.setCapStyle(m_pen.capStyle());
+    stroker.setJoinStyle(m_pen.joinStyle());
+    stroker.setMiterLimit(m_pen.miterLimit());
+    stroker.setWidth(m_pen.widthF() > 0.0 ? m_pen.widthF() : 0.00000001);
+
+    QPainterPath shape = stroker.createStroke(m_path);
+    shape.addPath(m_path);
+    return shape;
+}
+
+void CurvePathItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    const QPaintEngine* engine = painter->paintEngine();
+    const bool isOpenGL = engine && (engine->type() == QPaintEngine::OpenGL2 || engine->type() == QPaintEngine::OpenGL);
+
+    if (isOpenGL && paintNative(painter))
+        return;
+
+    painter->setPen(m_pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(m_path);
+}
+
+bool CurvePathItem::paintNative(QPainter* painter)
+{
+    if (m_vertices.isEmpty() || m_pen.style() == Qt::NoPen)
+        return true;
+
+    // Shader draws plain lines, leave dashes and dots to the painter
+    if (m_pen.style() != Qt::SolidLine)
+        return false;
+
+    painter->beginNativePainting();
+
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QOpenGLShaderProgram* program = context ? lineProgram(context) : nullptr;
+    if (!program)
+    {
+        painter->endNativePainting();
+        return false;
+    }
+
+    if (m_bufferContext != context)
+    {
+        // Viewport was recreated, buffer from the old context is not usable
+        m_buffer.destroy();
+        m_bufferContext = context;
+        m_bufferDirty = true;
+    }
+
+    if (!m_buffer.isCreated() && !m_buffer.create())
+    {
+        painter->endNativePainting();
+        return false;
+    }
+
+    m_buffer.bind();
+    if (m_bufferDirty)
+    {
+        // Upload only after the path changed, zooming and scrolling reuse the buffer
+        m_buffer.allocate(m_vertices.constData(), m_vertices.size() * int(sizeof(float)));
+        m_bufferDirty = false;
+    }
+
+    const QColor color = m_pen.color();
+    const QPaintDevice* device = painter->device();
+
+    program->bind();
+    program->setUniformValue("transform", toMatrix(painter->combinedTransform()));
+    program->setUniformValue("viewportSize", QVector2D(device->width(), device->height()));
+    program->setUniformValue("color", color);
+    program->enableAttributeArray("vertex");
+    program->setAttributeBuffer("vertex", GL_FLOAT, 0, 2);
+
+    QOpenGLFunctions* gl = context->functions();
+    gl->glEnable(GL_BLEND);
+    gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl->glLineWidth(qMax<qreal>(m_pen.widthF(), 1.0));
+    for (int i = 0; i < m_stripStarts.size(); ++i)
+        gl->glDrawArrays(GL_LINE_STRIP, m_stripStarts[i], m_stripSizes[i]);
+
+    program->disableAttributeArray("vertex");
+    program->release();
+    m_buffer.release();
+
+    painter->endNativePainting();
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef CURVEPATHITEM_H
+#define CURVEPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QOpenGLBuffer>
+#include <QPainterPath>
+#include <QPen>
+#include <QPointer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QOpenGLContext;
+QT_END_NAMESPACE
+
+/**
+ * @brief Path item for curve lines, drawn from a vertex buffer on an OpenGL viewport.
+ *
+ * With the raster paint engine the path is drawn with the painter like by QGraphicsPathItem.
+ * With the OpenGL paint engine the line strips of the path are uploaded to a
+ * vertex buffer once per path change. Redraws after zooming or scrolling only
+ * pass the new transformation to the shader. Pens other than solid lines are
+ * drawn with the painter also on OpenGL.
+ */
+class CurvePathItem : public QGraphicsItem
+{
+public:
+    /**
+     * @brief Construct CurvePathItem
+     * @param parent Parent item
+     */
+    explicit CurvePathItem(QGraphicsItem* parent = nullptr);
+    ~CurvePathItem();
+
+    /** @return Curve path */
+    QPainterPath path() const;
+
+    /**
+     * @brief Set the curve path
+     * @param path Curve lines, only lines are supported
+     */
+    void setPath(const QPainterPath& path);
+
+    /** @return Pen the path is drawn with */
+    QPen pen() const;
+
+    /**
+     * @brief Set the pen the path is drawn with
+     * @param pen Pen
+     */
+    void setPen(const QPen& pen);
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    /** Draw path from the vertex buffer using OpenGL. @return False if OpenGL drawing failed. */
+    bool paintNative(QPainter* painter);
+
+    QPainterPath m_path;
+    QPen m_pen;
+
+    QVector<float> m_vertices; ///< Line strip vertices as x, y pairs
+    QVector<int> m_stripStarts; ///< First vertex of each line strip
+    QVector<int> m_stripSizes; ///< Number of vertices in each line strip
+
+    QOpenGLBuffer m_buffer;
+    QPointer<QOpenGLContext> m_bufferContext; ///< Context the buffer was created in
+    bool m_bufferDirty; ///< Vertices changed since the last upload
+};
+
+#endif // CURVEPATHITEM_H
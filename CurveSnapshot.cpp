@@ -0,0 +1,167 @@
+#include "CurveSnapshot.h"
+#include <algorithm>
+
+CurveSnapshot::CurveSnapshot(const QString& name, quint64 version, RangeF timeRange, RangeF valueRange,
+    const Options& options, const PointContainer& points, const QHash<PointId, float>& pointTimes,
+    std::shared_ptr<const Spline> spline)
+  : m_name(name),
+    m_version(version),
+    m_timeRange(timeRange),
+    m_valueRange(valueRange),
+    m_options(options),
+    m_points(points),
+    m_pointTimes(pointTimes),
+    m_spline(spline)
+{
+}
+
+const QString& CurveSnapshot::name() const
+{
+    return m_name;
+}
+
+quint64 CurveSnapshot::version() const
+{
+    return m_version;
+}
+
+RangeF CurveSnapshot::timeRange() const
+{
+    return m_timeRange;
+}
+
+bool CurveSnapshot::isStep() const
+{
+    return !m_spline;
+}
+
+RangeF CurveSnapshot::valueRange() const
+{
+    return m_valueRange;
+}
+
+const CurveSnapshot::Options& CurveSnapshot::options() const
+{
+    return m_options;
+}
+
+int CurveSnapshot::numberOfPoints() const
+{
+    return m_points.size();
+}
+
+QList<Point> CurveSnapshot::points() const
+{
+    return m_points.values();
+}
+
+const Point CurveSnapshot::point(PointId id) const
+{
+    PointContainer::ConstIterator it = findPoint(id);
+    if (it == m_points.constEnd())
+        return Point();
+
+    return *it;
+}
+
+PointId CurveSnapshot::nextPointId(PointId id) const
+{
+    PointContainer::ConstIterator it = findPoint(id);
+    if (it == m_points.constEnd() || ++it == m_points.constEnd())
+        return PointId::invalidId();
+
+    return it->id();
+}
+
+void CurveSnapshot::forEachPoint(const std::function<void(const Point&)>& visit) const
+{
+    for (PointContainer::ConstIterator it = m_points.constBegin(); it != m_points.constEnd(); ++it)
+        visit(it.value());
+}
+
+void CurveSnapshot::forEachPointInRange(RangeF range, int margin, const std::function<void(const Point&)>& visit) const
+{
+    if (!range.isValid())
+        return;
+
+    PointContainer::ConstIterator first = m_points.lowerBound(range.min);
+    PointContainer::ConstIterator last = m_points.upperBound(range.max);
+
+    for (int i = 0; i < margin && first != m_points.constBegin(); ++i)
+        --first;
+    for (int i = 0; i < margin && last != m_points.constEnd(); ++i)
+        ++last;
+
+    for (PointContainer::ConstIterator it = first; it != last; ++it)
+        visit(it.value());
+}
+
+const CurveSnapshot::Spline* CurveSnapshot::spline() const
+{
+    return m_spline.get();
+}
+
+float CurveSnapshot::valueAt(float time) const
+{
+    float value = 0.0f;
+    sample(time, 0.0f, 1, &value);
+    return value;
+}
+
+void CurveSnapshot::sample(RangeF range, int count, float* out) const
+{
+    const float step = count > 1 ? (range.max - range.min) / (count - 1) : 0.0f;
+    sample(range.min, step, count, out);
+}
+
+void CurveSnapshot::sample(float start, float step, int count, float* out) const
+{
+    if (count <= 0)
+        return;
+
+    if (m_points.isEmpty())
+    {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    if (m_spline)
+        m_spline->sample(start, step, count, out);
+    else
+        sampleSteps(start, step, count, out);
+}
+
+CurveSnapshot::PointContainer::ConstIterator CurveSnapshot::findPoint(PointId id) const
+{
+    auto timeIt = m_pointTimes.constFind(id);
+    if (timeIt == m_pointTimes.constEnd())
+        return m_points.constEnd();
+
+    // Several points may share the same time
+    PointContainer::ConstIterator it = m_points.lowerBound(timeIt.value());
+    for (; it != m_points.constEnd() && it.key() == timeIt.value(); ++it)
+    {
+        if (it->id() == id)
+            return it;
+    }
+    return m_points.constEnd();
+}
+
+void CurveSnapshot::sampleSteps(float start, float step, int count, float* out) const
+{
+    // Latest point at or before start, first point before it
+    PointContainer::ConstIterator next = m_points.upperBound(start);
+    PointContainer::ConstIterator current = next;
+    if (current != m_points.constBegin())
+        --current;
+    float value = current->value().toFloat();
+
+    for (int i = 0; i < count; ++i)
+    {
+        const float time = start + static_cast<float>(i) * step;
+        for (; next != m_points.constEnd() && next.key() <= time; ++next)
+            value = next->value().toFloat();
+
+        out[i] = value;
+    }
+}
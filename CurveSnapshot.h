@@ -0,0 +1,124 @@
+#ifndef CURVESNAPSHOT_H
+#define CURVESNAPSHOT_H
+
+#include "RangeF.h"
+#include "Point.h"
+#include "pt/math/kb_spline.h"
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMultiMap>
+#include <QString>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Immutable copy of curve data at one model version, readable from any thread.
+ *
+ * Snapshots are taken in the thread of the model with CurveModelAbs::snapshot() and can
+ * then be held and read by worker threads without locking while the model keeps changing.
+ *
+ * Taking a snapshot does not copy the curve: the points are implicitly shared and the spline
+ * is shared with the model. The model copies its data on the first modification made while
+ * a snapshot still holds it.
+ */
+class CurveSnapshot
+{
+public:
+    using Spline = pt::math::kb_spline<float>;
+    using PointContainer = QMultiMap<float, Point>;
+    using Options = QMap<int, QString>;
+
+    /** @return Curve name */
+    const QString& name() const;
+
+    /** @return Model version the snapshot was taken at, @see CurveModelAbs::version */
+    quint64 version() const;
+
+    /** @return Curve time range [start, end] */
+    RangeF timeRange() const;
+
+    /** @return True if the curve is a step curve */
+    bool isStep() const;
+
+    /** @return Value range of a spline curve, @see CurveModel::valueRange. Invalid for step curves. */
+    RangeF valueRange() const;
+
+    /** @return Value options of a step curve, @see StepCurveModel::options. Empty for spline curves. */
+    const Options& options() const;
+
+    /** @return The number of points in the curve */
+    int numberOfPoints() const;
+
+    /** @return All points in time order */
+    QList<Point> points() const;
+
+    /** @return Copy of a point with the given id, invalid point for an unknown id */
+    const Point point(PointId id) const;
+
+    /** @return Id of the point following the given one, invalid if there is none */
+    PointId nextPointId(PointId id) const;
+
+    /**
+     * @brief Visit all points without copying them to a list.
+     * @param visit Called for each point in time order
+     */
+    void forEachPoint(const std::function<void(const Point&)>& visit) const;
+
+    /** @see CurveModelAbs::forEachPointInRange */
+    void forEachPointInRange(RangeF range, int margin, const std::function<void(const Point&)>& visit) const;
+
+    /** @return Spline of a spline curve for evaluating it with a cursor, null for step curves */
+    const Spline* spline() const;
+
+    /** @see CurveModelAbs::valueAt */
+    float valueAt(float time) const;
+
+    /** @see CurveModelAbs::sample */
+    void sample(RangeF range, int count, float* out) const;
+
+    /**
+     * @brief Evaluate the curve at times start + i * step.
+     * @param start Time of the first sample
+     * @param step Time between samples
+     * @param count Number of samples
+     * @param out Output for count values
+     */
+    void sample(float start, float step, int count, float* out) const;
+
+private:
+    /** Snapshots are created by the models */
+    friend class CurveModelAbs;
+
+    /**
+     * @brief Construct CurveSnapshot
+     * @param name Curve name
+     * @param version Model version
+     * @param timeRange Curve time range
+     * @param valueRange Value range of a spline curve
+     * @param options Value options of a step curve
+     * @param points Points of the curve, shared with the model
+     * @param pointTimes Time of each point by id, shared with the model
+     * @param spline Spline of a spline curve shared with the model, null for step curves
+     */
+    CurveSnapshot(const QString& name, quint64 version, RangeF timeRange, RangeF valueRange,
+        const Options& options, const PointContainer& points, const QHash<PointId, float>& pointTimes,
+        std::shared_ptr<const Spline> spline);
+
+    /** @return Point with the given id or end if not found */
+    PointContainer::ConstIterator findPoint(PointId id) const;
+
+    /** Sample a step curve, holding the latest point value */
+    void sampleSteps(float start, float step, int count, float* out) const;
+
+    const QString m_name;
+    const quint64 m_version;
+    const RangeF m_timeRange;
+    const RangeF m_valueRange;
+    const Options m_options;
+    const PointContainer m_points;
+    const QHash<PointId, float> m_pointTimes;
+    const std::shared_ptr<const Spline> m_spline; ///< Null for step curves
+};
+
+#endif // CURVESNAPSHOT_H
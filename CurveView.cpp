@@ -1,23 +1,39 @@
 #include "CurveView.h"
-#include "PointView.h"
-#include <QGraphicsPathItem>
+#include "CurvePathItem.h"
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QPen>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 #include <assert.h>
+#include <limits>
 
 CurveView::CurveView(std::shared_ptr<CurveModel> model, QGraphicsItem* parent)
 :   CurveViewAbs(model, parent),
-    m_model(model)
+    m_model(model),
+    m_geometry(CurveGeometry::forModel(model)),
+    m_detailLevel(),
+    m_watcher(new QFutureWatcher<TessellationResult>(this)),
+    m_generation(0),
+    m_unchangedSegmentEnd(std::numeric_limits<int>::max()),
+    m_redrawPending(false)
 {
-    m_spline = new Spline;
-    m_curveView = new QGraphicsPathItem(this);
+    m_curveView = new CurvePathItem(this);
     
     connect(m_model.get(), &CurveModel::valueRangeChanged, this, &CurveView::changeValueRange);
+    connect(m_geometry.get(), &CurveGeometry::changed, this, &CurveView::geometryChanged);
+    connect(m_watcher, &QFutureWatcher<TessellationResult>::finished, this, &CurveView::tessellationFinished);
     updateTransformation();
+    updateTessellationScale();
 }
 
 CurveView::~CurveView()
 {
+    // Worker only uses its own snapshot, but let it stop early
+    m_generation.ref();
+    m_watcher->waitForFinished();
+
+    m_geometry->releaseDetailLevel(this);
 }
 
 CurveView* CurveView::create(std::shared_ptr<CurveModel> model, QGraphicsItem* parent)
@@ -27,15 +43,15 @@ CurveView* CurveView::create(std::shared_ptr<CurveModel> model, QGraphicsItem* p
     return curveView;
 }
 
-std::pair<float, QVariant> CurveView::placeNewPoint(PointId id, PointId nextId) const
+std::pair<float, QVariant> CurveView::placeNewPoint(const CurveSnapshot& curve, PointId id, PointId nextId) const
 {
-    const Point point = m_model->point(id);
+    const Point point = curve.point(id);
 
     if (nextId.isValid())
     {
-        const Point nextPoint = m_model->point(nextId);
+        const Point nextPoint = curve.point(nextId);
         float insertTime = (point.time() + nextPoint.time()) / 2.0f;
-        float insertValue = m_spline->value_at(insertTime);
+        float insertValue = curve.spline()->value_at(insertTime);
         return std::make_pair(insertTime, QVariant(insertValue));
     }
 
@@ -43,32 +59,69 @@ std::pair<float, QVariant> CurveView::placeNewPoint(PointId id, PointId nextId)
     return std::make_pair(point.time() + 1.0, point.value());
 }
 
-bool CurveView::internalAddPoint(PointId id)
+bool CurveView::internalAddPoint(PointId /*id*/)
+{
+    // Model keeps the spline and the shared geometry its tessellation
+    return true;
+}
+
+bool CurveView::internalUpdatePoint(PointId /*id*/)
 {
-    return addToSpline(id);
+    return true;
 }
 
-bool CurveView::internalUpdatePoint(PointId id)
+bool CurveView::internalRemovePoint(PointId /*id*/)
 {
-    const bool removeOk = removeFromSpline(id);
-    const bool addOk = addToSpline(id);
-    return removeOk && addOk;
+    return true;
 }
 
-bool CurveView::internalRemovePoint(PointId id)
+void CurveView::geometryChanged(int firstSegment, RangeF timeRange)
 {
-    return removeFromSpline(id);
+    // Segments of an ongoing tessellation from the first changed one are stale
+    m_generation.ref();
+    m_unchangedSegmentEnd = qMin(m_unchangedSegmentEnd, firstSegment);
+    invalidateEnvelope(timeRange);
 }
 
 void CurveView::changeValueRange(RangeF /*valueRange*/)
 {
     updateTransformation();
+    updateTessellationScale();
 }
 
-void CurveView::updateCurves()
+void CurveView::viewScaleChanged()
+{
+    updateTessellationScale();
+}
+
+void CurveView::updateTessellationScale()
+{
+    // Spline is in model values, scale them to pixels through the normalized value range
+    const RangeF valueRange = m_model->valueRange();
+    const float splineValueScale = detailValueScale() / (valueRange.max - valueRange.min);
+
+    const DetailLevel level(detailTimeScale(), splineValueScale);
+    if (level == m_detailLevel)
+        return;
+
+    // Geometry keeps earlier tessellation of the level, also from other views of the curve
+    m_detailLevel = level;
+    m_geometry->useDetailLevel(this, level);
+
+    // Segments of an ongoing tessellation are for the old level
+    m_generation.ref();
+    m_unchangedSegmentEnd = 0;
+    m_tessellator.setScale(level.first, level.second);
+    updateCurves();
+}
+
+RangeF CurveView::valueEnvelope(float start, float end) const
 {
-    static const float ESPILON = 0.1;
+    return SplineTessellator::envelope(m_model->spline(), start, end);
+}
 
+void CurveView::updateCurves()
+{
     QPen curvePen(Qt::blue);
     curvePen.setCosmetic(true);
     if (isHighlighted())
@@ -77,89 +130,130 @@ void CurveView::updateCurves()
         curvePen.setWidth(curvePen.width() + 1);
         curvePen.setColor(curvePen.color().darker(100));
     }
+    m_curveView->setPen(curvePen);
 
-    auto cur = m_spline->data().begin();
-    if (cur == m_spline->data().end())
+    if (m_watcher->isRunning())
     {
-        // No spline data
-        m_curveView->setPath(QPainterPath());
+        // Coalesce updates, redraw once the job has finished or stopped
+        m_redrawPending = true;
         return;
     }
 
-    constexpr int STEPS_PER_INTERVAL = 20;
+    drawCurve();
+}
 
-    // Start by moving tot the first point
-    QPainterPath path;
-    path.moveTo(QPointF(cur->time(), cur->value()));
+void CurveView::drawCurve()
+{
+    const SplineDataSet& data = m_model->spline().data();
+    const RangeF renderRange = renderTimeRange();
+    if (data.size() == 0 || !renderRange.isValid())
+    {
+        // No spline data or nothing to render
+        m_curveView->setPath(QPainterPath());
+        return;
+    }
 
-    auto next = cur + 1;
-    while (next != m_spline->data().end())
+    const QPolygonF envelopeLines = levelOfDetailLines();
+    if (!envelopeLines.isEmpty())
     {
-        const float startTime = cur->time();
-        const float endTime = next->time();
+        // Points are denser than pixels, draw value envelope instead of individual segments
+        QPainterPath path;
+        path.addPolygon(envelopeLines);
+        m_curveView->setPath(path);
+        return;
+    }
 
-        const float time_diff = endTime - startTime;
+    // Segments overlapping the render range: from the last point at or before range start
+    // until the first point at or after range end
+    auto compareTime = [](float time, const SplineDataSet::point& point) { return time < point.time(); };
+    auto firstPoint = std::upper_bound(data.begin(), data.end(), renderRange.min, compareTime);
+    auto lastPoint = std::upper_bound(firstPoint, data.end(), renderRange.max, compareTime);
+    const int firstSegment = qMax(static_cast<int>(firstPoint - data.begin()) - 1, 0);
+    const QVector<QPolygonF> segments = m_geometry->segments(m_detailLevel);
+    const int endSegment = qMin(static_cast<int>(lastPoint - data.begin()), segments.size());
 
-        if (time_diff > ESPILON)
-        {
-            // If consequtive points have meaningful time difference between them approximate the curve with STEPS_PER_INTERVAL straight lines
-            const float step = time_diff / STEPS_PER_INTERVAL;
-
-            // Start from startTime + step as the first point is handled either
-            // before the loop (moveTo) or by the previous interval. Only loop
-            // until the last point before endTime as the last line is draw outside the
-            // loop.
-            float time = startTime;
-            for (int i = 0; i < STEPS_PER_INTERVAL - 1; ++i)
-            {
-                time += step;
-                path.lineTo(QPointF(time, m_spline->value_at(time)));
-            }
-        }
+    TessellationJob job;
+    job.generation = m_generation.load();
+    job.firstSegment = firstSegment;
+    job.segments = segments.mid(firstSegment, endSegment - firstSegment);
+    job.tessellator = m_tessellator;
 
-        // End the curve section to the next point
-        path.lineTo(QPointF(endTime, next->value()));
-        ++cur;
-        ++next;
+    auto isEmpty = [](const QPolygonF& segment) { return segment.isEmpty(); };
+    if (std::none_of(job.segments.constBegin(), job.segments.constEnd(), isEmpty))
+    {
+        // Everything is cached, only the path needs to be built
+        job.points.push_back(*data.get(firstSegment));
+        m_curveView->setPath(tessellateInBackground(job, &m_generation).path);
+        return;
     }
-        
-    m_curveView->setPen(curvePen);
-    m_curveView->setPath(path);
+
+    // Worker gets its own copy of the points, spline may change while it is running
+    job.points.assign(data.get(firstSegment), data.get(endSegment) + 1);
+    m_unchangedSegmentEnd = std::numeric_limits<int>::max();
+    m_watcher->setFuture(QtConcurrent::run(&CurveView::tessellateInBackground, job, &m_generation));
 }
 
-bool CurveView::addToSpline(PointId id)
+void CurveView::tessellationFinished()
 {
-    if (!id.isValid())
-        return false;
+    const TessellationResult result = m_watcher->result();
 
-    const Point point = m_model->point(id);
-    const CurveModel::KbParams params = m_model->params(id);
+    if (result.generation == m_generation.load())
+    {
+        // Curve is unchanged since the job started, keep the tessellated segments
+        m_geometry->storeSegments(m_detailLevel, result.firstSegment, result.segments);
+        m_curveView->setPath(result.path);
+    }
+    else if (m_unchangedSegmentEnd > result.firstSegment)
+    {
+        // Segments before the changed ones still have the same index and shape
+        const int unchangedCount = qMin(m_unchangedSegmentEnd - result.firstSegment, result.segments.size());
+        m_geometry->storeSegments(m_detailLevel, result.firstSegment, result.segments.mid(0, unchangedCount));
+    }
 
-    const pt::math::kochanek_bartels_parameters kb_params(params.tension(), params.bias(), params.continuity());
-    pt::math::kb_data_set<float>::point p(id, point.time(), point.value().toFloat(), kb_params);
-    auto point_iter = m_spline->data().add(p);
-    if (point_iter == m_spline->data().end())
-        return false;
-    
-    return true;
+    if (m_redrawPending)
+    {
+        m_redrawPending = false;
+        drawCurve();
+    }
 }
 
-bool CurveView::removeFromSpline(PointId id)
+CurveView::TessellationResult CurveView::tessellateInBackground(TessellationJob job, const QAtomicInt* generation)
 {
-    if (!id.isValid())
-        return false;
-    
-    auto point_iter = findSplinePoint(id);
-    if (point_iter == m_spline->data().end())
-        return false;
+    // Number of segments tessellated between checks for a newer generation
+    static const int CANCEL_CHECK_INTERVAL = 64;
 
-    m_spline->data().erase(point_iter);
-    return true;
-}
+    TessellationResult result;
+    result.generation = job.generation;
+    result.firstSegment = job.firstSegment;
 
-CurveView::SplineDataSet::iterator CurveView::findSplinePoint(PointId id) const
-{
-    return m_spline->data().get_point(id);
+    // Start by moving to the first point
+    QPainterPath path;
+    auto start = job.points.cbegin();
+    path.moveTo(QPointF(start->time(), start->value()));
+
+    // Tessellate only modified segments, reuse the rest
+    int tessellated = 0;
+    for (int i = 0; i < job.segments.size(); ++i)
+    {
+        if (job.segments[i].isEmpty())
+        {
+            if (++tessellated % CANCEL_CHECK_INTERVAL == 0 && generation->load() != job.generation)
+            {
+                // Segments finished so far may still be usable
+                result.segments = job.segments.mid(0, i);
+                return result;
+            }
+
+            job.segments[i] = job.tessellator.tessellateSegment(start + i);
+        }
+
+        for (const QPointF& point : job.segments[i])
+            path.lineTo(point);
+    }
+
+    result.segments = job.segments;
+    result.path = path;
+    return result;
 }
 
 void CurveView::updateTransformation()
@@ -1,16 +1,33 @@
 #ifndef CURVEVIEW_H
 #define CURVEVIEW_H
 
+#include "CurveGeometry.h"
 #include "CurveModel.h"
 #include "CurveViewAbs.h"
-#include "pt/math/kb_spline.h"
+#include "SplineTessellator.h"
+#include <QAtomicInt>
 #include <QObject>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QVector>
 #include <memory>
+#include <vector>
+
+class CurvePathItem;
+
+QT_BEGIN_NAMESPACE
+template <typename T> class QFutureWatcher;
+QT_END_NAMESPACE
 
 /**
  * A spline view for a curve model.
  * Time axis (x) is unscaled in this view.
  * Valu axis (y) is scaled so the model value range [min, max] maps to range [0, 1].
+ *
+ * The curve is evaluated with the spline of the model. Tessellation is shared with
+ * other views of the same curve through CurveGeometry. Segments without cached tessellation are tessellated in a worker
+ * thread from a snapshot of the spline points. The finished path replaces the shown one, unless
+ * the curve changed again in the meantime. Finished segments before the changed ones are kept.
  */
 class CurveView : public CurveViewAbs
 {
@@ -25,6 +42,7 @@ private:
     CurveView(std::shared_ptr<CurveModel> model, QGraphicsItem* parent);
     
 public:
+    /** Destructor. Cancels and waits for a possible ongoing tessellation. */
     ~CurveView();
 
     /**
@@ -36,28 +54,73 @@ public:
 private slots:
     void changeValueRange(RangeF valueRange);
 
+    /** Background tessellation finished */
+    void tessellationFinished();
+
+    /** Shared spline changed, @see CurveGeometry::changed */
+    void geometryChanged(int firstSegment, RangeF timeRange);
+
     virtual bool internalAddPoint(PointId id) override;
     virtual bool internalUpdatePoint(PointId id) override;
     virtual bool internalRemovePoint(PointId id) override;
 
 private:
-    virtual std::pair<float, QVariant> placeNewPoint(PointId id, PointId nextId) const override;
+    virtual std::pair<float, QVariant> placeNewPoint(const CurveSnapshot& curve, PointId id, PointId nextId) const override;
 
+    virtual RangeF valueEnvelope(float start, float end) const override;
     virtual void updateCurves() override;
+    /** Draw the curve path, possibly starting a background tessellation */
+    void drawCurve();
+    virtual void viewScaleChanged() override;
     void updateTransformation();
+    void updateTessellationScale();
 
     std::shared_ptr<CurveModel> m_model;
     
     // Spline
-    using Spline = pt::math::kb_spline<float>;
-	using SplineDataSet = pt::math::kb_data_set<float>;
-    
-    bool addToSpline(PointId id);
-    bool removeFromSpline(PointId id);
-    SplineDataSet::iterator findSplinePoint(PointId id) const;
-    
-    Spline* m_spline;
-    QGraphicsPathItem* m_curveView;
+    using SplineDataSet = pt::math::kb_data_set<float>;
+    using DetailLevel = CurveGeometry::DetailLevel;
+
+    /** Tessellation shared with other views of the curve */
+    std::shared_ptr<CurveGeometry> m_geometry;
+    CurvePathItem* m_curveView;
+
+    SplineTessellator m_tessellator;
+    DetailLevel m_detailLevel; ///< Tessellation level in use, matches the tessellator scale
+
+    /** Segments to tessellate in a worker thread */
+    struct TessellationJob
+    {
+        int generation;
+        int firstSegment;
+        /** Copy of spline points from the first segment start until the last segment end */
+        std::vector<SplineDataSet::point> points;
+        /** Cached tessellation of the segments, empty where tessellation is needed */
+        QVector<QPolygonF> segments;
+        SplineTessellator tessellator;
+    };
+
+    /** Result of a background tessellation */
+    struct TessellationResult
+    {
+        int generation;
+        int firstSegment;
+        QVector<QPolygonF> segments;
+        QPainterPath path;
+    };
+
+    /**
+     * @brief Tessellate segments and build the curve path. Executed in a worker thread.
+     * @param job Segments to tessellate
+     * @param generation Current curve generation, tessellation is abandoned if it no longer matches the job
+     * @return Result, path is empty and only the segments finished so far are included if the job was abandoned
+     */
+    static TessellationResult tessellateInBackground(TessellationJob job, const QAtomicInt* generation);
+
+    QFutureWatcher<TessellationResult>* m_watcher;
+    QAtomicInt m_generation; ///< Incremented when segments change to detect stale tessellation
+    int m_unchangedSegmentEnd; ///< Segments before this index are unchanged since the tessellation started
+    bool m_redrawPending; ///< Curve changed while a tessellation was running
 };
 
 
@@ -1,16 +1,33 @@
 #include "CurveViewAbs.h"
 #include "CurveModelAbs.h"
-#include "PointView.h"
+#include "PointHandleLayer.h"
+#include "RedrawScheduler.h"
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentMap>
 #include <assert.h>
+#include <cmath>
 
 CurveViewAbs::CurveViewAbs(std::shared_ptr<CurveModelAbs> model, QGraphicsItem* parent)
   : TransformationNode(parent),
     m_model(model),
     m_snapGridRect(QRectF()),
     m_snapToGrid(false),
-    m_highlightCurve(model->isSelected())
+    m_highlightCurve(model->isSelected()),
+    m_timeScale(1.0f),
+    m_valueScale(1.0f),
+    m_detailTimeScale(1.0f),
+    m_detailValueScale(1.0f),
+    m_visibleTimeRange(),
+    m_renderTimeRange(),
+    m_envelopePyramid([this](float start, float end) { return valueEnvelope(start, end); })
 {
+    // Handles are drawn over the curve
+    m_handles = new PointHandleLayer(model, this);
+    m_handles->setZValue(1);
+
+    // Handle size in curve coordinates follows curve transformation
+    setFlags(flags() | QGraphicsItem::ItemSendsGeometryChanges);
+
     // Connecting to model is done in init() to avoid virtual calls from constructor
 }
 
@@ -18,11 +35,48 @@ void CurveViewAbs::init()
 {
     connect(m_model.get(), &CurveModelAbs::selectedChanged, this, &CurveViewAbs::highlightCurve);
     connect(m_model.get(), &CurveModelAbs::pointAdded, this, &CurveViewAbs::addPoint);
+    connect(m_model.get(), &CurveModelAbs::pointsAdded, this, &CurveViewAbs::addPoints);
     connect(m_model.get(), &CurveModelAbs::pointUpdated, this, &CurveViewAbs::updatePoint);
+    connect(m_model.get(), &CurveModelAbs::pointsUpdated, this, &CurveViewAbs::updatePoints);
     connect(m_model.get(), &CurveModelAbs::pointRemoved, this, &CurveViewAbs::removePoint);
+    connect(m_model.get(), &CurveModelAbs::pointsRemoved, this, &CurveViewAbs::removePoints);
+    connect(m_model.get(), &CurveModelAbs::timeRangeChanged, this, &CurveViewAbs::changeTimeRange);
+    connect(m_model.get(), &CurveModelAbs::pointSelected, this, &CurveViewAbs::updatePointSelection);
+    connect(m_model.get(), &CurveModelAbs::pointDeselected, this, &CurveViewAbs::updatePointSelection);
+    connect(m_model.get(), &CurveModelAbs::pointsSelectedChanged, this, &CurveViewAbs::updatePointsSelection);
+
+    addPoints(m_model->pointIds());
+}
+
+void CurveViewAbs::setVisibleTimeRange(RangeF timeRange)
+{
+    m_visibleTimeRange = timeRange;
+
+    // Keep current graphics while the visible range stays within the margins.
+    // Render range is padded again when the detail level changes.
+    if (m_renderTimeRange.isInRange(timeRange.min) && m_renderTimeRange.isInRange(timeRange.max))
+        return;
+
+    updateRenderTimeRange();
+    updateCurves();
+}
+
+void CurveViewAbs::updateRenderTimeRange()
+{
+    if (!m_visibleTimeRange.isValid())
+    {
+        m_renderTimeRange = RangeF();
+        return;
+    }
 
-    for (auto pid : m_model->pointIds())
-        addPoint(pid);
+    // Zooming out within the detail level widens the visible range up to twice its width
+    // at the detail scale. Extend by that width on both sides, so scrolling and zooming
+    // within the level keep the graphics.
+    const float visibleWidth = m_visibleTimeRange.max - m_visibleTimeRange.min;
+    const float margin = m_timeScale > 0.0f && m_detailTimeScale > 0.0f
+        ? 2.0f * visibleWidth * m_timeScale / m_detailTimeScale
+        : visibleWidth;
+    m_renderTimeRange = RangeF(m_visibleTimeRange.min - margin, m_visibleTimeRange.max + margin);
 }
 
 CurveViewAbs::~CurveViewAbs()
@@ -35,7 +89,10 @@ void CurveViewAbs::setSnapGrid(QRectF gridRect)
     {
         m_snapGridRect = gridRect;
         if (m_snapToGrid)
+        {
+            m_handles->setSnapGrid(getSnapGrid());
             emit snapGridChanged(getSnapGrid());
+        }
     }
 }
 
@@ -44,6 +101,7 @@ void CurveViewAbs::setSnapToGrid(bool snapToGrid)
     if (m_snapToGrid != snapToGrid)
     {
         m_snapToGrid = snapToGrid;
+        m_handles->setSnapGrid(getSnapGrid());
         emit snapGridChanged(getSnapGrid());
     }
 }
@@ -58,35 +116,103 @@ void CurveViewAbs::highlightCurve(bool highlight)
     }
 }
 
-void CurveViewAbs::duplicateSelectedPoints()
+void CurveViewAbs::setViewScale(float timeScale, float valueScale)
 {
-    qDebug() << "CurveViewAbs::duplicateSelectedPoints";
+    if (m_timeScale != timeScale || m_valueScale != valueScale)
+    {
+        m_timeScale = timeScale;
+        m_valueScale = valueScale;
+        m_handles->pixelSizeChanged();
+    }
+
+    // Geometry is rebuilt only when zooming crosses a power of two
+    const float detailTimeScale = timeScale > 0.0f ? std::exp2(std::ceil(std::log2(timeScale))) : timeScale;
+    const float detailValueScale = valueScale > 0.0f ? std::exp2(std::ceil(std::log2(valueScale))) : valueScale;
+    if (m_detailTimeScale != detailTimeScale || m_detailValueScale != detailValueScale)
+    {
+        // Range drawn at another time level may be much wider or narrower than needed now
+        if (m_detailTimeScale != detailTimeScale)
+        {
+            m_detailTimeScale = detailTimeScale;
+            updateRenderTimeRange();
+        }
+
+        m_detailValueScale = detailValueScale;
+        viewScaleChanged();
+    }
+}
+
+namespace {
+
+/** Placing new points for the selected points of one curve */
+struct DuplicateJob
+{
+    const CurveViewAbs* view;
+    std::shared_ptr<CurveModelAbs> curve;
+    std::shared_ptr<const CurveSnapshot> snapshot; ///< Curve data read by the worker
+    QList<PointId> selected;
+    QVector<CurveModelAbs::NewPoint> newPoints;
+};
+
+void placeDuplicates(DuplicateJob& job)
+{
+    job.newPoints = job.view->placeDuplicates(*job.snapshot, job.selected);
+}
 
-    QSet<PointId> toBeDuplicated;
+} // anonymous namespace
 
-    for (auto &point : m_pointViews)
-        if (point->isSelected())
-            toBeDuplicated.insert(point->pointId());
+void CurveViewAbs::duplicateSelectedPoints(const QList<CurveViewAbs*>& views)
+{
+    QVector<DuplicateJob> jobs;
+    int selectedCount = 0;
+    for (const CurveViewAbs* view : views)
+    {
+        // Selection is tracked by the model, also for points without a view
+        const QList<PointId> selected = view->m_model->selectedPointIds();
+        if (selected.isEmpty())
+            continue;
+
+        DuplicateJob job;
+        job.view = view;
+        job.curve = view->m_model;
+        job.snapshot = view->m_model->snapshot();
+        job.selected = selected;
+        jobs.push_back(job);
+        selectedCount += selected.size();
+    }
 
-    for (auto pid : toBeDuplicated)
+    if (jobs.size() > 1 && selectedCount >= PARALLEL_DUPLICATE_THRESHOLD)
+    {
+        // Curves are independent, workers read only their snapshots
+        QtConcurrent::blockingMap(jobs, placeDuplicates);
+    }
+    else
     {
-        std::pair<float, QVariant> timeValue = placeNewPoint(pid, m_model->nextPointId(pid));
-        m_model->addPoint(timeValue.first, timeValue.second);
+        for (DuplicateJob& job : jobs)
+            placeDuplicates(job);
+    }
+
+    // Models are modified in their own thread, one batch per curve.
+    // Release the snapshot first so the model does not copy its data for it.
+    for (DuplicateJob& job : jobs)
+    {
+        job.snapshot.reset();
+        job.curve->addPoints(job.newPoints);
     }
 }
 
-void CurveViewAbs::removeSelectedPoints()
+QVector<CurveModelAbs::NewPoint> CurveViewAbs::placeDuplicates(const CurveSnapshot& curve, const QList<PointId>& ids) const
 {
-    qDebug() << "CurveViewAbs::removeSelectedPoints";
-
-    QSet<PointId> toBeRemoved;
+    QVector<CurveModelAbs::NewPoint> newPoints;
+    newPoints.reserve(ids.size());
 
-    for (auto &point : m_pointViews)
-        if (point->isSelected())
-            toBeRemoved.insert(point->pointId());
+    for (PointId id : ids)
+    {
+        const std::pair<float, QVariant> timeValue = placeNewPoint(curve, id, curve.nextPointId(id));
+        newPoints.append(CurveModelAbs::NewPoint(timeValue.first, timeValue.second));
+    }
 
-    for (auto pid : toBeRemoved)
-        m_model->removePoint(pid);
+    return newPoints;
 }
 
 void CurveViewAbs::addPoint(PointId id)
@@ -95,7 +221,6 @@ void CurveViewAbs::addPoint(PointId id)
     assert(m_model);
 
     assert(id.isValid());
-    assert(!findPointView(id));
 
     if (!internalAddPoint(id))
     {
@@ -103,14 +228,10 @@ void CurveViewAbs::addPoint(PointId id)
         return;
     }
 
-    PointView* pointView = new PointView(m_model->point(id), this);
-    m_pointViews.insert(id, pointView);
-    connect(pointView, &PointView::pointPositionChanged, m_model.get(), &CurveModelAbs::updatePoint);
-    connect(pointView, &PointView::pointSelectedChanged, m_model.get(), &CurveModelAbs::pointSelectedChanged);
-    connect(this, &CurveViewAbs::snapGridChanged, pointView, &PointView::setSnapGrid);
-    pointView->setSnapGrid(getSnapGrid());
+    m_handles->pointChanged(m_model->point(id));
 
-    updateCurves();
+    updateTimeExtent();
+    scheduleUpdateCurves();
 }
 
 void CurveViewAbs::updatePoint(PointId id)
@@ -118,18 +239,50 @@ void CurveViewAbs::updatePoint(PointId id)
     qDebug() << "CurveView::updatePoint" << id;
     assert(id.isValid());
 
-    PointView* pointView = findPointView(id);
-    assert(pointView);
-
     if (!internalUpdatePoint(id))
     {
         qWarning() << "Internal point update failed for" << id;
         return;
     }
 
-    pointView->setPoint(m_model->point(id));
+    m_handles->pointChanged(m_model->point(id));
 
-    updateCurves();
+    updateTimeExtent();
+    scheduleUpdateCurves();
+}
+
+void CurveViewAbs::addPoints(QList<PointId> ids)
+{
+    qDebug() << "CurveViewAbs::addPoints" << ids.size();
+
+    if (ids.isEmpty())
+        return;
+
+    for (PointId id : ids)
+    {
+        if (!internalAddPoint(id))
+        {
+            qWarning() << "Internal point add failed for" << id;
+            continue;
+        }
+
+        m_handles->pointChanged(m_model->point(id));
+    }
+
+    updateTimeExtent();
+    scheduleUpdateCurves();
+}
+
+void CurveViewAbs::updatePoints(QList<PointId> ids)
+{
+    if (!internalUpdatePoints(ids))
+        qWarning() << "Internal point update failed for some of" << ids.size() << "points";
+
+    for (PointId id : ids)
+        m_handles->pointChanged(m_model->point(id));
+
+    updateTimeExtent();
+    scheduleUpdateCurves();
 }
 
 void CurveViewAbs::removePoint(PointId id)
@@ -142,14 +295,121 @@ void CurveViewAbs::removePoint(PointId id)
         // Point will be deleted anyways
     }
 
-    PointView* pointView = findPointView(id);
-    assert(pointView);
-    delete pointView;
+    m_handles->update();
 
-    int numberOfRemoved = m_pointViews.remove(id);
-    assert(numberOfRemoved == 1);
+    updateTimeExtent();
+    scheduleUpdateCurves();
+}
 
-    updateCurves();
+void CurveViewAbs::removePoints(QList<PointId> ids)
+{
+    qDebug() << "CurveViewAbs::removePoints" << ids.size();
+
+    for (PointId id : ids)
+    {
+        if (!internalRemovePoint(id))
+            qWarning() << "Internal point remove failed for" << id;
+    }
+
+    m_handles->update();
+
+    updateTimeExtent();
+    scheduleUpdateCurves();
+}
+
+bool CurveViewAbs::internalUpdatePoints(const QList<PointId>& ids)
+{
+    bool ok = true;
+    for (PointId id : ids)
+        ok = internalUpdatePoint(id) && ok;
+    return ok;
+}
+
+void CurveViewAbs::updatePointSelection(PointId id)
+{
+    Q_UNUSED(id);
+    m_handles->update();
+}
+
+void CurveViewAbs::updatePointsSelection(QList<PointId> ids, bool isSelected)
+{
+    Q_UNUSED(ids);
+    Q_UNUSED(isSelected);
+    m_handles->update();
+}
+
+void CurveViewAbs::changeTimeRange(RangeF timeRange)
+{
+    Q_UNUSED(timeRange);
+
+    // Envelope covers the curve time range, build again on next draw
+    m_envelopePyramid.clear();
+    updateTimeExtent();
+    scheduleUpdateCurves();
+}
+
+RangeF CurveViewAbs::timeExtent() const
+{
+    return RangeF::makeUnion(m_model->timeRange(), m_model->pointTimeRange());
+}
+
+void CurveViewAbs::setRedrawScheduler(RedrawScheduler* scheduler)
+{
+    if (m_redrawScheduler && m_redrawScheduler->isScheduled(this))
+    {
+        // Don't leave a pending redraw behind
+        m_redrawScheduler->cancel(this);
+        updateCurves();
+    }
+
+    m_redrawScheduler = scheduler;
+}
+
+void CurveViewAbs::scheduleUpdateCurves()
+{
+    if (!m_redrawScheduler)
+    {
+        updateCurves();
+        return;
+    }
+
+    m_redrawScheduler->schedule(this, [this]() { updateCurves(); });
+}
+
+void CurveViewAbs::updateTimeExtent()
+{
+    const RangeF extent = timeExtent();
+    if (extent == m_timeExtent)
+        return;
+
+    m_timeExtent = extent;
+    emit timeExtentChanged(m_timeExtent);
+}
+
+QPolygonF CurveViewAbs::levelOfDetailLines()
+{
+    const RangeF timeRange = m_model->timeRange();
+    if (!timeRange.isValid() || !(timeRange.max > timeRange.min) || !m_renderTimeRange.isValid() || !(m_detailTimeScale > 0.0f))
+        return QPolygonF();
+
+    // Draw in full detail while points within the drawn range are sparser than pixels.
+    // Counting stops past the column count, so dense ranges cost no more than the columns.
+    const int columnCount = static_cast<int>((m_renderTimeRange.max - m_renderTimeRange.min) * m_detailTimeScale);
+    if (m_model->numberOfPointsInRange(m_renderTimeRange, columnCount + 1) <= columnCount)
+        return QPolygonF();
+
+    // Columns at most a pixel wide, fixed within a detail level. Level 0 buckets match the finest
+    // columns needed so far, buckets are computed only for the columns drawn.
+    const float columnWidth = 1.0f / m_detailTimeScale;
+    if (m_envelopePyramid.levelFor(columnWidth) < 0)
+        m_envelopePyramid.build(timeRange, columnWidth);
+
+    return m_envelopePyramid.lines(m_renderTimeRange, columnWidth);
+}
+
+void CurveViewAbs::invalidateEnvelope(RangeF timeRange)
+{
+    m_envelopePyramid.invalidate(timeRange);
 }
 
 QRectF CurveViewAbs::getSnapGrid() const
@@ -162,7 +422,41 @@ bool CurveViewAbs::isHighlighted() const
     return m_highlightCurve;
 }
 
-PointView* CurveViewAbs::findPointView(PointId id) const
+RangeF CurveViewAbs::renderTimeRange() const
 {
-    return m_pointViews.value(id, nullptr);
+    return m_renderTimeRange;
+}
+
+float CurveViewAbs::timeScale() const
+{
+    return m_timeScale;
+}
+
+float CurveViewAbs::valueScale() const
+{
+    return m_valueScale;
+}
+
+float CurveViewAbs::detailTimeScale() const
+{
+    return m_detailTimeScale;
+}
+
+float CurveViewAbs::detailValueScale() const
+{
+    return m_detailValueScale;
+}
+
+void CurveViewAbs::viewScaleChanged()
+{
+    // Level of detail envelope columns follow the time scale
+    scheduleUpdateCurves();
+}
+
+QVariant CurveViewAbs::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    if (change == QGraphicsItem::ItemTransformHasChanged)
+        m_handles->pixelSizeChanged();
+
+    return TransformationNode::itemChange(change, value);
 }
@@ -2,14 +2,19 @@
 #define CURVEVIEWABS_H
 
 #include "TransformationNode.h"
+#include "CurveModelAbs.h"
+#include "MinMaxPyramid.h"
 #include "PointId.h"
-#include <QMap>
+#include "RangeF.h"
 #include <QObject>
+#include <QPointer>
+#include <QPolygonF>
 #include <QVariant>
+#include <QVector>
 #include <memory>
 
-class PointView;
-class CurveModelAbs;
+class PointHandleLayer;
+class RedrawScheduler;
 
 /** Abstract base class for curve views. Takes care of common curve view functions. */
 class CurveViewAbs :
@@ -34,7 +39,44 @@ protected:
 public:
     ~CurveViewAbs();
 
+    /** @return Time range covered by the curve and its points, invalid if there is nothing to show. */
+    RangeF timeExtent() const;
+
+    /**
+     * @brief Set scheduler for coalescing redraws after point changes.
+     * Without a scheduler the curve is redrawn immediately on every change.
+     * @param scheduler Redraw scheduler, may be null
+     */
+    void setRedrawScheduler(RedrawScheduler* scheduler);
+
+    /** Number of selected points from which new points of different curves are placed in a thread pool */
+    static const int PARALLEL_DUPLICATE_THRESHOLD = 4096;
+
+    /**
+     * @brief Create a new point for each selected point in the curves of the views.
+     *
+     * New points are placed from curve snapshots, curves in parallel for large selections,
+     * and then added to each curve in one batch.
+     * @param views Views of the curves
+     */
+    static void duplicateSelectedPoints(const QList<CurveViewAbs*>& views);
+
+    /**
+     * @brief Place new points duplicating existing ones, @see duplicateSelectedPoints.
+     * Reads only the snapshot, so can be called from any thread.
+     * @param curve Snapshot of the curve of the view
+     * @param ids Duplicated points
+     * @return Time and value for a new point per duplicated point
+     */
+    QVector<CurveModelAbs::NewPoint> placeDuplicates(const CurveSnapshot& curve, const QList<PointId>& ids) const;
+
 signals:
+    /**
+     * @brief Time range covered by the curve changed
+     * @param timeExtent New time extent
+     */
+    void timeExtentChanged(RangeF timeExtent);
+
     /**
      * @brief Curve snap grid has changed
      * @param gridRect New snap grid
@@ -59,11 +101,19 @@ public slots:
      */
     void highlightCurve(bool highlight);
 
-    /** @brief Add new points corresponding to all selected points in the curve. */
-    void duplicateSelectedPoints();
+    /**
+     * @brief Set on-screen scale of the view.
+     * @param timeScale Pixels per time unit
+     * @param valueScale Pixels per the normalized [0, 1] value range of the view
+     */
+    void setViewScale(float timeScale, float valueScale);
 
-    /** @brief Remove all selected points in the curve. */
-    void removeSelectedPoints();
+    /**
+     * @brief Set time range visible on screen. Curve graphics are created
+     * only around the visible range.
+     * @param timeRange Visible time range
+     */
+    void setVisibleTimeRange(RangeF timeRange);
 
 private slots:
     /**
@@ -76,11 +126,45 @@ private slots:
      * @param id Updated point
      */
     void updatePoint(PointId id);
+    /**
+     * @brief Add several points to the view, redrawing the curve once
+     * @param ids Added points
+     */
+    void addPoints(QList<PointId> ids);
+    /**
+     * @brief Update several existing points in the view, redrawing the curve once
+     * @param ids Updated points
+     */
+    void updatePoints(QList<PointId> ids);
     /**
      * @brief Remove point from the view
      * @param id Removed point
      */
     void removePoint(PointId id);
+    /**
+     * @brief Remove several points from the view, redrawing the curve once
+     * @param ids Removed points
+     */
+    void removePoints(QList<PointId> ids);
+
+    /**
+     * @brief Curve time range changed
+     * @param timeRange New time range
+     */
+    void changeTimeRange(RangeF timeRange);
+
+    /**
+     * @brief Point selection changed
+     * @param id Selected or deselected point
+     */
+    void updatePointSelection(PointId id);
+
+    /**
+     * @brief Selection of several points changed
+     * @param ids Selected or deselected points
+     * @param isSelected True if the points were selected
+     */
+    void updatePointsSelection(QList<PointId> ids, bool isSelected);
 
 protected:
     /** @return current effective snap grid. Affected also by whether snapping is enabled.*/
@@ -89,6 +173,58 @@ protected:
     /** @return true if curve is highlighted */
     bool isHighlighted() const;
 
+    /** @return Pixels per time unit */
+    float timeScale() const;
+    /** @return Pixels per the normalized [0, 1] value range of the view */
+    float valueScale() const;
+
+    /**
+     * @return Time scale for building curve geometry. Time scale rounded up to a power of two,
+     * so geometry is at least as detailed as needed and stays valid while zooming within the level.
+     */
+    float detailTimeScale() const;
+    /** @return Value scale for building curve geometry, rounded up to a power of two like detailTimeScale() */
+    float detailValueScale() const;
+
+    /**
+     * @return Time range for which graphics are created. Covers the visible time range with a
+     * margin on both sides, wide enough for zooming out within the detail level.
+     * Invalid until a visible range is set.
+     */
+    RangeF renderTimeRange() const;
+
+    /** Track transformation changes, which change handle size in curve coordinates */
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
+
+    /**
+     * Notification to derived class that the detail scale changed and curve geometry should be
+     * built again. Zooming within a detail level only changes the view transformation.
+     * Redraws the curve by default.
+     */
+    virtual void viewScaleChanged();
+
+    /**
+     * @brief Lines tracing the min/max value envelope of the curve within render time range.
+     * Used when zoomed out so far that curve points within the render time range are denser than pixels.
+     * @return Envelope lines with a vertical line per pixel column, or empty if the
+     * curve should be drawn in full detail.
+     */
+    QPolygonF levelOfDetailLines();
+
+    /**
+     * @brief Update level of detail envelope after the curve changed.
+     * @param timeRange Time range where curve values changed
+     */
+    void invalidateEnvelope(RangeF timeRange);
+
+    /**
+     * @brief Get value range of the curve as drawn, in view coordinates.
+     * @param start Time range start
+     * @param end Time range end
+     * @return Minimum and maximum value within [start, end], invalid if nothing is drawn there.
+     */
+    virtual RangeF valueEnvelope(float start, float end) const = 0;
+
     /** Notification to derived class to re-draw the curve. */
     virtual void updateCurves() = 0;
 
@@ -104,6 +240,13 @@ protected:
      * @return True if internal point update succeeded. If it failed point won't be updated.
      */
     virtual bool internalUpdatePoint(PointId id) = 0;
+    /**
+     * @brief Chance for derived class to perform operations on a batched point update.
+     * By default calls internalUpdatePoint for each point.
+     * @param ids Updated points
+     * @return True if internal update succeeded for all points.
+     */
+    virtual bool internalUpdatePoints(const QList<PointId>& ids);
     /**
      * @brief Chance for derived class to perform operations on point remove.
      * @param id Removed point
@@ -113,22 +256,44 @@ protected:
 
     /**
      * @brief Get time and value for a new point to be duplicated from an existing point.
+     * Called from worker threads, must read only the snapshot.
+     * @param curve Snapshot of the curve
      * @param id Duplicated point id
      * @param nextId Next point id from the duplicated point (invalid if no next point)
      * @return Time-value pair for the new point.
      */
-    virtual std::pair<float, QVariant> placeNewPoint(PointId id, PointId nextId) const = 0;
+    virtual std::pair<float, QVariant> placeNewPoint(const CurveSnapshot& curve, PointId id, PointId nextId) const = 0;
 
 private:
-    PointView* findPointView(PointId id) const;
+    /** Notify time extent if points or the time range moved it */
+    void updateTimeExtent();
+
+    /** Redraw the curve through the redraw scheduler, or immediately if there is none */
+    void scheduleUpdateCurves();
+
+    /** Pad the render time range around the visible time range for the current detail level */
+    void updateRenderTimeRange();
 
     std::shared_ptr<CurveModelAbs> m_model;
-    QMap<PointId, PointView*> m_pointViews;
+    PointHandleLayer* m_handles;
 
     QRectF m_snapGridRect;
     bool m_snapToGrid;
 
     bool m_highlightCurve;
+
+    float m_timeScale;
+    float m_valueScale;
+    float m_detailTimeScale;
+    float m_detailValueScale;
+
+    RangeF m_visibleTimeRange;
+    RangeF m_renderTimeRange;
+    RangeF m_timeExtent; ///< Time extent last notified with timeExtentChanged
+
+    QPointer<RedrawScheduler> m_redrawScheduler;
+
+    MinMaxPyramid m_envelopePyramid; ///< Level of detail, built when first needed
 };
 
 
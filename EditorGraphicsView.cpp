@@ -1,4 +1,5 @@
 #include "EditorGraphicsView.h"
+#include "PointHandleLayer.h"
 #include "TransformationNode.h"
 #include "ScrollPositionKeeper.h"
 
@@ -6,10 +7,25 @@
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
 #include <QDebug>
+#include <QMouseEvent>
+#include <QOpenGLWidget>
 #include <QResizeEvent>
 #include <QWheelEvent>
 #include <QScrollBar>
 
+namespace
+{
+
+/** Room for graphics that are fixed size in pixels and reach past the content time range, like point labels */
+const qreal CONTENT_MARGIN = 100;
+
+/** Default scale to 10 pixels per second */
+const float DEFAULT_TIME_SCALE = 10.0f;
+/** Value scale until the view gets its size, pixels for the normalized value range [0, 1] */
+const float DEFAULT_VALUE_SCALE = 100.0f;
+
+}
+
 // A custom scene to handle right-mouse click without deselecting all
 class EditorGraphicsScene : public QGraphicsScene
 {
@@ -37,11 +53,19 @@ public:
 
 EditorGraphicsView::EditorGraphicsView(QWidget* parent)
 :	QGraphicsView(parent),
-    m_timeScale(10.0f) // Default scale to 10 pixels per second
+    m_timeScale(DEFAULT_TIME_SCALE),
+    m_timeRange(),
+    m_contentTimeRanges(),
+    m_sceneScale(DEFAULT_TIME_SCALE, DEFAULT_VALUE_SCALE),
+    m_visibleTimeRange(),
+    m_extendSelection(false)
 {
     setRenderHint(QPainter::Antialiasing, true);
     setDragMode(QGraphicsView::RubberBandDrag);
 
+    // Curve points are not scene items, rubber band selection is passed on to point handles
+    connect(this, &QGraphicsView::rubberBandChanged, this, &EditorGraphicsView::selectPointsInRubberBand);
+
     // Create a scene and a root node (scene layer)
     setScene(new EditorGraphicsScene(this));
     m_sceneLayer = new TransformationNode(nullptr);
@@ -52,6 +76,7 @@ EditorGraphicsView::EditorGraphicsView(QWidget* parent)
 
     m_horizontalScrollKeeper = new ScrollPositionKeeper(horizontalScrollBar(), this);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, &EditorGraphicsView::updateVisibleTimeRange);
 
     // Set view transformation, flip y-axis
     QTransform transform;
@@ -75,6 +100,47 @@ float EditorGraphicsView::timeScale() const
     return m_timeScale;
 }
 
+float EditorGraphicsView::valueScale() const
+{
+    return m_sceneScale.height();
+}
+
+RangeF EditorGraphicsView::visibleTimeRange() const
+{
+    return m_visibleTimeRange;
+}
+
+bool EditorGraphicsView::isOpenGLViewport() const
+{
+    return qobject_cast<QOpenGLWidget*>(viewport()) != nullptr;
+}
+
+void EditorGraphicsView::setOpenGLViewport(bool enabled)
+{
+    if (enabled == isOpenGLViewport())
+        return;
+
+    qDebug() << "EditorGraphicsView::setOpenGLViewport" << enabled;
+
+    if (enabled)
+    {
+        // Multisampling replaces antialiasing of the raster engine
+        QOpenGLWidget* glViewport = new QOpenGLWidget;
+        QSurfaceFormat format = glViewport->format();
+        format.setSamples(4);
+        glViewport->setFormat(format);
+        setViewport(glViewport);
+
+        // Partial updates of a double buffered OpenGL surface would leave stale content
+        setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+    }
+    else
+    {
+        setViewport(new QWidget);
+        setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
+    }
+}
+
 void EditorGraphicsView::setTimeScale(float timeScale)
 {
     if (m_timeScale != timeScale)
@@ -88,10 +154,47 @@ void EditorGraphicsView::setTimeScale(float timeScale)
 
 void EditorGraphicsView::setTimeRange(RangeF timeRange)
 {
-    Q_UNUSED(timeRange);
+    m_timeRange = timeRange;
     updateSceneTransformation();
 }
 
+void EditorGraphicsView::setContentTimeRange(QObject* owner, RangeF timeRange)
+{
+    auto it = m_contentTimeRanges.find(owner);
+    if (it != m_contentTimeRanges.end() && it.value() == timeRange)
+        return;
+
+    m_contentTimeRanges.insert(owner, timeRange);
+    updateSceneRect();
+}
+
+void EditorGraphicsView::removeContentTimeRange(QObject* owner)
+{
+    if (m_contentTimeRanges.remove(owner))
+        updateSceneRect();
+}
+
+void EditorGraphicsView::selectPointsInRubberBand(QRect rubberBandRect, QPointF fromScenePoint, QPointF toScenePoint)
+{
+    if (rubberBandRect.isNull())
+        return;
+
+    const QRectF area = QRectF(fromScenePoint, toScenePoint).normalized();
+    for (PointHandleLayer* layer : PointHandleLayer::layers(scene()))
+        layer->selectInArea(area, m_extendSelection);
+}
+
+void EditorGraphicsView::mousePressEvent(QMouseEvent* event)
+{
+    m_extendSelection = event->modifiers().testFlag(Qt::ControlModifier);
+
+    QGraphicsView::mousePressEvent(event);
+
+    // Press outside point handles deselects points unless extending selection
+    if (event->button() == Qt::LeftButton && !m_extendSelection && scene() && !scene()->mouseGrabberItem())
+        PointHandleLayer::clearSelection(scene());
+}
+
 void EditorGraphicsView::resizeEvent(QResizeEvent* event)
 {
     qDebug() << "EditorGraphicsView::resizeEvent" << event->size();
@@ -134,42 +237,46 @@ void EditorGraphicsView::updateSceneTransformation()
 
     // Update scene transformation according to new size and timescale => affecs scene bounding rect
     m_sceneLayer->setTransform(QTransform::fromScale(m_timeScale, newSize.height()));
-    QRectF newSceneRect = calculateSceneItemsBoundingRect();
 
-    // Adjust scene rect to match the new view vertical size and to be positioned in (0, 0)
-    newSceneRect.setTopLeft(QPoint(0, 0));
-    newSceneRect.setHeight(newSize.height());
-    qDebug() << "  SceneRect:" << sceneRect() << "->" << newSceneRect;
-    setSceneRect(newSceneRect);
+    const QSizeF sceneScale(m_timeScale, newSize.height());
+    if (m_sceneScale != sceneScale)
+    {
+        m_sceneScale = sceneScale;
+        emit sceneScaleChanged(m_sceneScale.width(), m_sceneScale.height());
+    }
+
+    updateSceneRect();
+    updateVisibleTimeRange();
 }
 
-QRectF EditorGraphicsView::calculateSceneItemsBoundingRect() const
+void EditorGraphicsView::updateVisibleTimeRange()
 {
-    // Bounding rects for items that ignore transformations are not calculated correctly (!?),
-    // maybe related to https://bugreports.qt-project.org/browse/QTBUG-38344. Calculate scene
-    // items bounding rect by manually iterating instead of "m_scene->itemsBoundingRect();"
+    // Map viewport to scene layer coordinates where x-axis is time
+    const QRectF visibleRect = m_sceneLayer->mapFromScene(mapToScene(viewport()->rect())).boundingRect();
+    const RangeF visibleTimeRange(visibleRect.left(), visibleRect.right());
 
-    QRectF itemsBoundingRect;
-    for (QGraphicsItem* item : scene()->items())
+    if (m_visibleTimeRange != visibleTimeRange)
     {
-        if (!item->isVisible())
-            continue;
+        m_visibleTimeRange = visibleTimeRange;
+        emit visibleTimeRangeChanged(m_visibleTimeRange);
+    }
+}
 
-        QRectF boundingRect;
+void EditorGraphicsView::updateSceneRect()
+{
+    // Scene content is laid out in time from the scene origin, so only the content end matters.
+    // Computed from time ranges instead of item bounding rects to avoid visiting every item.
+    RangeF contentTimeRange = m_timeRange;
+    for (const RangeF& timeRange : m_contentTimeRanges)
+        contentTimeRange = RangeF::makeUnion(contentTimeRange, timeRange);
 
-        if (item->flags() & QGraphicsItem::ItemIgnoresTransformations)
-        {
-            QTransform viewTransform = item->deviceTransform(viewportTransform());
-            QRectF viewRect = viewTransform.mapRect(item->boundingRect());
-            boundingRect = mapToScene(viewRect.x(), viewRect.y(), viewRect.width(), viewRect.height()).boundingRect();
-        }
-        else
-        {
-            boundingRect = item->sceneBoundingRect();
-        }
+    const qreal width = contentTimeRange.isValid() ? qMax<qreal>(contentTimeRange.max * m_timeScale + CONTENT_MARGIN, 0) : 0;
 
-        itemsBoundingRect |= boundingRect;
-    }
+    // Positioned in (0, 0) and matching the view vertical size
+    const QRectF newSceneRect(0, 0, width, m_sceneScale.height());
+    if (newSceneRect == sceneRect())
+        return;
 
-    return itemsBoundingRect;
+    qDebug() << "  SceneRect:" << sceneRect() << "->" << newSceneRect;
+    setSceneRect(newSceneRect);
 }
@@ -3,6 +3,7 @@
 
 #include "RangeF.h"
 #include <QGraphicsView>
+#include <QHash>
 
 class ScrollPositionKeeper;
 
@@ -34,6 +35,15 @@ public:
     /** @return View time (x-axis) scale factor. */
     float timeScale() const;
 
+    /** @return View value (y-axis) scale factor, i.e. pixels for the normalized value range [0, 1]. A positive default before the view is resized. */
+    float valueScale() const;
+
+    /** @return Time range currently visible in the view. */
+    RangeF visibleTimeRange() const;
+
+    /** @return True if the view is drawn with OpenGL */
+    bool isOpenGLViewport() const;
+
 signals:
     /**
      * @brief View time scale changed
@@ -41,6 +51,19 @@ signals:
      */
     void timeScaleChanged(float timeScale);
 
+    /**
+     * @brief View time or value scale changed
+     * @param timeScale New time scale
+     * @param valueScale New value scale
+     */
+    void sceneScaleChanged(float timeScale, float valueScale);
+
+    /**
+     * @brief Time range visible in the view changed due to scrolling, zooming or resizing
+     * @param timeRange New visible time range
+     */
+    void visibleTimeRangeChanged(RangeF timeRange);
+
 public slots:
     /**
      * @brief Set view time scale
@@ -54,15 +77,52 @@ public slots:
      */
     void setTimeRange(RangeF timeRange);
 
+    /**
+     * @brief Select between OpenGL and raster drawing. Curves drawn with OpenGL
+     * keep their vertices in GPU buffers, so zooming and scrolling only redraws them.
+     * @param enabled True to draw with OpenGL
+     */
+    void setOpenGLViewport(bool enabled);
+
+    /**
+     * @brief Set time range covered by the graphics of a scene item, e.g. a curve.
+     * Scene width is kept to fit the time range of the view and all item time ranges.
+     * @param owner Object owning the graphics
+     * @param timeRange Time range covered, invalid if nothing is shown
+     */
+    void setContentTimeRange(QObject* owner, RangeF timeRange);
+
+    /**
+     * @brief Remove time range set with setContentTimeRange.
+     * @param owner Object owning the graphics
+     */
+    void removeContentTimeRange(QObject* owner);
+
+private slots:
+    /**
+     * @brief Select curve points within rubber band.
+     * @param rubberBandRect Rubber band in viewport coordinates, null when selection ends
+     * @param fromScenePoint Rubber band start in scene coordinates
+     * @param toScenePoint Rubber band end in scene coordinates
+     */
+    void selectPointsInRubberBand(QRect rubberBandRect, QPointF fromScenePoint, QPointF toScenePoint);
+
 private:
+    virtual void mousePressEvent(QMouseEvent* event) override;
     virtual void resizeEvent(QResizeEvent* event) override;
     virtual void wheelEvent(QWheelEvent* event) override;
     void updateSceneTransformation();
-    QRectF calculateSceneItemsBoundingRect() const;
+    void updateVisibleTimeRange();
+    void updateSceneRect();
 
 private:
     QGraphicsItem* m_sceneLayer;
     float m_timeScale;
+    RangeF m_timeRange; ///< Time range of the view
+    QHash<QObject*, RangeF> m_contentTimeRanges; ///< Time ranges covered by scene items
+    QSizeF m_sceneScale; ///< Scene layer scale (time, value) last notified with sceneScaleChanged
+    RangeF m_visibleTimeRange; ///< Visible time range last notified with visibleTimeRangeChanged
+    bool m_extendSelection; ///< True if current mouse press extends point selection
     ScrollPositionKeeper* m_horizontalScrollKeeper;
 };
 
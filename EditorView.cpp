@@ -15,6 +15,7 @@
 #include "ScaleView.h"
 #include "BeatLinesView.h"
 #include "EditorGraphicsView.h"
+#include "RedrawScheduler.h"
 
 #include <QGraphicsScene>
 #include <QContextMenuEvent>
@@ -36,6 +37,9 @@ EditorView::EditorView(std::shared_ptr<EditorModel> model, QWidget* parent)
     setLayout(gridLayout);
 
     m_view = new EditorGraphicsView(this);
+    m_view->setTimeRange(m_model->timeRange());
+
+    m_redrawScheduler = new RedrawScheduler(this);
 
     m_snapToGrid = new QCheckBox("Snap", this);
 
@@ -102,6 +106,24 @@ void EditorView::internalCurveAdded(std::shared_ptr<U> curve)
     curveView->setSnapToGrid(m_snapToGrid->checkState() == Qt::Checked);
     curveView->setSnapGrid(m_beatView->snapGrid());
 
+    // Level of detail follows view scale
+    connect(m_view, &EditorGraphicsView::sceneScaleChanged, curveView, &CurveViewAbs::setViewScale);
+    curveView->setViewScale(m_view->timeScale(), m_view->valueScale());
+
+    // Graphics are created only around the visible time range
+    connect(m_view, &EditorGraphicsView::visibleTimeRangeChanged, curveView, &CurveViewAbs::setVisibleTimeRange);
+    curveView->setVisibleTimeRange(m_view->visibleTimeRange());
+
+    // Bulk point changes redraw the curve once
+    curveView->setRedrawScheduler(m_redrawScheduler);
+
+    // Scene size follows curve extents
+    connect(curveView, &CurveViewAbs::timeExtentChanged, m_view, [this, curveView](RangeF timeExtent)
+    {
+        m_view->setContentTimeRange(curveView, timeExtent);
+    });
+    m_view->setContentTimeRange(curveView, curveView->timeExtent());
+
     m_curveViews.insert(curve, curveView);
 }
 
@@ -115,6 +137,7 @@ void EditorView::internalCurveRemoved(std::shared_ptr<CurveModelAbs> curve)
     Iterator removed = m_curveViews.find(curve);
     assert(removed != m_curveViews.end());
 
+    m_view->removeContentTimeRange(removed.value());
     delete removed.value();
     m_curveViews.erase(removed);
 }
@@ -124,19 +147,36 @@ void EditorView::timeRangeChanged(RangeF timeRange)
     m_view->setTimeRange(timeRange);
 }
 
+void EditorView::setOpenGLViewport(bool enabled)
+{
+    m_view->setOpenGLViewport(enabled);
+}
+
 void EditorView::duplicateSelectedPoints()
 {
-    for (auto curveView : m_curveViews)
-        curveView->duplicateSelectedPoints();
+    CurveViewAbs::duplicateSelectedPoints(m_curveViews.values());
 }
 
 void EditorView::removeSelectedPoints()
 {
-    // Need to iterate a copy as the original container might change as a result of removing points
-    Container copyOfCurveView = m_curveViews;
+    // Views of curves left empty are removed with the curves, hold the models only
+    const QList<std::shared_ptr<CurveModelAbs>> curves = m_curveViews.keys();
+
+    for (auto curve : curves)
+    {
+        const QList<PointId> selected = curve->selectedPointIds();
+        if (!selected.isEmpty())
+            curve->removePoints(selected);
+    }
+}
+
+bool EditorView::hasSelectedPoints() const
+{
+    for (ConstIterator it = m_curveViews.constBegin(); it != m_curveViews.constEnd(); ++it)
+        if (it.key()->numberOfSelectedPoints() > 0)
+            return true;
 
-    for (auto curveView : copyOfCurveView)
-        curveView->removeSelectedPoints();
+    return false;
 }
 
 void EditorView::addNewCurve()
@@ -193,9 +233,8 @@ void EditorView::contextMenuEvent(QContextMenuEvent* event)
     if (!m_view->scene())
         return;
     
-    auto selectedItems = m_view->scene()->selectedItems();
-    
-	if (selectedItems.size() > 0)
+    // Points are drawn by handle layers, selection is kept by the curves
+    if (hasSelectedPoints())
     {
         QMenu pointsMenu;
         pointsMenu.setTitle("Points");
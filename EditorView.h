@@ -31,6 +31,7 @@ class EditorModel;
 class ScrollPositionKeeper;
 class EditorGraphicsView;
 class ScaleView;
+class RedrawScheduler;
 
 /**
  * @brief EditorView displays the contents of an EditorModel (@see EditorModel) and
@@ -64,14 +65,21 @@ signals:
 public slots:
     /**
      * @brief Create new point for each selected point in respective curves.
+     * @see CurveViewAbs::duplicateSelectedPoints
      */
     void duplicateSelectedPoints();
 
     /**
-     * @brief Remove selected points from respective curves.
+     * @brief Remove selected points from respective curves, each curve in one batch.
      */
     void removeSelectedPoints();
 
+    /**
+     * @brief Select between OpenGL and raster drawing.
+     * @param enabled True to draw with OpenGL
+     */
+    void setOpenGLViewport(bool enabled);
+
 private slots: /** Signals from EditorModel */
     /**
      * @brief New curve was added
@@ -100,6 +108,9 @@ private:
     virtual void contextMenuEvent(QContextMenuEvent *event) override;
     virtual void keyPressEvent(QKeyEvent* event) override;
     virtual void keyReleaseEvent(QKeyEvent* event) override;
+
+    /** @return True if any curve of the editor has selected points */
+    bool hasSelectedPoints() const;
     
     std::shared_ptr<EditorModel> m_model; /**< Model */
 
@@ -107,6 +118,7 @@ private:
     BeatLinesView* m_beatView; /**< View for vertical beat lines */
     ScaleView* m_scaleView; /**< View for horizontal scale lines */
     QCheckBox* m_snapToGrid; /**< "Snap" checkbox */
+    RedrawScheduler* m_redrawScheduler; /**< Coalesces curve redraws after point changes */
 
     /** Curve container provides mapping between curve models and views. */
     using Container = QMap<std::shared_ptr<CurveModelAbs>, CurveViewAbs*>;
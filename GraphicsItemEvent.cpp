@@ -1,9 +0,0 @@
-//
-//  GraphicsItemEvent.cpp
-//  CurveEditor
-//
-//  Created by Lasse Lopperi on 29.12.13.
-//
-//
-
-#include "GraphicsItemEvent.h"
@@ -3,6 +3,9 @@
 #include "EditorModel.h"
 #include "CurveModel.h"
 #include "SceneModel.h"
+#include "SceneLoader.h"
+#include "SceneAutosaver.h"
+#include "SceneBaker.h"
 #include "ScenePropertiesWidget.h"
 #include "PointPropertiesWidget.h"
 
@@ -13,17 +16,39 @@
 
 #include <QAction>
 #include <QDockWidget>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QSignalBlocker>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+namespace {
+/** Interval between background autosaves of a modified scene */
+const int AUTOSAVE_INTERVAL_MS = 60 * 1000;
+/** Sample rate offered for the first baked export */
+const double DEFAULT_BAKE_SAMPLE_RATE = 60.0;
+} // anonymous namespace
+
 MainWindow::MainWindow(QWidget *parent)
   : QMainWindow(parent),
-    m_centralWidget(new QWidget)
+    m_centralWidget(new QWidget),
+    m_sceneLoader(new SceneLoader(this)),
+    m_loadProgress(nullptr),
+    m_autosaver(new SceneAutosaver(AUTOSAVE_INTERVAL_MS, this)),
+    m_bakeSampleRate(DEFAULT_BAKE_SAMPLE_RATE)
 {
     // Initialize central widget
     setCentralWidget(m_centralWidget);
 
+    // Scene loading happens in the background
+    connect(m_sceneLoader, &SceneLoader::progressChanged, this, &MainWindow::sceneLoadProgress);
+    connect(m_sceneLoader, &SceneLoader::loaded, this, &MainWindow::sceneLoaded);
+    connect(m_sceneLoader, &SceneLoader::failed, this, &MainWindow::sceneLoadFailed);
+    connect(m_sceneLoader, &SceneLoader::cancelled, this, &MainWindow::sceneLoadCancelled);
+
     // Initialize scene action
     m_newSceneAction = new QAction(tr("New scene"), this);
     m_newSceneAction->setShortcut(QKeySequence::New);
@@ -50,11 +75,26 @@ MainWindow::MainWindow(QWidget *parent)
     m_closeSceneAction->setStatusTip(tr("Close current scene with a new name"));
     connect(m_closeSceneAction, SIGNAL(triggered()), this, SLOT(closeScene()));
 
+    m_packedKeysAction = new QAction(tr("Pack curve keys"), this);
+    m_packedKeysAction->setCheckable(true);
+    m_packedKeysAction->setStatusTip(tr("Save curve keys in compact encoded form"));
+    connect(m_packedKeysAction, SIGNAL(toggled(bool)), this, SLOT(setPackedKeys(bool)));
+
     m_exportCurvesAction = new QAction(tr("Export curves"), this);
     m_exportCurvesAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_E)); // CTRL+E
     m_exportCurvesAction->setStatusTip(tr("Save scene curves to a new file"));
     connect(m_exportCurvesAction, SIGNAL(triggered()), this, SLOT(exportSceneCurves()));
 
+    m_exportBakedCurvesAction = new QAction(tr("Export baked curves"), this);
+    m_exportBakedCurvesAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_E)); // CTRL+SHIFT+E
+    m_exportBakedCurvesAction->setStatusTip(tr("Save scene curves sampled at a fixed rate to a new file"));
+    connect(m_exportBakedCurvesAction, SIGNAL(triggered()), this, SLOT(exportBakedCurves()));
+
+    m_openGLViewportAction = new QAction(tr("OpenGL rendering"), this);
+    m_openGLViewportAction->setCheckable(true);
+    m_openGLViewportAction->setStatusTip(tr("Draw editors with OpenGL, faster for scenes with many curves"));
+    connect(m_openGLViewportAction, SIGNAL(toggled(bool)), this, SLOT(setOpenGLViewport(bool)));
+
     updateSceneActionStates();
 
     // Create dock widgets
@@ -78,15 +118,20 @@ MainWindow::MainWindow(QWidget *parent)
     fileMenu->addAction(m_saveSceneAction);
     fileMenu->addAction(m_saveSceneAsAction);
     fileMenu->addAction(m_closeSceneAction);
+    fileMenu->addSeparator();
+    fileMenu->addAction(m_packedKeysAction);
 
     // Create curves menu
     QMenu* curvesMenu = menuBar()->addMenu("&Curves");
     curvesMenu->addAction(m_exportCurvesAction);
+    curvesMenu->addAction(m_exportBakedCurvesAction);
 
     // Create view menu
     QMenu* viewMenu = menuBar()->addMenu("&View");
     viewMenu->addAction(pointDockWidget->toggleViewAction());
     viewMenu->addAction(sceneDockWidget->toggleViewAction());
+    viewMenu->addSeparator();
+    viewMenu->addAction(m_openGLViewportAction);
 
     this->resize(1200, 500);
 }
@@ -120,25 +165,15 @@ void MainWindow::newScene()
     c2->addPoint(qrand() % 100, static_cast<float>((qrand() % 100) - 50));
     c2->addPoint(qrand() % 100, static_cast<float>((qrand() % 100) - 50));
 
-    m_sceneModel = std::make_shared<SceneModel>(RangeF(0, 100));
-//    m_sceneModel->addCurve(c1);
-//    m_sceneModel->addCurve(c2);
-//    m_sceneModel->selectCurve(c2);
-    m_sceneModel->setBpm(60);
-    m_pointProperties->setSceneModel(m_sceneModel);
-    m_sceneProperties->setSceneModel(m_sceneModel);
-
-    EditorView* allCurvesEditorView = new EditorView(m_sceneModel->getAllCurvesEditor());
-    m_editors.push_back(allCurvesEditorView);
-    EditorView* selectedCurvesEditorView = new EditorView(m_sceneModel->getSelectedCurvesEditor());
-    m_editors.push_back(selectedCurvesEditorView);
+    std::shared_ptr<SceneModel> scene = std::make_shared<SceneModel>(RangeF(0, 100));
+//    scene->addCurve(c1);
+//    scene->addCurve(c2);
+//    scene->selectCurve(c2);
+    scene->setBpm(60);
+    // New scene has no file yet, save keys as currently chosen
+    scene->setPackedKeys(m_packedKeysAction->isChecked());
 
-    m_editorContainer = new QVBoxLayout;
-    m_editorContainer->addWidget(allCurvesEditorView);
-    m_editorContainer->addWidget(selectedCurvesEditorView);
-    m_centralWidget->setLayout(m_editorContainer);
-
-    updateSceneActionStates();
+    showScene(scene);
 }
 
 void MainWindow::openScene()
@@ -151,6 +186,12 @@ void MainWindow::openScene()
         return;
     }
 
+    if (m_sceneLoader->isLoading())
+    {
+        qWarning() << "Cannot open scene while another is being loaded";
+        return;
+    }
+
     QString fileName = promptForSceneOpenFile();
 
     // Should have a name now
@@ -160,23 +201,77 @@ void MainWindow::openScene()
         return;
     }
 
-    // Open file for reading
-    QFile sceneFile(fileName);
-    if (!sceneFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!m_sceneLoader->load(fileName))
+        return;
+
+    // Show progress while the scene loads in the background
+    m_loadProgress = new QProgressDialog(tr("Loading %1").arg(fileName), tr("Cancel"), 0, 0, this);
+    m_loadProgress->setWindowModality(Qt::WindowModal);
+    m_loadProgress->setMinimumDuration(500);
+    connect(m_loadProgress, &QProgressDialog::canceled, m_sceneLoader, &SceneLoader::cancel);
+
+    updateSceneActionStates();
+}
+
+void MainWindow::sceneLoadProgress(qint64 bytesRead, qint64 bytesTotal, int curvesRead)
+{
+    if (!m_loadProgress)
+        return;
+
+    // Progress dialog works with ints, use per mille
+    m_loadProgress->setMaximum(1000);
+    m_loadProgress->setValue(bytesTotal > 0 ? static_cast<int>((bytesRead * 1000) / bytesTotal) : 0);
+    m_loadProgress->setLabelText(tr("Loading %1 (%2 curves)").arg(m_sceneLoader->fileName()).arg(curvesRead));
+}
+
+void MainWindow::sceneLoaded(std::shared_ptr<SceneModel> scene)
+{
+    qDebug() << "Scene loaded" << scene->fileName();
+
+    hideLoadProgress();
+
+    if (m_sceneModel)
     {
-        qWarning() << "Failed to open file:" << sceneFile.errorString();
+        qWarning() << "Scene loaded while another is open, discarding" << scene->fileName();
         return;
     }
 
-    QXmlStreamReader stream(&sceneFile);
-    m_sceneModel = SceneModel::create(stream);
+    showScene(scene);
+}
 
-    if (!m_sceneModel)
+void MainWindow::sceneLoadFailed(QString fileName, QString reason)
+{
+    qWarning() << "Failed to open scene from file:" << fileName << reason;
+
+    hideLoadProgress();
+    updateSceneActionStates();
+}
+
+void MainWindow::sceneLoadCancelled()
+{
+    qDebug() << "Scene load cancelled";
+
+    hideLoadProgress();
+    updateSceneActionStates();
+}
+
+void MainWindow::hideLoadProgress()
+{
+    if (m_loadProgress)
     {
-        qWarning() << "Failed to open scene from file:" << fileName;
-        return;
+        m_loadProgress->deleteLater();
+        m_loadProgress = nullptr;
+    }
+}
+
+void MainWindow::showScene(std::shared_ptr<SceneModel> scene)
+{
+    m_sceneModel = scene;
+    {
+        // Reflect how the scene saves its keys, doesn't change the scene
+        const QSignalBlocker blocker(m_packedKeysAction);
+        m_packedKeysAction->setChecked(m_sceneModel->packedKeys());
     }
-    m_sceneModel->setFileName(fileName);
     m_pointProperties->setSceneModel(m_sceneModel);
     m_sceneProperties->setSceneModel(m_sceneModel);
 
@@ -185,11 +280,16 @@ void MainWindow::openScene()
     EditorView* selectedCurvesEditorView = new EditorView(m_sceneModel->getSelectedCurvesEditor());
     m_editors.push_back(selectedCurvesEditorView);
 
+    for (auto editor : m_editors)
+        editor->setOpenGLViewport(m_openGLViewportAction->isChecked());
+
     m_editorContainer = new QVBoxLayout;
     m_editorContainer->addWidget(allCurvesEditorView);
     m_editorContainer->addWidget(selectedCurvesEditorView);
     m_centralWidget->setLayout(m_editorContainer);
 
+    m_autosaver->setScene(m_sceneModel);
+
     updateSceneActionStates();
 }
 
@@ -216,22 +316,32 @@ void MainWindow::saveScene()
         return;
     }
 
-    // Open the file
-    QFile sceneFile(m_sceneModel->fileName());
-    if (!sceneFile.open(QIODevice::WriteOnly  | QIODevice::Text | QIODevice::Truncate))
+    // Autosave may be copying curves from the file about to be replaced
+    m_autosaver->waitForSaving();
+
+    // Open the file, existing file is replaced only when writing succeeds.
+    // Written as is, copied curve blocks already have the line endings of the saved file.
+    QSaveFile sceneFile(m_sceneModel->fileName());
+    if (!sceneFile.open(QIODevice::WriteOnly))
     {
         qWarning() << "Failed to open file for saving:" << sceneFile.errorString();
         return;
     }
 
-    // Serialize the scene
-    QXmlStreamWriter stream(&sceneFile);
-    stream.setAutoFormatting(true);
-    stream.writeStartDocument("1.0");
+    // Serialize modified curves, unmodified curves are copied from the previous save
+    SceneModel::Chunks chunks = m_sceneModel->serializeChunks();
 
-    m_sceneModel->serialize(stream);
+    QVector<SceneModel::CurveBlock> curveBlocks;
+    if (!SceneModel::writeChunks(chunks, sceneFile, &curveBlocks) || !sceneFile.commit())
+    {
+        qWarning() << "Failed to save scene:" << sceneFile.errorString();
+        return;
+    }
 
-    stream.writeEndDocument();
+    m_sceneModel->setSaved(chunks.revision, curveBlocks);
+
+    // Saved scene supersedes the autosave
+    m_autosaver->discardAutosave();
 }
 
 void MainWindow::saveSceneAs()
@@ -297,7 +407,9 @@ void MainWindow::closeScene()
     delete m_editorContainer;
     m_editorContainer = nullptr;
 
-    // Delete scene
+    // Delete scene and its autosave
+    m_autosaver->discardAutosave();
+    m_autosaver->setScene(nullptr);
     m_sceneModel.reset();
     m_pointProperties->setSceneModel(m_sceneModel);
     m_sceneProperties->setSceneModel(m_sceneModel);
@@ -333,14 +445,83 @@ void MainWindow::exportSceneCurves()
         return;
     }
 
-    // Serialize the scene curves
-    QXmlStreamWriter stream(&curvesFile);
+    // Serialize the scene curves in memory, the output is sized up front from the number of keys
+    QByteArray document;
+    QXmlStreamWriter stream(&document);
     stream.setAutoFormatting(true);
     stream.writeStartDocument("1.0");
 
     m_sceneModel->serializeCurves(stream);
 
     stream.writeEndDocument();
+
+    if (curvesFile.write(document) != document.size())
+        qWarning() << "Failed to write exported curves:" << curvesFile.errorString();
+}
+
+void MainWindow::exportBakedCurves()
+{
+    qDebug() << "Export baked curves";
+
+    if (!m_sceneModel)
+    {
+        qWarning() << "No scene, unable to export baked curves";
+        return;
+    }
+
+    // Prompt for sample rate
+    bool ok = false;
+    const double sampleRate = QInputDialog::getDouble(this, tr("Bake curves"), tr("Sample rate (Hz)"), m_bakeSampleRate, 1.0, 10000.0, 2, &ok);
+    if (!ok)
+        return;
+    m_bakeSampleRate = sampleRate;
+
+    // Prompt for new baked curves file name
+    static QString s_promptTitle("Select baked curves file name");
+    static QString s_filters("Baked curves (*.bin);;All Files (*.*)");
+    QString newFileName = QFileDialog::getSaveFileName(this, s_promptTitle, QString(), s_filters);
+
+    if (newFileName.isEmpty())
+    {
+        qWarning() << "No new file name for baked curves, unable to export";
+        return;
+    }
+
+    QSaveFile bakedFile(newFileName);
+    if (!bakedFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open file for export:" << bakedFile.errorString();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const SceneBaker::Baked baked = SceneBaker::bake(*m_sceneModel, sampleRate);
+
+    qDebug() << "Baked" << baked.curves.size() << "curves of" << baked.sampleCount << "samples in" << timer.elapsed() << "ms";
+
+    if (!SceneBaker::write(baked, bakedFile) || !bakedFile.commit())
+    {
+        qWarning() << "Failed to export baked curves:" << bakedFile.errorString();
+        return;
+    }
+}
+
+void MainWindow::setPackedKeys(bool packed)
+{
+    qDebug() << "Pack curve keys" << packed;
+
+    if (m_sceneModel)
+        m_sceneModel->setPackedKeys(packed);
+}
+
+void MainWindow::setOpenGLViewport(bool enabled)
+{
+    qDebug() << "OpenGL rendering" << enabled;
+
+    for (auto editor : m_editors)
+        editor->setOpenGLViewport(enabled);
 }
 
 void MainWindow::updateSceneActionStates()
@@ -357,18 +538,21 @@ void MainWindow::updateSceneActionStates()
 
         // Got scene, allow exporting curves
         m_exportCurvesAction->setEnabled(true);
+        m_exportBakedCurvesAction->setEnabled(true);
     }
     else
     {
-        // We don't have an existing scene, allow new and open
-        m_newSceneAction->setEnabled(true);
-        m_openSceneAction->setEnabled(true);
+        // We don't have an existing scene, allow new and open unless a scene is being loaded
+        const bool loading = m_sceneLoader->isLoading();
+        m_newSceneAction->setEnabled(!loading);
+        m_openSceneAction->setEnabled(!loading);
         m_saveSceneAction->setEnabled(false);
         m_saveSceneAsAction->setEnabled(false);
         m_closeSceneAction->setEnabled(false);
 
         // No scene, cannot export curves
         m_exportCurvesAction->setEnabled(false);
+        m_exportBakedCurvesAction->setEnabled(false);
     }
 }
 
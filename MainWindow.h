@@ -5,6 +5,8 @@
 #include <memory>
 
 class SceneModel;
+class SceneLoader;
+class SceneAutosaver;
 class EditorView;
 class PointPropertiesWidget;
 class ScenePropertiesWidget;
@@ -12,6 +14,7 @@ class ScenePropertiesWidget;
 QT_BEGIN_NAMESPACE
 class QAction;
 class QLayout;
+class QProgressDialog;
 class QWidget;
 QT_END_NAMESPACE
 
@@ -31,8 +34,28 @@ public slots:
     void closeScene();
 
     void exportSceneCurves();
+    void exportBakedCurves();
+
+    void setPackedKeys(bool packed);
+    void setOpenGLViewport(bool enabled);
+
+private slots:
+    /** Scene loading notifications from SceneLoader */
+    void sceneLoadProgress(qint64 bytesRead, qint64 bytesTotal, int curvesRead);
+    void sceneLoaded(std::shared_ptr<SceneModel> scene);
+    void sceneLoadFailed(QString fileName, QString reason);
+    void sceneLoadCancelled();
 
 private:
+    /**
+     * @brief Take a scene into use and create editors for it.
+     * @param scene The scene
+     */
+    void showScene(std::shared_ptr<SceneModel> scene);
+
+    /** Hide scene loading progress */
+    void hideLoadProgress();
+
     /**
      * @brief Prompt for existing scene file name.
      * @return File name
@@ -57,13 +80,25 @@ private:
 
     std::shared_ptr<SceneModel> m_sceneModel;
 
+    SceneLoader* m_sceneLoader;
+    QProgressDialog* m_loadProgress;
+
+    SceneAutosaver* m_autosaver;
+
+    /** Sample rate of the previous baked export, offered for the next one */
+    double m_bakeSampleRate;
+
     QAction* m_newSceneAction;
     QAction* m_openSceneAction;
     QAction* m_saveSceneAction;
     QAction* m_saveSceneAsAction;
     QAction* m_closeSceneAction;
+    QAction* m_packedKeysAction;
 
     QAction* m_exportCurvesAction;
+    QAction* m_exportBakedCurvesAction;
+
+    QAction* m_openGLViewportAction;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,181 @@
+#include "MinMaxPyramid.h"
+
+#include <cmath>
+#include <utility>
+
+MinMaxPyramid::MinMaxPyramid(EnvelopeFunction envelope)
+  : m_envelope(std::move(envelope)),
+    m_timeRange(),
+    m_bucketLength(0.0f),
+    m_bucketCount(0),
+    m_levels()
+{
+}
+
+bool MinMaxPyramid::isBuilt() const
+{
+    return !m_levels.isEmpty();
+}
+
+RangeF MinMaxPyramid::timeRange() const
+{
+    return m_timeRange;
+}
+
+int MinMaxPyramid::levelCount() const
+{
+    return m_levels.size();
+}
+
+float MinMaxPyramid::bucketLength(int level) const
+{
+    return std::ldexp(m_bucketLength, level);
+}
+
+void MinMaxPyramid::build(RangeF timeRange, float bucketLength)
+{
+    clear();
+
+    if (!timeRange.isValid() || !(bucketLength > 0.0f))
+        return;
+
+    m_timeRange = timeRange;
+    m_bucketLength = bucketLength;
+    m_bucketCount = qMax(static_cast<int>(std::ceil((timeRange.max - timeRange.min) / bucketLength)), 1);
+
+    // Levels halve down to a single bucket covering everything
+    int levelCount = 1;
+    for (int bucketCount = m_bucketCount; bucketCount > 1; bucketCount = (bucketCount + 1) / 2)
+        ++levelCount;
+    m_levels.resize(levelCount);
+}
+
+void MinMaxPyramid::clear()
+{
+    m_levels.clear();
+    m_timeRange = RangeF();
+    m_bucketLength = 0.0f;
+    m_bucketCount = 0;
+}
+
+void MinMaxPyramid::invalidate(RangeF timeRange)
+{
+    if (!isBuilt() || !timeRange.isValid())
+        return;
+
+    if (!m_timeRange.isInRange(timeRange.min) || !m_timeRange.isInRange(timeRange.max))
+    {
+        // Coverage no longer matches the curve, build again when needed
+        clear();
+        return;
+    }
+
+    // Buckets are closed ranges, a change on a boundary affects the previous bucket too
+    const int first = qMax(bucketIndex(timeRange.min) - 1, 0);
+    const int last = bucketIndex(timeRange.max);
+    for (int level = 0; level < m_levels.size(); ++level)
+    {
+        QMap<int, RangeF>& buckets = m_levels[level];
+        auto it = buckets.lowerBound(first >> level);
+        while (it != buckets.end() && it.key() <= (last >> level))
+            it = buckets.erase(it);
+    }
+}
+
+int MinMaxPyramid::levelFor(float timeStep) const
+{
+    if (!isBuilt() || timeStep < m_bucketLength)
+        return -1;
+
+    const int level = static_cast<int>(std::floor(std::log2(timeStep / m_bucketLength)));
+    return qMin(level, m_levels.size() - 1);
+}
+
+RangeF MinMaxPyramid::envelope(int level, float start, float end) const
+{
+    RangeF range;
+    if (level < 0 || level >= m_levels.size())
+        return range;
+
+    const int first = bucketIndex(start) >> level;
+    const int last = bucketIndex(end) >> level;
+
+    for (int i = first; i <= last; ++i)
+        range = RangeF::makeUnion(range, bucket(level, i));
+
+    return range;
+}
+
+QPolygonF MinMaxPyramid::lines(RangeF timeRange, float columnWidth) const
+{
+    QPolygonF lines;
+    if (!isBuilt() || !timeRange.isValid() || !(columnWidth > 0.0f))
+        return lines;
+
+    const float start = qMax(timeRange.min, m_timeRange.min);
+    const float end = qMin(timeRange.max, m_timeRange.max);
+    if (start > end)
+        return lines;
+
+    const int level = qMax(levelFor(columnWidth), 0);
+
+    // Align columns to multiples of the column width so they stay put while scrolling
+    const qint64 firstColumn = static_cast<qint64>(std::floor(start / columnWidth));
+    const qint64 lastColumn = static_cast<qint64>(std::floor(end / columnWidth));
+    lines.reserve(static_cast<int>(2 * (lastColumn - firstColumn + 1)));
+
+    for (qint64 column = firstColumn; column <= lastColumn; ++column)
+    {
+        const float columnStart = column * columnWidth;
+        const RangeF range = envelope(level, columnStart, columnStart + columnWidth);
+        if (!range.isValid())
+            continue;
+
+        // Continue from the end closer to where the previous column ended
+        const bool downwards = !lines.isEmpty() && lines.last().y() > (range.min + range.max) / 2.0f;
+        lines.append(QPointF(columnStart, downwards ? range.max : range.min));
+        lines.append(QPointF(columnStart, downwards ? range.min : range.max));
+    }
+
+    return lines;
+}
+
+int MinMaxPyramid::bucketIndex(float time) const
+{
+    const int index = static_cast<int>(std::floor((time - m_timeRange.min) / m_bucketLength));
+    return qBound(0, index, m_bucketCount - 1);
+}
+
+RangeF MinMaxPyramid::bucket(int level, int index) const
+{
+    QMap<int, RangeF>& buckets = m_levels[level];
+    auto cached = buckets.constFind(index);
+    if (cached != buckets.constEnd())
+        return cached.value();
+
+    // Merge children if both are up to date, otherwise ask the curve
+    RangeF range;
+    bool merged = false;
+    if (level > 0)
+    {
+        const QMap<int, RangeF>& children = m_levels[level - 1];
+        const bool hasRight = 2 * index + 1 <= (m_bucketCount - 1) >> (level - 1);
+        auto left = children.constFind(2 * index);
+        auto right = hasRight ? children.constFind(2 * index + 1) : children.constEnd();
+        if (left != children.constEnd() && (!hasRight || right != children.constEnd()))
+        {
+            range = hasRight ? RangeF::makeUnion(left.value(), right.value()) : left.value();
+            merged = true;
+        }
+    }
+
+    if (!merged)
+    {
+        const float length = bucketLength(level);
+        const float start = m_timeRange.min + index * length;
+        range = m_envelope(start, start + length);
+    }
+
+    buckets.insert(index, range);
+    return range;
+}
@@ -0,0 +1,101 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include "RangeF.h"
+#include <QMap>
+#include <QPolygonF>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief Min/max value envelope of a curve at successively halved time resolutions.
+ *
+ * Like waveform overviews in audio editors. Level 0 splits the covered time
+ * range into buckets of equal length and stores the value range of the curve
+ * within each bucket. Each following level merges pairs of buckets from the
+ * level below. A zoomed out curve can then be drawn as one vertical line per
+ * pixel column, with cost bounded by the number of columns instead of keys.
+ *
+ * Curve values are queried through an envelope function. Buckets are computed
+ * lazily when first read, so only the levels and time ranges actually drawn cost
+ * anything. After the curve changes, invalidate() marks the buckets over the
+ * changed time range to be computed again.
+ */
+class MinMaxPyramid
+{
+public:
+    /** Function giving the value range of a curve within time range [start, end], invalid if no values. */
+    using EnvelopeFunction = std::function<RangeF(float start, float end)>;
+
+    /**
+     * @brief Construct MinMaxPyramid. The pyramid is empty until built.
+     * @param envelope Curve envelope function
+     */
+    explicit MinMaxPyramid(EnvelopeFunction envelope);
+
+    /** @return True if the pyramid has been built */
+    bool isBuilt() const;
+
+    /** @return Covered time range, invalid if not built */
+    RangeF timeRange() const;
+
+    /** @return Number of levels */
+    int levelCount() const;
+
+    /** @return Bucket length in time units on the given level */
+    float bucketLength(int level) const;
+
+    /**
+     * @brief Set up levels for a time range. Buckets are computed when first read.
+     * @param timeRange Time range to cover
+     * @param bucketLength Length of a level 0 bucket
+     */
+    void build(RangeF timeRange, float bucketLength);
+
+    /** @brief Drop all levels. */
+    void clear();
+
+    /**
+     * @brief Mark buckets to be computed again after the curve changed. Does nothing if the
+     * pyramid has not been built. Changes outside the covered time range clear the pyramid.
+     * @param timeRange Changed time range
+     */
+    void invalidate(RangeF timeRange);
+
+    /**
+     * @return Coarsest level with buckets no longer than the given time step,
+     * or -1 if level 0 buckets are already longer.
+     */
+    int levelFor(float timeStep) const;
+
+    /**
+     * @brief Get value range within a time range from buckets of a level.
+     * @param level Pyramid level
+     * @param start Range start
+     * @param end Range end
+     * @return Union of buckets overlapping the range
+     */
+    RangeF envelope(int level, float start, float end) const;
+
+    /**
+     * @brief Line strip tracing the envelope with a vertical line per column.
+     * @param timeRange Time range to trace, clipped to the covered time range
+     * @param columnWidth Column width in time units, typically a pixel
+     * @return Line strip vertices, empty if the pyramid has not been built
+     */
+    QPolygonF lines(RangeF timeRange, float columnWidth) const;
+
+private:
+    /** @return Level 0 bucket index for a time, clamped to existing buckets */
+    int bucketIndex(float time) const;
+    /** @return Value range of a bucket, computed if not up to date */
+    RangeF bucket(int level, int index) const;
+
+    EnvelopeFunction m_envelope;
+    RangeF m_timeRange;
+    float m_bucketLength;
+    int m_bucketCount; ///< Number of level 0 buckets
+    mutable QVector<QMap<int, RangeF>> m_levels; ///< Up to date buckets by index on each level
+};
+
+#endif // MINMAXPYRAMID_H
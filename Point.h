@@ -31,6 +31,8 @@ public:
 private:
     /** For now allow only CurveModel to create/modify */
     friend class CurveModelAbs;
+    /** Snapshots return invalid points for unknown ids like the model */
+    friend class CurveSnapshot;
 
     /** @brief Construct invalid point */
     Point();
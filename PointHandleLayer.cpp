@@ -0,0 +1,359 @@
+#include "PointHandleLayer.h"
+#include "CurveModelAbs.h"
+
+#include <QGraphicsScene>
+#include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QPen>
+#include <QSet>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+#include <cmath>
+
+namespace {
+
+/** Area for coordinate label of a selected point, next to the point in pixels */
+const QSizeF LABEL_SIZE(100, 14);
+
+/** All existing handle layers, to find the layers of a scene without going through all scene items */
+QList<PointHandleLayer*>& allLayers()
+{
+    static QList<PointHandleLayer*> layers;
+    return layers;
+}
+
+} // anonymous namespace
+
+PointHandleLayer::PointHandleLayer(std::shared_ptr<CurveModelAbs> model, QGraphicsItem* parent)
+  : QGraphicsItem(parent),
+    m_model(model),
+    m_timeBounds(),
+    m_valueBounds(),
+    m_gridRect(),
+    m_pressScenePos(),
+    m_dragStartPositions()
+{
+    setAcceptedMouseButtons(Qt::LeftButton);
+
+    // Exposed rect is used to paint only the handles that need it
+    setFlags(flags() | QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    allLayers().append(this);
+
+    for (const Point& point : m_model->points())
+    {
+        const float value = point.value().toFloat();
+        m_timeBounds = RangeF::makeUnion(m_timeBounds, RangeF(point.time(), point.time()));
+        m_valueBounds = RangeF::makeUnion(m_valueBounds, RangeF(value, value));
+    }
+}
+
+PointHandleLayer::~PointHandleLayer()
+{
+    allLayers().removeOne(this);
+}
+
+QList<PointHandleLayer*> PointHandleLayer::layers(QGraphicsScene* scene)
+{
+    QList<PointHandleLayer*> layers;
+    if (!scene)
+        return layers;
+
+    for (PointHandleLayer* layer : allLayers())
+    {
+        if (layer->scene() == scene)
+            layers.append(layer);
+    }
+
+    return layers;
+}
+
+void PointHandleLayer::clearSelection(QGraphicsScene* scene)
+{
+    for (PointHandleLayer* layer : layers(scene))
+        layer->deselectAll();
+}
+
+void PointHandleLayer::setSnapGrid(QRectF gridRect)
+{
+    m_gridRect = gridRect;
+}
+
+void PointHandleLayer::pointChanged(const Point& point)
+{
+    const float time = point.time();
+    const float value = point.value().toFloat();
+
+    if (!m_timeBounds.isInRange(time) || !m_valueBounds.isInRange(value))
+    {
+        prepareGeometryChange();
+        m_timeBounds = RangeF::makeUnion(m_timeBounds, RangeF(time, time));
+        m_valueBounds = RangeF::makeUnion(m_valueBounds, RangeF(value, value));
+    }
+
+    update();
+}
+
+void PointHandleLayer::pixelSizeChanged()
+{
+    // Bounding rect includes handle margins, which are constant in pixels
+    prepareGeometryChange();
+}
+
+PointId PointHandleLayer::pointAt(const QPointF& pos) const
+{
+    const QSizeF pixel = pixelSize();
+    const double halfHandle = HANDLE_SIZE / 2.0;
+    const float halfWidth = halfHandle * pixel.width();
+
+    PointId closest = PointId::invalidId();
+    double closestDistance = 0.0;
+
+    // Candidates from points sorted by time, then check the distance in pixels
+    for (const Point& point : m_model->pointsInRange(RangeF(pos.x() - halfWidth, pos.x() + halfWidth)))
+    {
+        const double dx = (point.time() - pos.x()) / pixel.width();
+        const double dy = (point.value().toFloat() - pos.y()) / pixel.height();
+        if (std::fabs(dx) > halfHandle || std::fabs(dy) > halfHandle)
+            continue;
+
+        const double distance = dx * dx + dy * dy;
+        if (!closest.isValid() || distance < closestDistance)
+        {
+            closest = point.id();
+            closestDistance = distance;
+        }
+    }
+
+    return closest;
+}
+
+void PointHandleLayer::selectInArea(const QRectF& sceneRect, bool extend)
+{
+    const QRectF area = mapRectFromScene(sceneRect);
+
+    // Rubber band selection runs on every mouse move, apply the changes as batches
+    QSet<PointId> inArea;
+    QList<PointId> toSelect;
+    m_model->forEachPointInRange(RangeF(area.left(), area.right()), 0, [&](const Point& point)
+    {
+        const float value = point.value().toFloat();
+        if (value < area.top() || value > area.bottom())
+            return;
+
+        inArea.insert(point.id());
+        if (!point.isSelected())
+            toSelect.append(point.id());
+    });
+
+    m_model->setPointsSelected(toSelect, true);
+
+    if (extend)
+        return;
+
+    QList<PointId> toDeselect;
+    for (PointId id : m_model->selectedPointIds())
+        if (!inArea.contains(id))
+            toDeselect.append(id);
+
+    m_model->setPointsSelected(toDeselect, false);
+}
+
+int PointHandleLayer::type() const
+{
+    return Type;
+}
+
+QRectF PointHandleLayer::boundingRect() const
+{
+    if (!m_timeBounds.isValid() || !m_valueBounds.isValid())
+        return QRectF();
+
+    // Handles around the points and labels right of and below them on screen,
+    // which is towards smaller values as the view flips the y-axis
+    const QSizeF pixel = pixelSize();
+    const qreal halfHandle = HANDLE_SIZE / 2.0;
+    const qreal left = m_timeBounds.min - halfHandle * pixel.width();
+    const qreal right = m_timeBounds.max + qMax(halfHandle, LABEL_SIZE.width()) * pixel.width();
+    const qreal bottom = m_valueBounds.min - qMax(halfHandle, LABEL_SIZE.height()) * pixel.height();
+    const qreal top = m_valueBounds.max + halfHandle * pixel.height();
+
+    return QRectF(QPointF(left, bottom), QPointF(right, top));
+}
+
+bool PointHandleLayer::contains(const QPointF& point) const
+{
+    // Only handles catch mouse presses, elsewhere the scene below gets them
+    return pointAt(point).isValid();
+}
+
+void PointHandleLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+
+    // Points whose handle might reach the exposed area
+    const QSizeF pixel = pixelSize();
+    const qreal margin = HANDLE_SIZE + LABEL_SIZE.width();
+    const QRectF exposed = option->exposedRect.adjusted(-margin * pixel.width(), -margin * pixel.height(),
+                                                        margin * pixel.width(), margin * pixel.height());
+    const QList<Point> points = m_model->pointsInRange(RangeF(exposed.left(), exposed.right()));
+
+    // Handles are fixed size in pixels, draw in device coordinates
+    const QTransform deviceTransform = painter->worldTransform();
+    const QPointF halfHandle(HANDLE_SIZE / 2.0, HANDLE_SIZE / 2.0);
+    const QSizeF handleSize(HANDLE_SIZE, HANDLE_SIZE);
+
+    QVector<QRectF> handles;
+    QVector<QRectF> selectedHandles;
+    QList<Point> selectedPoints;
+    handles.reserve(points.size());
+
+    for (const Point& point : points)
+    {
+        const float value = point.value().toFloat();
+        if (value < exposed.top() || value > exposed.bottom())
+            continue;
+
+        const QPointF devicePos = deviceTransform.map(QPointF(point.time(), value));
+        const QRectF handle(devicePos - halfHandle, handleSize);
+        if (point.isSelected())
+        {
+            selectedHandles.append(handle);
+            selectedPoints.append(point);
+        }
+        else
+        {
+            handles.append(handle);
+        }
+    }
+
+    painter->save();
+    painter->resetTransform();
+    painter->setBrush(Qt::NoBrush);
+
+    QPen pen;
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->drawRects(handles);
+
+    pen.setColor(QColor(Qt::green));
+    painter->setPen(pen);
+    painter->drawRects(selectedHandles);
+
+    // Coordinates next to selected points
+    QFont smaller(painter->font());
+    smaller.setPointSize(8);
+    painter->setFont(smaller);
+    painter->setPen(QPen());
+    for (int i = 0; i < selectedPoints.size(); ++i)
+    {
+        const Point& point = selectedPoints[i];
+        const QRectF labelRect(selectedHandles[i].center(), LABEL_SIZE);
+        painter->drawText(labelRect, Qt::AlignLeft | Qt::AlignTop,
+            QString("(%1,%2)").arg(QString::number(point.time(), 'f', 2), QString::number(point.value().toFloat(), 'f', 2)));
+    }
+
+    painter->restore();
+}
+
+void PointHandleLayer::mousePressEvent(QGraphicsSceneMouseEvent* event)
+{
+    const PointId id = pointAt(event->pos());
+    if (!id.isValid())
+    {
+        event->ignore();
+        return;
+    }
+
+    const bool isSelected = m_model->point(id).isSelected();
+    if (event->modifiers().testFlag(Qt::ControlModifier))
+    {
+        // Toggle selection
+        m_model->pointSelectedChanged(id, !isSelected);
+    }
+    else if (!isSelected)
+    {
+        // Select only the pressed point. Pressing a selected point keeps selection for dragging.
+        clearSelection(scene());
+        m_model->pointSelectedChanged(id, true);
+    }
+
+    m_pressScenePos = event->scenePos();
+    for (PointHandleLayer* layer : layers(scene()))
+        layer->beginDrag();
+
+    event->accept();
+}
+
+void PointHandleLayer::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
+{
+    const QPointF offset = event->scenePos() - m_pressScenePos;
+    for (PointHandleLayer* layer : layers(scene()))
+        layer->drag(offset);
+}
+
+void PointHandleLayer::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
+{
+    Q_UNUSED(event);
+
+    for (PointHandleLayer* layer : layers(scene()))
+        layer->endDrag();
+}
+
+QSizeF PointHandleLayer::pixelSize() const
+{
+    // Scene is not scaled by the view, only flipped
+    const QTransform transform = sceneTransform();
+    const qreal width = std::fabs(transform.m11());
+    const qreal height = std::fabs(transform.m22());
+    return QSizeF(width > 0.0 ? 1.0 / width : 1.0, height > 0.0 ? 1.0 / height : 1.0);
+}
+
+void PointHandleLayer::deselectAll()
+{
+    m_model->setPointsSelected(m_model->selectedPointIds(), false);
+}
+
+void PointHandleLayer::beginDrag()
+{
+    m_dragStartPositions.clear();
+    for (PointId id : m_model->selectedPointIds())
+    {
+        const Point point = m_model->point(id);
+        m_dragStartPositions.insert(id, mapToScene(QPointF(point.time(), point.value().toFloat())));
+    }
+}
+
+void PointHandleLayer::drag(const QPointF& sceneOffset)
+{
+    if (m_dragStartPositions.isEmpty())
+        return;
+
+    // Move all points of the curve with a single model update
+    const QTransform fromScene = sceneTransform().inverted();
+    QVector<CurveModelAbs::PointUpdate> updates;
+    updates.reserve(m_dragStartPositions.size());
+    for (auto it = m_dragStartPositions.constBegin(); it != m_dragStartPositions.constEnd(); ++it)
+    {
+        const QPointF pos = snapToGrid(fromScene.map(it.value() + sceneOffset));
+        updates.append({it.key(), static_cast<float>(pos.x()), pos.y()});
+    }
+
+    m_model->updatePoints(updates);
+}
+
+void PointHandleLayer::endDrag()
+{
+    m_dragStartPositions.clear();
+}
+
+QPointF PointHandleLayer::snapToGrid(QPointF pos) const
+{
+    // Closest grid line in the directions that have a grid step
+    if (m_gridRect.width() > 0.0)
+        pos.setX(m_gridRect.left() + std::round((pos.x() - m_gridRect.left()) / m_gridRect.width()) * m_gridRect.width());
+    if (m_gridRect.height() > 0.0)
+        pos.setY(m_gridRect.top() + std::round((pos.y() - m_gridRect.top()) / m_gridRect.height()) * m_gridRect.height());
+
+    return pos;
+}
@@ -0,0 +1,127 @@
+#ifndef POINTHANDLELAYER_H
+#define POINTHANDLELAYER_H
+
+#include "Point.h"
+#include "RangeF.h"
+#include <QGraphicsItem>
+#include <QHash>
+#include <QList>
+#include <memory>
+
+class CurveModelAbs;
+
+QT_BEGIN_NAMESPACE
+class QGraphicsScene;
+class QGraphicsSceneMouseEvent;
+QT_END_NAMESPACE
+
+/**
+ * @brief Point handles of a curve drawn and handled by a single graphics item.
+ *
+ * Handles of the points within the exposed area are painted in one pass,
+ * looked up from the time ordered points of the model. Hit testing is done
+ * against the same points instead of having an item per point. Point
+ * selection is kept in the model.
+ *
+ * Like scene selection of ordinary items, interaction spans all handle layers
+ * in the scene: dragging moves the selected points of every curve and clicking
+ * a point deselects the points of other curves.
+ *
+ * Layer uses the coordinates of the curve, time on x-axis and point value on y-axis.
+ */
+class PointHandleLayer : public QGraphicsItem
+{
+public:
+    /** Graphics item type for qgraphicsitem_cast */
+    enum { Type = UserType + 1 };
+
+    /** Handle width and height in pixels */
+    static const int HANDLE_SIZE = 10;
+
+    /**
+     * @brief Construct PointHandleLayer
+     * @param model Curve model
+     * @param parent Parent item, the curve view
+     */
+    PointHandleLayer(std::shared_ptr<CurveModelAbs> model, QGraphicsItem* parent);
+    ~PointHandleLayer();
+
+    /** @return All handle layers in a scene */
+    static QList<PointHandleLayer*> layers(QGraphicsScene* scene);
+
+    /** @brief Deselect points of all handle layers in a scene. */
+    static void clearSelection(QGraphicsScene* scene);
+
+    /**
+     * @brief Set snap grid. A valid snap grid restricts possible point positions when dragging.
+     * Points snap to multiples of the grid width in time and of the grid height in value,
+     * counted from the grid position. Zero width or height leaves that direction free.
+     * @param gridRect New snap grid.
+     */
+    void setSnapGrid(QRectF gridRect);
+
+    /**
+     * @brief Point was added or moved. Extends the layer to cover the point.
+     * @param point The point
+     */
+    void pointChanged(const Point& point);
+
+    /** @brief Size of a pixel in curve coordinates changed. Handle size in the layer changes accordingly. */
+    void pixelSizeChanged();
+
+    /**
+     * @brief Find handle at a position.
+     * @param pos Position in layer coordinates
+     * @return Id of the closest point whose handle contains the position, invalid if none
+     */
+    PointId pointAt(const QPointF& pos) const;
+
+    /**
+     * @brief Select points within an area.
+     * @param sceneRect Area in scene coordinates
+     * @param extend If true, selected points outside the area are kept selected
+     */
+    void selectInArea(const QRectF& sceneRect, bool extend);
+
+    /** @brief Store positions of selected points for dragging them. */
+    void beginDrag();
+    /**
+     * @brief Move selected points by an offset from their positions when the drag began, as one batched model update.
+     * @param sceneOffset Offset in scene coordinates
+     */
+    void drag(const QPointF& sceneOffset);
+    /** @brief Finish dragging. */
+    void endDrag();
+
+public: // QGraphicsItem
+    int type() const override;
+    QRectF boundingRect() const override;
+    bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+protected:
+    void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
+
+private:
+    /** @return Size of a pixel in layer coordinates */
+    QSizeF pixelSize() const;
+
+    void deselectAll();
+
+    /** @return Position snapped to the snap grid */
+    QPointF snapToGrid(QPointF pos) const;
+
+    std::shared_ptr<CurveModelAbs> m_model;
+
+    RangeF m_timeBounds; ///< Time range of all point positions seen
+    RangeF m_valueBounds; ///< Value range of all point positions seen
+
+    QRectF m_gridRect;
+
+    QPointF m_pressScenePos; ///< Where drag started
+    QHash<PointId, QPointF> m_dragStartPositions; ///< Scene positions of selected points when drag started
+};
+
+#endif // POINTHANDLELAYER_H
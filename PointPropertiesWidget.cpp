@@ -122,6 +122,7 @@ void PointPropertiesWidget::addCurve(std::shared_ptr<CurveModelAbs> curve)
 
     connect(splineCurve.get(), SIGNAL(pointSelected(PointId)), this, SLOT(pointSelected(PointId)));
     connect(splineCurve.get(), SIGNAL(pointDeselected(PointId)), this, SLOT(pointDeselected(PointId)));
+    connect(splineCurve.get(), SIGNAL(pointsSelectedChanged(QList<PointId>,bool)), this, SLOT(pointsSelectedChanged(QList<PointId>,bool)));
 }
 
 void PointPropertiesWidget::removeCurve(std::shared_ptr<CurveModelAbs> curve)
@@ -135,6 +136,7 @@ void PointPropertiesWidget::removeCurve(std::shared_ptr<CurveModelAbs> curve)
 
     disconnect(splineCurve.get(), SIGNAL(pointSelected(PointId)), this, SLOT(pointSelected(PointId)));
     disconnect(splineCurve.get(), SIGNAL(pointDeselected(PointId)), this, SLOT(pointDeselected(PointId)));
+    disconnect(splineCurve.get(), SIGNAL(pointsSelectedChanged(QList<PointId>,bool)), this, SLOT(pointsSelectedChanged(QList<PointId>,bool)));
 
     QList<PointId> toBeRemoved;
     for (auto point : m_selectedPoints.keys())
@@ -191,6 +193,33 @@ void PointPropertiesWidget::pointDeselected(PointId id)
     selectedPointUpdated(m_singleSelectedPoint.first);
 }
 
+void PointPropertiesWidget::pointsSelectedChanged(QList<PointId> ids, bool isSelected)
+{
+    // Batched selection comes from a single curve
+    std::shared_ptr<CurveModel> curve;
+    for (const auto& candidate : m_curves)
+        if (candidate.get() == sender())
+            curve = candidate;
+
+    if (!curve)
+        return;
+
+    unsetSingleSelectedPoint();
+
+    for (PointId id : ids)
+    {
+        if (isSelected)
+            m_selectedPoints.insert(id, curve);
+        else
+            m_selectedPoints.remove(id);
+    }
+
+    if (m_selectedPoints.size() == 1)
+        setSingleSelectedPoint();
+
+    selectedPointUpdated(m_singleSelectedPoint.first);
+}
+
 void PointPropertiesWidget::selectedPointUpdated(PointId id)
 {
     if (id.isValid())
@@ -216,6 +245,13 @@ void PointPropertiesWidget::selectedPointUpdated(PointId id)
     }
 }
 
+void PointPropertiesWidget::selectedPointsUpdated(QList<PointId> ids)
+{
+    // Batched update might not include the selected point
+    if (ids.contains(m_singleSelectedPoint.first))
+        selectedPointUpdated(m_singleSelectedPoint.first);
+}
+
 void PointPropertiesWidget::parameterChanged(int value)
 {
     Q_UNUSED(value);
@@ -292,6 +328,7 @@ void PointPropertiesWidget::setSingleSelectedPoint()
     Q_ASSERT(m_singleSelectedPoint.first == PointId::invalidId());
 
     connect(m_selectedPoints.first().get(), SIGNAL(pointUpdated(PointId)), this, SLOT(selectedPointUpdated(PointId)));
+    connect(m_selectedPoints.first().get(), SIGNAL(pointsUpdated(QList<PointId>)), this, SLOT(selectedPointsUpdated(QList<PointId>)));
     connect(m_timeEdit, SIGNAL(textChanged(QString)), this, SLOT(timeTextChanged(QString)));
     connect(m_valueEdit, SIGNAL(textChanged(QString)), this, SLOT(valueTextChanged(QString)));
     m_singleSelectedPoint = std::make_pair(m_selectedPoints.firstKey(), m_selectedPoints.first());
@@ -305,6 +342,7 @@ void PointPropertiesWidget::unsetSingleSelectedPoint()
     if (m_singleSelectedPoint.first.isValid())
     {
         disconnect(m_singleSelectedPoint.second.get(), SIGNAL(pointUpdated(PointId)), this, SLOT(selectedPointUpdated(PointId)));
+        disconnect(m_singleSelectedPoint.second.get(), SIGNAL(pointsUpdated(QList<PointId>)), this, SLOT(selectedPointsUpdated(QList<PointId>)));
         disconnect(m_timeEdit, SIGNAL(textChanged(QString)), this, SLOT(timeTextChanged(QString)));
         disconnect(m_valueEdit, SIGNAL(textChanged(QString)), this, SLOT(valueTextChanged(QString)));
         m_singleSelectedPoint = std::make_pair(PointId::invalidId(), nullptr);
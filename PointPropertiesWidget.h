@@ -40,7 +40,9 @@ private slots:
 
     void pointSelected(PointId id);
     void pointDeselected(PointId id);
+    void pointsSelectedChanged(QList<PointId> ids, bool isSelected);
     void selectedPointUpdated(PointId id);
+    void selectedPointsUpdated(QList<PointId> ids);
 
     void parameterChanged(int value);
     void timeTextChanged(QString text);
@@ -0,0 +1,102 @@
+#include "RedrawScheduler.h"
+
+#include <QTimer>
+#include <QDebug>
+
+RedrawScheduler::RedrawScheduler(QObject* parent)
+  : QObject(parent),
+    m_timer(new QTimer(this)),
+    m_sinceFlush(),
+    m_pending(),
+    m_requestCount(0),
+    m_redrawCount(0)
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &RedrawScheduler::flush);
+}
+
+RedrawScheduler::~RedrawScheduler()
+{
+}
+
+void RedrawScheduler::schedule(QObject* target, std::function<void()> redraw)
+{
+    if (!target || !redraw)
+    {
+        qWarning() << "Trying to schedule redraw without target or function";
+        return;
+    }
+
+    ++m_requestCount;
+
+    if (!m_pending.contains(target))
+        connect(target, &QObject::destroyed, this, &RedrawScheduler::targetDestroyed, Qt::UniqueConnection);
+    m_pending.insert(target, redraw);
+
+    if (m_timer->isActive())
+        return;
+
+    // Next event loop iteration, but not before a frame has passed since the previous flush
+    const qint64 elapsed = m_sinceFlush.isValid() ? m_sinceFlush.elapsed() : FRAME_INTERVAL_MS;
+    m_timer->start(static_cast<int>(qBound<qint64>(0, FRAME_INTERVAL_MS - elapsed, FRAME_INTERVAL_MS)));
+}
+
+void RedrawScheduler::cancel(QObject* target)
+{
+    if (m_pending.remove(target))
+        disconnect(target, &QObject::destroyed, this, &RedrawScheduler::targetDestroyed);
+}
+
+bool RedrawScheduler::isScheduled(QObject* target) const
+{
+    return m_pending.contains(target);
+}
+
+int RedrawScheduler::requestCount() const
+{
+    return m_requestCount;
+}
+
+int RedrawScheduler::redrawCount() const
+{
+    return m_redrawCount;
+}
+
+int RedrawScheduler::avoidedCount() const
+{
+    return m_requestCount - m_redrawCount;
+}
+
+void RedrawScheduler::resetCounters()
+{
+    m_requestCount = 0;
+    m_redrawCount = 0;
+}
+
+void RedrawScheduler::flush()
+{
+    m_timer->stop();
+    m_sinceFlush.start();
+
+    // Targets requested so far. A target requesting again after its redraw is left for the next flush.
+    const QList<QObject*> targets = m_pending.keys();
+    for (QObject* target : targets)
+    {
+        // Earlier redraw might have cancelled or destroyed the target
+        auto it = m_pending.find(target);
+        if (it == m_pending.end())
+            continue;
+
+        const std::function<void()> redraw = it.value();
+        m_pending.erase(it);
+        disconnect(target, &QObject::destroyed, this, &RedrawScheduler::targetDestroyed);
+
+        redraw();
+        ++m_redrawCount;
+    }
+}
+
+void RedrawScheduler::targetDestroyed(QObject* target)
+{
+    m_pending.remove(target);
+}
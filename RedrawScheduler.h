@@ -0,0 +1,79 @@
+#ifndef REDRAWSCHEDULER_H
+#define REDRAWSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+/**
+ * @brief Coalesces redraw requests and flushes them at most once per display frame.
+ *
+ * A target requesting several redraws before the next flush is redrawn only once.
+ * Flushing happens on the next event loop iteration, delayed when needed so that
+ * flushes are at least a frame interval apart. Targets destroyed before the flush
+ * are dropped.
+ *
+ * Counts requested and performed redraws to show how many were avoided.
+ */
+class RedrawScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Minimum time between flushes in milliseconds, about one frame at 60 Hz */
+    static const int FRAME_INTERVAL_MS = 16;
+
+    /**
+     * @brief Construct RedrawScheduler
+     * @param parent Parent object
+     */
+    explicit RedrawScheduler(QObject* parent = nullptr);
+    ~RedrawScheduler();
+
+    /**
+     * @brief Request a redraw. Replaces a pending redraw of the same target.
+     * @param target Object to redraw
+     * @param redraw Function doing the redraw
+     */
+    void schedule(QObject* target, std::function<void()> redraw);
+
+    /**
+     * @brief Drop a pending redraw
+     * @param target Object not to redraw
+     */
+    void cancel(QObject* target);
+
+    /** @return True if target has a pending redraw */
+    bool isScheduled(QObject* target) const;
+
+    /** @return Number of redraws requested since the counters were reset */
+    int requestCount() const;
+    /** @return Number of redraws done since the counters were reset */
+    int redrawCount() const;
+    /** @return Number of requested redraws coalesced or cancelled since the counters were reset */
+    int avoidedCount() const;
+    /** Reset redraw counters */
+    void resetCounters();
+
+public slots:
+    /** @brief Redraw all pending targets now. */
+    void flush();
+
+private slots:
+    /** Drop a pending redraw of a destroyed target */
+    void targetDestroyed(QObject* target);
+
+private:
+    QTimer* m_timer;
+    QElapsedTimer m_sinceFlush; ///< Time since the previous flush
+    QHash<QObject*, std::function<void()>> m_pending; ///< Pending redraws by target
+    int m_requestCount;
+    int m_redrawCount;
+};
+
+#endif // REDRAWSCHEDULER_H
@@ -11,7 +11,6 @@
 
 #include "TransformationNode.h"
 #include "RangeF.h"
-#include "GraphicsItem.h"
 #include <QObject>
 #include <QList>
 
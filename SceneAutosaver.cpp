@@ -0,0 +1,150 @@
+#include "SceneAutosaver.h"
+#include "SceneModel.h"
+#include "SceneSnapshot.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+namespace {
+
+/** Serialize modified curves and write the scene to a file. Executed in a worker thread. */
+bool writeAutosave(SceneModel::ChunkSource source, QString fileName)
+{
+    const SceneModel::Chunks chunks = SceneModel::serializeChunks(source);
+
+    // Write to a temporary file first, the previous autosave stays intact if writing fails
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open autosave file:" << file.errorString();
+        return false;
+    }
+
+    if (!SceneModel::writeChunks(chunks, file))
+    {
+        qWarning() << "Failed to write autosave file:" << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+} // anonymous namespace
+
+SceneAutosaver::SceneAutosaver(int intervalMs, QObject* parent)
+  : QObject(parent),
+    m_timer(new QTimer(this)),
+    m_watcher(new QFutureWatcher<bool>(this)),
+    m_scene(),
+    m_autosavedRevision(0),
+    m_writeFileName()
+{
+    m_timer->setInterval(intervalMs);
+    connect(m_timer, &QTimer::timeout, this, &SceneAutosaver::autosave);
+    connect(m_watcher, &QFutureWatcher<bool>::finished, this, &SceneAutosaver::writeFinished);
+}
+
+SceneAutosaver::~SceneAutosaver()
+{
+    m_watcher->waitForFinished();
+}
+
+void SceneAutosaver::setScene(std::shared_ptr<SceneModel> scene)
+{
+    m_scene = scene;
+
+    if (m_scene)
+    {
+        // Nothing to autosave until the scene is modified
+        m_autosavedRevision = m_scene->revision();
+        m_timer->start();
+    }
+    else
+    {
+        m_timer->stop();
+    }
+}
+
+bool SceneAutosaver::isSaving() const
+{
+    return m_watcher->isRunning();
+}
+
+void SceneAutosaver::waitForSaving()
+{
+    m_watcher->waitForFinished();
+}
+
+void SceneAutosaver::discardAutosave()
+{
+    waitForSaving();
+
+    if (m_writeFileName.isEmpty())
+        return;
+
+    if (QFile::exists(m_writeFileName) && !QFile::remove(m_writeFileName))
+        qWarning() << "Failed to remove autosave file" << m_writeFileName;
+
+    // Scene needs a new autosave only when modified again
+    m_writeFileName.clear();
+    if (m_scene)
+        m_autosavedRevision = m_scene->revision();
+}
+
+QString SceneAutosaver::autosaveFileName(const SceneModel& scene)
+{
+    if (scene.fileName().isEmpty())
+        return QDir(QDir::tempPath()).filePath("curveeditor_unnamed.xml.autosave");
+
+    return scene.fileName() + ".autosave";
+}
+
+void SceneAutosaver::autosave()
+{
+    if (!m_scene)
+        return;
+
+    // Nothing new to save
+    if (!m_scene->isModified() || m_scene->revision() == m_autosavedRevision)
+        return;
+
+    if (isSaving())
+    {
+        qDebug() << "Previous autosave still ongoing, skipping" << m_writeFileName;
+        return;
+    }
+
+    // Models are not thread safe, take a snapshot in this thread and serialize it in the worker.
+    // Unmodified curves are copied from the saved file.
+    SceneModel::ChunkSource source = m_scene->chunkSource();
+    m_autosavedRevision = source.scene->revision();
+    m_writeFileName = autosaveFileName(*m_scene);
+
+    qDebug() << "Autosaving scene to" << m_writeFileName;
+
+    m_watcher->setFuture(QtConcurrent::run(writeAutosave, source, m_writeFileName));
+}
+
+void SceneAutosaver::writeFinished()
+{
+    // Autosave already discarded
+    if (m_writeFileName.isEmpty())
+        return;
+
+    if (!m_watcher->result())
+    {
+        // Forget the written revision to try again on next interval
+        qWarning() << "Autosave failed:" << m_writeFileName;
+        m_autosavedRevision = 0;
+        return;
+    }
+
+    emit autosaved(m_writeFileName);
+}
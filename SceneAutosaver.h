@@ -0,0 +1,90 @@
+#ifndef SCENEAUTOSAVER_H
+#define SCENEAUTOSAVER_H
+
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class SceneModel;
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+template <typename T> class QFutureWatcher;
+QT_END_NAMESPACE
+
+/**
+ * @brief Periodically saves a backup copy of a scene in a background thread.
+ *
+ * On each autosave interval a snapshot of the scene is taken in the calling thread.
+ * The curves modified since the scene was last saved are serialized from it and
+ * written to the autosave file in a worker thread, copying unmodified curves from
+ * the saved scene file, so that editing is not blocked by serialization or file I/O.
+ *
+ * Scene is not saved if it has not been modified since the previous autosave or
+ * save, or if the previous autosave is still being written. The autosave file is
+ * removed with discardAutosave() once a save or closing the scene supersedes it.
+ */
+class SceneAutosaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct SceneAutosaver
+     * @param intervalMs Autosave interval in milliseconds
+     * @param parent Parent object
+     */
+    explicit SceneAutosaver(int intervalMs, QObject* parent = nullptr);
+    /** Destructor. Waits for a possible ongoing write. */
+    ~SceneAutosaver();
+
+    /**
+     * @brief Set the scene to autosave.
+     * @param scene Scene to autosave, null to stop autosaving
+     */
+    void setScene(std::shared_ptr<SceneModel> scene);
+
+    /** @return True if an autosave is being written */
+    bool isSaving() const;
+
+    /**
+     * @brief Wait for an ongoing autosave to be written.
+     *
+     * Must be called before replacing the saved scene file the autosave may be copying curves from.
+     */
+    void waitForSaving();
+
+    /** @brief Remove the autosave file written for the scene. Waits for an ongoing write. */
+    void discardAutosave();
+
+    /**
+     * @brief Get autosave file name for a scene.
+     * @param scene The scene
+     * @return Autosave file next to the scene file, or in the temp directory for unnamed scenes
+     */
+    static QString autosaveFileName(const SceneModel& scene);
+
+signals:
+    /**
+     * @brief Autosave was written.
+     * @param fileName Name of the autosave file
+     */
+    void autosaved(QString fileName);
+
+public slots:
+    /** @brief Autosave the scene now if it has been modified. */
+    void autosave();
+
+private slots:
+    /** Background write finished */
+    void writeFinished();
+
+private:
+    QTimer* m_timer;
+    QFutureWatcher<bool>* m_watcher;
+    std::shared_ptr<SceneModel> m_scene;
+    quint64 m_autosavedRevision; ///< Scene revision written by the previous autosave
+    QString m_writeFileName; ///< File being written or written by the previous autosave
+};
+
+#endif // SCENEAUTOSAVER_H
@@ -0,0 +1,150 @@
+#include "SceneBaker.h"
+#include "SceneModel.h"
+#include "CurveModel.h"
+#include "StepCurveModel.h"
+#include "CurveSnapshot.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+/** Baking of one curve in a worker thread */
+struct BakeJob
+{
+    std::shared_ptr<const CurveSnapshot> curve; ///< Curve data, models must not be accessed from workers
+    float startTime;
+    float step;
+    int sampleCount;
+    QVector<float>* samples;
+};
+
+BakeJob makeJob(std::shared_ptr<CurveModelAbs> curve, double startTime, double sampleRate, int sampleCount, QVector<float>* samples)
+{
+    BakeJob job;
+    job.curve = curve->snapshot();
+    job.startTime = static_cast<float>(startTime);
+    job.step = static_cast<float>(1.0 / sampleRate);
+    job.sampleCount = sampleCount;
+    job.samples = samples;
+    return job;
+}
+
+void bakeJob(const BakeJob& job)
+{
+    job.samples->resize(job.sampleCount);
+    job.curve->sample(job.startTime, job.step, job.sampleCount, job.samples->data());
+}
+
+/** Maximum length of a curve name in bytes */
+const int MAX_NAME_LENGTH = 0xffff;
+
+/** @return Name in UTF-8, cut before the character that would exceed the maximum length */
+QByteArray encodeName(const QString& name)
+{
+    QByteArray encoded = name.toUtf8();
+    if (encoded.size() <= MAX_NAME_LENGTH)
+        return encoded;
+
+    // Continuation bytes of a multibyte character start with bits 10
+    int end = MAX_NAME_LENGTH;
+    while (end > 0 && (static_cast<quint8>(encoded[end]) & 0xc0) == 0x80)
+        --end;
+
+    encoded.truncate(end);
+    return encoded;
+}
+
+} // anonymous namespace
+
+SceneBaker::Baked SceneBaker::bake(const SceneModel& scene, double sampleRate)
+{
+    Baked baked;
+    baked.sampleRate = sampleRate;
+    baked.startTime = scene.timeRange().min;
+    baked.sampleCount = 0;
+
+    const RangeF timeRange = scene.timeRange();
+    if (!(sampleRate > 0.0) || !timeRange.isValid())
+    {
+        qWarning() << "Invalid sample rate or time range for baking" << sampleRate;
+        return baked;
+    }
+
+    baked.sampleCount = static_cast<int>(std::floor((timeRange.max - timeRange.min) * sampleRate)) + 1;
+
+    const QList<std::shared_ptr<CurveModelAbs>> curves = scene.curves();
+    baked.curves.resize(curves.size());
+
+    // Snapshot curves here, models must not be accessed from the worker threads
+    QVector<BakeJob> jobs;
+    jobs.reserve(curves.size());
+    for (int i = 0; i < curves.size(); ++i)
+    {
+        baked.curves[i].name = curves[i]->name();
+        baked.curves[i].isStep = static_cast<bool>(CurveModelAbs::getAsStepCurve(curves[i]));
+        jobs.push_back(makeJob(curves[i], baked.startTime, sampleRate, baked.sampleCount, &baked.curves[i].samples));
+    }
+
+    QtConcurrent::blockingMap(jobs, bakeJob);
+
+    return baked;
+}
+
+QVector<float> SceneBaker::bakeCurve(std::shared_ptr<CurveModelAbs> curve, double startTime, double sampleRate, int sampleCount)
+{
+    QVector<float> samples;
+    if (!curve || !(sampleRate > 0.0) || sampleCount < 0)
+    {
+        qWarning() << "Invalid curve or sampling for baking";
+        return samples;
+    }
+
+    bakeJob(makeJob(curve, startTime, sampleRate, sampleCount, &samples));
+    return samples;
+}
+
+bool SceneBaker::write(const Baked& baked, QIODevice& device)
+{
+    QDataStream stream(&device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream.writeRawData("CEBK", 4);
+    stream << FORMAT_VERSION;
+    stream << static_cast<quint32>(baked.curves.size());
+    stream << static_cast<quint32>(baked.sampleCount);
+    stream << baked.sampleRate;
+    stream << baked.startTime;
+
+    for (const Curve& curve : baked.curves)
+    {
+        const QByteArray name = encodeName(curve.name);
+        stream << static_cast<quint8>(curve.isStep ? 1 : 0);
+        stream << static_cast<quint16>(name.size());
+        stream.writeRawData(name.constData(), name.size());
+    }
+
+    // Samples as raw little-endian floats
+    for (const Curve& curve : baked.curves)
+    {
+        Q_ASSERT(curve.samples.size() == baked.sampleCount);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        stream.writeRawData(reinterpret_cast<const char*>(curve.samples.constData()), curve.samples.size() * sizeof(float));
+#else
+        for (float sample : curve.samples)
+        {
+            quint32 bits;
+            std::memcpy(&bits, &sample, sizeof(bits));
+            stream << bits;
+        }
+#endif
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,93 @@
+#ifndef SCENEBAKER_H
+#define SCENEBAKER_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class SceneModel;
+class CurveModelAbs;
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/**
+ * @brief Bakes scene curves to samples at a fixed rate.
+ *
+ * Baked curves can be played back without knowledge of the curve types:
+ * value at time t is a linear interpolation between samples
+ * floor((t - startTime) * sampleRate) and the one following it.
+ *
+ * Spline curves are evaluated with their Kochanek-Bartels splines, step curves
+ * hold the value of the latest key. Before the first and after the last key
+ * the value of the nearest key is used. Curves are baked in parallel using all
+ * available cores.
+ *
+ * File format, all values little-endian:
+ * - char[4] magic "CEBK"
+ * - quint32 format version
+ * - quint32 number of curves
+ * - quint32 number of samples per curve
+ * - double sample rate in Hz
+ * - double time of the first sample
+ * - For each curve: quint8 type (0 = spline, 1 = step), quint16 name length, name in UTF-8
+ *   cut at a character boundary to fit the length
+ * - For each curve: number of samples floats, curves one after another
+ */
+class SceneBaker
+{
+public:
+    /** Baked curve */
+    struct Curve
+    {
+        QString name;
+        bool isStep;
+        QVector<float> samples;
+    };
+
+    /** Baked scene */
+    struct Baked
+    {
+        double sampleRate;
+        double startTime;
+        int sampleCount;
+        QVector<Curve> curves;
+    };
+
+    /** File format version */
+    static const quint32 FORMAT_VERSION = 1;
+
+    /**
+     * @brief Bake all curves of a scene over the scene time range.
+     *
+     * Must be called from the thread the scene lives in. Curves are snapshotted before the
+     * parallel evaluation starts and workers read only the snapshots, which share the keys
+     * with the models until the models next change.
+     *
+     * @param scene The scene
+     * @param sampleRate Samples per second, must be positive
+     * @return Baked curves. No curves if sample rate or scene time range is invalid.
+     */
+    static Baked bake(const SceneModel& scene, double sampleRate);
+
+    /**
+     * @brief Bake a single curve.
+     * @param curve The curve
+     * @param startTime Time of the first sample
+     * @param sampleRate Samples per second, must be positive
+     * @param sampleCount Number of samples
+     * @return Samples
+     */
+    static QVector<float> bakeCurve(std::shared_ptr<CurveModelAbs> curve, double startTime, double sampleRate, int sampleCount);
+
+    /**
+     * @brief Write baked curves.
+     * @param baked Baked curves
+     * @param device Output device
+     * @return True if all data was written
+     */
+    static bool write(const Baked& baked, QIODevice& device);
+};
+
+#endif // SCENEBAKER_H
@@ -0,0 +1,117 @@
+#include "SceneLoader.h"
+#include "SceneModel.h"
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QThread>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+SceneLoader::SceneLoader(QObject* parent)
+  : QObject(parent),
+    m_watcher(new QFutureWatcher<LoadResult>(this)),
+    m_fileName(),
+    m_cancelRequested(0)
+{
+    connect(m_watcher, &QFutureWatcher<LoadResult>::finished, this, &SceneLoader::loadFinished);
+}
+
+SceneLoader::~SceneLoader()
+{
+    // Don't leave the worker running with a dangling loader
+    m_cancelRequested.store(1);
+    m_watcher->waitForFinished();
+}
+
+bool SceneLoader::isLoading() const
+{
+    return m_watcher->isRunning();
+}
+
+const QString& SceneLoader::fileName() const
+{
+    return m_fileName;
+}
+
+bool SceneLoader::load(const QString& fileName)
+{
+    if (isLoading())
+    {
+        qWarning() << "Scene load already ongoing for" << m_fileName;
+        return false;
+    }
+
+    qDebug() << "SceneLoader::load" << fileName;
+
+    m_fileName = fileName;
+    m_cancelRequested.store(0);
+    m_watcher->setFuture(QtConcurrent::run(this, &SceneLoader::loadInBackground, fileName, thread()));
+    return true;
+}
+
+void SceneLoader::cancel()
+{
+    if (!isLoading())
+        return;
+
+    qDebug() << "SceneLoader::cancel" << m_fileName;
+    m_cancelRequested.store(1);
+}
+
+void SceneLoader::loadFinished()
+{
+    const LoadResult result = m_watcher->result();
+
+    if (m_cancelRequested.load())
+    {
+        // Scene might have been finished before cancellation was noticed, drop it anyways
+        emit cancelled();
+    }
+    else if (!result.scene)
+    {
+        qWarning() << "Failed to load scene from file:" << m_fileName << result.error;
+        emit failed(m_fileName, result.error);
+    }
+    else
+    {
+        emit loaded(result.scene);
+    }
+}
+
+SceneLoader::LoadResult SceneLoader::loadInBackground(QString fileName, QThread* targetThread)
+{
+    LoadResult result;
+
+    QFile sceneFile(fileName);
+    if (!sceneFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        result.error = sceneFile.errorString();
+        return result;
+    }
+
+    const qint64 bytesTotal = sceneFile.size();
+
+    auto progress = [this, &sceneFile, bytesTotal](int curvesRead)
+    {
+        emit progressChanged(sceneFile.pos(), bytesTotal, curvesRead);
+        return m_cancelRequested.load() == 0;
+    };
+
+    QXmlStreamReader stream(&sceneFile);
+    result.scene = SceneModel::create(stream, progress);
+
+    if (!result.scene)
+    {
+        result.error = stream.hasError() ? stream.errorString() : QString("Scene load failed");
+        return result;
+    }
+
+    emit progressChanged(bytesTotal, bytesTotal, result.scene->curves().size());
+
+    // Hand the scene over to the receiving thread
+    result.scene->setFileName(fileName);
+    result.scene->moveModelsToThread(targetThread);
+
+    return result;
+}
@@ -0,0 +1,100 @@
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QString>
+#include <memory>
+
+class SceneModel;
+
+QT_BEGIN_NAMESPACE
+class QThread;
+template <typename T> class QFutureWatcher;
+QT_END_NAMESPACE
+
+/**
+ * @brief Loads a scene file in a background thread.
+ *
+ * The file is read and parsed in a worker thread while progress is reported
+ * through progressChanged(). When loading is done the scene model is moved to
+ * the thread of the loader and handed over through loaded().
+ *
+ * Only one scene can be loaded at a time.
+ */
+class SceneLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct SceneLoader
+     * @param parent Parent object
+     */
+    explicit SceneLoader(QObject* parent = nullptr);
+    /** Destructor. Cancels and waits for a possible ongoing load. */
+    ~SceneLoader();
+
+    /** @return True if a load is ongoing */
+    bool isLoading() const;
+
+    /** @return Name of the file being loaded or the last loaded file */
+    const QString& fileName() const;
+
+signals:
+    /**
+     * @brief Load progress changed. Emitted from the loading thread.
+     * @param bytesRead Number of bytes read from the file so far
+     * @param bytesTotal File size in bytes
+     * @param curvesRead Number of curves read so far
+     */
+    void progressChanged(qint64 bytesRead, qint64 bytesTotal, int curvesRead);
+
+    /**
+     * @brief Scene was loaded successfully.
+     * @param scene The loaded scene, lives in the thread of the loader
+     */
+    void loaded(std::shared_ptr<SceneModel> scene);
+
+    /**
+     * @brief Scene load failed.
+     * @param fileName Name of the file being loaded
+     * @param reason Description of the failure
+     */
+    void failed(QString fileName, QString reason);
+
+    /** @brief Scene load was cancelled. */
+    void cancelled();
+
+public slots:
+    /**
+     * @brief Start loading a scene.
+     * @param fileName Scene file name
+     * @return True if loading was started, false if another load is still ongoing.
+     */
+    bool load(const QString& fileName);
+
+    /** @brief Request ongoing load to be cancelled. Results in cancelled() once the worker has stopped. */
+    void cancel();
+
+private slots:
+    /** Background loading finished */
+    void loadFinished();
+
+private:
+    /** Result of a background load */
+    struct LoadResult
+    {
+        std::shared_ptr<SceneModel> scene;
+        QString error;
+    };
+
+    /** Load a scene. Executed in a worker thread. */
+    LoadResult loadInBackground(QString fileName, QThread* targetThread);
+
+    QFutureWatcher<LoadResult>* m_watcher;
+    QString m_fileName; ///< File currently being loaded
+    QAtomicInt m_cancelRequested; ///< Non-zero if ongoing load should be cancelled
+};
+
+#endif // SCENELOADER_H
@@ -3,9 +3,17 @@
 #include "CurveModel.h"
 #include "StepCurveModel.h"
 #include "EditorModel.h"
+#include "SceneSnapshot.h"
+#include "CurveKeyCodec.h"
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QDebug>
+#include <limits>
 
 ///////////////////////////////////////
 ///////////////////////////////////////
@@ -65,7 +73,55 @@ bool readString(QXmlStreamReader& stream, QString attribute, QString& result)
     return true;
 }
 
-std::shared_ptr<CurveModel> createCurve(QXmlStreamReader& stream)
+/** Callback to report progress while reading curves. Returns false if reading should be cancelled. */
+using ReportProgress = std::function<bool()>;
+
+/** Number of keys read within a single curve between progress reports */
+const int KEYS_PER_PROGRESS_REPORT = 4096;
+
+/**
+ * Report progress after a key has been read.
+ * @return False if reading was cancelled, in which case an error is raised to the stream.
+ */
+bool keyRead(QXmlStreamReader& stream, int& keysRead, const ReportProgress& reportProgress)
+{
+    ++keysRead;
+    if (!reportProgress || (keysRead % KEYS_PER_PROGRESS_REPORT) != 0)
+        return true;
+
+    if (reportProgress())
+        return true;
+
+    stream.raiseError("Scene load cancelled");
+    return false;
+}
+
+/**
+ * Read keys encoded with CurveKeyCodec from a packed_keys element.
+ * @return False if keys could not be decoded, in which case an error is raised to the stream.
+ */
+template <typename Key>
+bool readPackedKeys(QXmlStreamReader& stream, QVector<Key>& keys)
+{
+    const QByteArray data = QByteArray::fromBase64(stream.readElementText().toLatin1());
+    if (!CurveKeyCodec::decode(data, keys))
+    {
+        stream.raiseError("Bad packed keys");
+        return false;
+    }
+    return true;
+}
+
+/** Write keys encoded with CurveKeyCodec as a packed_keys element. */
+void writePackedKeys(const QByteArray& data, int keyCount, QXmlStreamWriter& stream)
+{
+    stream.writeStartElement("packed_keys");
+    stream.writeAttribute("count", QString::number(keyCount));
+    stream.writeCharacters(QString::fromLatin1(data.toBase64()));
+    stream.writeEndElement();
+}
+
+std::shared_ptr<CurveModel> createCurve(QXmlStreamReader& stream, const ReportProgress& reportProgress, bool& packedKeysRead)
 {
     // Read start of curve element
     if (!stream.isStartElement())
@@ -89,6 +145,8 @@ std::shared_ptr<CurveModel> createCurve(QXmlStreamReader& stream)
     float valueOffset = 0;
     float valueMultiplier = 1;
 
+    int keysRead = 0;
+
     while (!stream.atEnd())
     {
         stream.readNext();
@@ -132,6 +190,29 @@ std::shared_ptr<CurveModel> createCurve(QXmlStreamReader& stream)
             readFloat(stream, "continuity", continuity);
 
             curve->updatePointParams(pid, tension, bias, continuity);
+
+            if (!keyRead(stream, keysRead, reportProgress))
+                return nullptr;
+        }
+        else if (stream.isStartElement() && stream.name() == "packed_keys")
+        {
+            QVector<CurveKeyCodec::SplineKey> keys;
+            if (!readPackedKeys(stream, keys))
+                return nullptr;
+            packedKeysRead = true;
+
+            for (const CurveKeyCodec::SplineKey& key : keys)
+            {
+                const float scaledValue = key.value * valueMultiplier + valueOffset;
+                const PointId pid = curve->addPoint(key.time, scaledValue);
+                if (!pid.isValid())
+                    continue;
+
+                curve->updatePointParams(pid, key.tension, key.bias, key.continuity);
+
+                if (!keyRead(stream, keysRead, reportProgress))
+                    return nullptr;
+            }
         }
         else if (stream.isStartElement() && stream.name() == "value_offset")
         {
@@ -180,7 +261,7 @@ StepCurveModel::Options readOptions(QXmlStreamReader& stream)
     return options;
 }
 
-std::shared_ptr<StepCurveModel> createStepCurve(QXmlStreamReader& stream)
+std::shared_ptr<StepCurveModel> createStepCurve(QXmlStreamReader& stream, const ReportProgress& reportProgress, bool& packedKeysRead)
 {
     Q_ASSERT(stream.isStartElement() && (stream.name() == "step_curve"));
 
@@ -189,6 +270,8 @@ std::shared_ptr<StepCurveModel> createStepCurve(QXmlStreamReader& stream)
 
     StepCurveModel::Options options;
 
+    int keysRead = 0;
+
     while (!stream.atEnd())
     {
         stream.readNext();
@@ -218,6 +301,24 @@ std::shared_ptr<StepCurveModel> createStepCurve(QXmlStreamReader& stream)
                 continue;
 
             curve->addPoint(time, value);
+
+            if (!keyRead(stream, keysRead, reportProgress))
+                return nullptr;
+        }
+        else if (stream.isStartElement() && stream.name() == "packed_keys")
+        {
+            QVector<CurveKeyCodec::StepKey> keys;
+            if (!readPackedKeys(stream, keys))
+                return nullptr;
+            packedKeysRead = true;
+
+            for (const CurveKeyCodec::StepKey& key : keys)
+            {
+                curve->addPoint(key.time, key.value);
+
+                if (!keyRead(stream, keysRead, reportProgress))
+                    return nullptr;
+            }
         }
         else if (stream.isStartElement() && stream.name() == "options")
         {
@@ -233,36 +334,70 @@ std::shared_ptr<StepCurveModel> createStepCurve(QXmlStreamReader& stream)
     return nullptr;
 }
 
-QList<std::shared_ptr<CurveModelAbs>> loadCurves(QXmlStreamReader& stream)
+/**
+ * Read curves from a curves element.
+ * @param packedKeysRead [out] Set to true if some curve had its keys packed with CurveKeyCodec
+ */
+QList<std::shared_ptr<CurveModelAbs>> loadCurves(QXmlStreamReader& stream, const SceneModel::LoadProgress& progress, bool& packedKeysRead)
 {
     QList<std::shared_ptr<CurveModelAbs>> curves;
 
+    // Report the number of curves read so far
+    ReportProgress reportProgress;
+    if (progress)
+        reportProgress = [&curves, &progress]() { return progress(curves.size()); };
+
     while (!stream.atEnd() || (stream.isEndElement() && stream.name().contains("curves")))
     {
         stream.readNext();
         if (stream.isStartElement() && stream.name().contains("catmull_rom", Qt::CaseSensitive))
         {
-            std::shared_ptr<CurveModel> newCurve = createCurve(stream);
+            std::shared_ptr<CurveModel> newCurve = createCurve(stream, reportProgress, packedKeysRead);
             if (newCurve)
                 curves.append(newCurve);
         }
-        if (stream.isStartElement() && stream.name().contains("step_curve", Qt::CaseSensitive))
+        else if (stream.isStartElement() && stream.name().contains("step_curve", Qt::CaseSensitive))
         {
-            std::shared_ptr<StepCurveModel> newStepCurve = createStepCurve(stream);
+            std::shared_ptr<StepCurveModel> newStepCurve = createStepCurve(stream, reportProgress, packedKeysRead);
             if (newStepCurve)
                 curves.append(newStepCurve);
         }
+        else
+        {
+            continue;
+        }
+
+        if (reportProgress && !reportProgress())
+        {
+            stream.raiseError("Scene load cancelled");
+            break;
+        }
     }
     return curves;
 }
 
-bool serializeCurve(std::shared_ptr<CurveModel> curve, QXmlStreamWriter& stream)
+/**
+ * Helpers to serialize curves to xml. Curves are serialized from snapshots, so this can be done in any thread.
+ *
+ * @param curve Curve snapshot
+ * @param stream Stream
+ * @param packedKeysGrid Time grid for packing keys with CurveKeyCodec, null to write plain key elements.
+ * @return True if serialization succeeded
+ */
+bool serializeCurve(const CurveSnapshot& curve, QXmlStreamWriter& stream, const CurveKeyCodec::TimeGrid* packedKeysGrid)
 {
+    const CurveSnapshot::Spline* spline = curve.spline();
+    if (!spline)
+    {
+        qWarning() << "Spline curve without a spline" << curve.name();
+        return false;
+    }
+
     stream.writeStartElement("catmull_rom");
-    stream.writeAttribute("name", curve->name());
+    stream.writeAttribute("name", curve.name());
 
     // Value range (offset + multiplier)
-    const RangeF valueRange = curve->valueRange();
+    const RangeF valueRange = curve.valueRange();
     const float offset = valueRange.min;
     const float multiplier = valueRange.max - valueRange.min;
     stream.writeEmptyElement("value_offset");
@@ -270,34 +405,50 @@ bool serializeCurve(std::shared_ptr<CurveModel> curve, QXmlStreamWriter& stream)
     stream.writeEmptyElement("value_multiplier");
     stream.writeAttribute("v", QString("%1").arg(multiplier));
 
-    for (auto id : curve->pointIds())
+    // Spline data is in time order and holds the KB parameters of each key
+    if (packedKeysGrid)
     {
-        const Point p = curve->point(id);
+        QVector<CurveKeyCodec::SplineKey> keys;
+        keys.reserve(static_cast<int>(spline->data().size()));
+        for (const auto& p : spline->data())
+        {
+            const pt::math::kochanek_bartels_parameters& params = p.parameters();
+            const CurveKeyCodec::SplineKey key = { p.time(), (p.value() - offset) / multiplier,
+                                                   params.tension, params.bias, params.continuity };
+            keys.push_back(key);
+        }
+
+        writePackedKeys(CurveKeyCodec::encode(keys, *packedKeysGrid), keys.size(), stream);
+        stream.writeEndElement();
+        return true;
+    }
 
+    for (const auto& p : spline->data())
+    {
         stream.writeEmptyElement("key");
 
         const float time = p.time();
-        const float value = (p.value().toFloat() - offset) / multiplier;
+        const float value = (p.value() - offset) / multiplier;
 
-        stream.writeAttribute("time", QString("%1").arg(time));
-        stream.writeAttribute("value", QString("%1").arg(value));
+        stream.writeAttribute("time", QString::number(time));
+        stream.writeAttribute("value", QString::number(value));
 
-        const CurveModel::KbParams params = curve->params(id);
-        if (params.tension() != 0.0f)
-            stream.writeAttribute("tension", QString("%1").arg(params.tension()));
+        const pt::math::kochanek_bartels_parameters& params = p.parameters();
+        if (params.tension != 0.0f)
+            stream.writeAttribute("tension", QString::number(params.tension));
 
-        if (params.bias() != 0.0f)
-            stream.writeAttribute("bias", QString("%1").arg(params.bias()));
+        if (params.bias != 0.0f)
+            stream.writeAttribute("bias", QString::number(params.bias));
 
-        if (params.continuity() != 0.0f)
-            stream.writeAttribute("continuity", QString("%1").arg(params.continuity()));
+        if (params.continuity != 0.0f)
+            stream.writeAttribute("continuity", QString::number(params.continuity));
     }
 
     stream.writeEndElement();
     return true;
 }
 
-void writeOptions(const StepCurveModel::Options& options, QXmlStreamWriter& stream)
+void writeOptions(const CurveSnapshot::Options& options, QXmlStreamWriter& stream)
 {
     stream.writeStartElement("options");
 
@@ -311,31 +462,119 @@ void writeOptions(const StepCurveModel::Options& options, QXmlStreamWriter& stre
     stream.writeEndElement();
 }
 
-bool serializeStepCurve(std::shared_ptr<StepCurveModel> curve, QXmlStreamWriter& stream)
+bool serializeStepCurve(const CurveSnapshot& curve, QXmlStreamWriter& stream, const CurveKeyCodec::TimeGrid* packedKeysGrid)
 {
     stream.writeStartElement("step_curve");
-    stream.writeAttribute("name", curve->name());
+    stream.writeAttribute("name", curve.name());
 
     // Options
-    writeOptions(curve->options(), stream);
+    writeOptions(curve.options(), stream);
 
-    for (auto id : curve->pointIds())
+    // Points are visited in place, copying them would copy the value of each
+    if (packedKeysGrid)
     {
-        const Point p = curve->point(id);
+        QVector<CurveKeyCodec::StepKey> keys;
+        keys.reserve(curve.numberOfPoints());
+        curve.forEachPoint([&keys](const Point& p)
+        {
+            const CurveKeyCodec::StepKey key = { p.time(), p.value().toInt() };
+            keys.push_back(key);
+        });
+
+        writePackedKeys(CurveKeyCodec::encode(keys, *packedKeysGrid), keys.size(), stream);
+        stream.writeEndElement();
+        return true;
+    }
 
+    // Single pass over the points in time order
+    curve.forEachPoint([&stream](const Point& p)
+    {
         stream.writeEmptyElement("key");
 
         const float time = p.time();
         const int value = p.value().toInt();
 
-        stream.writeAttribute("time", QString("%1").arg(time));
-        stream.writeAttribute("value", QString("%1").arg(value));
-    }
+        stream.writeAttribute("time", QString::number(time));
+        stream.writeAttribute("value", QString::number(value));
+    });
 
     stream.writeEndElement();
     return true;
 }
 
+/** Estimated serialized sizes of curves and keys in bytes */
+const int CURVE_BYTES_ESTIMATE = 512;
+const int PLAIN_KEY_BYTES_ESTIMATE = 56;
+const int PACKED_KEY_BYTES_ESTIMATE = 8;
+
+/** @return Estimated size of a serialized curve, used to size the output buffer up front. */
+int estimateChunkSize(const CurveSnapshot& curve, bool packedKeys)
+{
+    const int keyBytes = packedKeys ? PACKED_KEY_BYTES_ESTIMATE : PLAIN_KEY_BYTES_ESTIMATE;
+    return CURVE_BYTES_ESTIMATE + curve.numberOfPoints() * keyBytes;
+}
+
+bool serializeAnyCurve(const CurveSnapshot& curve, QXmlStreamWriter& stream, const CurveKeyCodec::TimeGrid* packedKeysGrid)
+{
+    if (curve.isStep())
+        return serializeStepCurve(curve, stream, packedKeysGrid);
+
+    return serializeCurve(curve, stream, packedKeysGrid);
+}
+
+/** Write scene properties of a snapshot */
+void writeProperties(const SceneSnapshot& scene, QXmlStreamWriter& stream)
+{
+    const RangeF timeRange = scene.timeRange();
+    {
+        stream.writeStartElement("timerange");
+        stream.writeAttribute("valid", timeRange.isValid() ? "true" : "false");
+        if (timeRange.isValid())
+        {
+            stream.writeAttribute("start", QString("%1").arg(timeRange.min));
+            stream.writeAttribute("end", QString("%1").arg(timeRange.max));
+        }
+        stream.writeEndElement();
+    }
+    {
+        stream.writeStartElement("music");
+        stream.writeAttribute("firstBeatOffset", QString("%1").arg(scene.beatOffset()));
+        stream.writeAttribute("beatsPerMinute", QString("%1").arg(scene.bpm()));
+        stream.writeEndElement();
+    }
+}
+
+/** Write all curves of a snapshot, keys packed or as plain xml elements */
+void writeCurves(const SceneSnapshot& scene, QXmlStreamWriter& stream, bool packKeys)
+{
+    const CurveKeyCodec::TimeGrid grid = CurveKeyCodec::TimeGrid::fromTempo(scene.beatOffset(), scene.bpm());
+
+    // Size an output in memory up front like serialized chunks, instead of growing it curve by curve.
+    // Writing to a byte array goes through a buffer device.
+    if (QBuffer* buffer = qobject_cast<QBuffer*>(stream.device()))
+    {
+        qint64 estimate = buffer->size();
+        for (auto &curve : scene.curves())
+            estimate += estimateChunkSize(*curve, packKeys);
+        if (estimate < std::numeric_limits<int>::max())
+            buffer->buffer().reserve(static_cast<int>(estimate));
+    }
+
+    stream.writeStartElement("curves");
+
+    for (auto &curve : scene.curves())
+    {
+        if (!serializeAnyCurve(*curve, stream, packKeys ? &grid : nullptr))
+        {
+            qWarning() << "Scene curve serialization failed";
+            return;
+        }
+    }
+
+    stream.writeEndElement();
+    stream.writeEndDocument();
+}
+
 ///////////////////////////////////////
 ///////////////////////////////////////
 ///////////////////////////////////////
@@ -347,7 +586,15 @@ SceneModel::SceneModel(RangeF timeRange)
     m_bpm(80.0), // Default to 80bpm
     m_AllCurvesEditor(new EditorModel(m_timeRange, m_beatOffset, m_bpm)),
     m_SelectedCurvesEditor(new EditorModel(m_timeRange, m_beatOffset, m_bpm)),
-    m_fileName() // No filename by default
+    m_fileName(), // No filename by default
+    m_revision(0),
+    m_savedRevision(0),
+    m_savedCurveBlocks(),
+    m_savedFileName(),
+    m_savedFileSize(0),
+    m_savedFileModified(),
+    m_packedKeys(false),
+    m_evaluationCursors()
 {
     // Connect standard editors
     connect(this, &SceneModel::curveAdded, m_AllCurvesEditor.get(), &EditorModel::addCurve);
@@ -366,10 +613,22 @@ SceneModel::SceneModel(RangeF timeRange)
     connect(m_SelectedCurvesEditor.get(), &EditorModel::requestToAddNewCurve, this, &SceneModel::addCurve);
 }
 
-std::shared_ptr<SceneModel> SceneModel::create(QXmlStreamReader& stream)
+std::shared_ptr<SceneModel> SceneModel::create(QXmlStreamReader& stream, const LoadProgress& progress)
 {
     std::shared_ptr<SceneModel> sceneModel = std::make_shared<SceneModel>(RangeF());
 
+    bool packedKeysRead = false;
+    bool cancelled = false;
+    LoadProgress observeProgress;
+    if (progress)
+    {
+        observeProgress = [&cancelled, &progress](int curvesRead)
+        {
+            cancelled = cancelled || !progress(curvesRead);
+            return !cancelled;
+        };
+    }
+
     while (!stream.atEnd())
     {
         stream.readNext();
@@ -401,20 +660,43 @@ std::shared_ptr<SceneModel> SceneModel::create(QXmlStreamReader& stream)
         }
         else if (stream.isStartElement() && stream.name().contains("curves", Qt::CaseSensitive))
         {
-            QList<std::shared_ptr<CurveModelAbs>> newCurves = ::loadCurves(stream);
+            QList<std::shared_ptr<CurveModelAbs>> newCurves = ::loadCurves(stream, observeProgress, packedKeysRead);
             for (auto &curve : newCurves)
                 sceneModel->addCurve(curve);
         }
     }
 
+    if (cancelled)
+    {
+        qDebug() << "Scene load cancelled at (" << stream.lineNumber() << ":" << stream.columnNumber() << ")";
+        return nullptr;
+    }
+
     if (stream.hasError())
     {
         qDebug() << "Error "<< stream.error() << "at (" << stream.lineNumber() << ":" << stream.columnNumber() << ") " << stream.errorString();
     }
 
+    // Keep saving keys the way the file stores them, without marking the scene modified
+    sceneModel->m_packedKeys = packedKeysRead;
+
+    // Freshly loaded scene matches the file
+    sceneModel->setSaved(sceneModel->revision());
+
     return sceneModel;
 }
 
+void SceneModel::moveModelsToThread(QThread* thread)
+{
+    for (auto &curve : m_curves)
+        curve->moveToThread(thread);
+
+    m_AllCurvesEditor->moveToThread(thread);
+    m_SelectedCurvesEditor->moveToThread(thread);
+
+    moveToThread(thread);
+}
+
 SceneModel::~SceneModel()
 {
     // Editors are disconnected automatically
@@ -455,11 +737,49 @@ const QString& SceneModel::fileName() const
     return m_fileName;
 }
 
+bool SceneModel::packedKeys() const
+{
+    return m_packedKeys;
+}
+
+quint64 SceneModel::revision() const
+{
+    return m_revision;
+}
+
+bool SceneModel::isModified() const
+{
+    return m_revision != m_savedRevision;
+}
+
+QList<std::shared_ptr<CurveModelAbs>> SceneModel::dirtyCurves() const
+{
+    QList<std::shared_ptr<CurveModelAbs>> dirty;
+
+    for (auto &curve : m_curves)
+        if (!m_savedCurveBlocks.contains(curve.get()))
+            dirty.push_back(curve);
+
+    return dirty;
+}
+
+std::shared_ptr<const SceneSnapshot> SceneModel::snapshot() const
+{
+    SceneSnapshot::Curves curves;
+    curves.reserve(m_curves.size());
+    for (auto &curve : m_curves)
+        curves.push_back(curve->snapshot());
+
+    return std::shared_ptr<const SceneSnapshot>(new SceneSnapshot(m_revision, m_timeRange, m_beatOffset, m_bpm, curves));
+}
+
 void SceneModel::addCurve(std::shared_ptr<CurveModelAbs> curve)
 {
     if (!addCurveInternal(curve))
         return;
 
+    markModified();
+
     emit curveAdded(curve);
 
     if (curve->isSelected())
@@ -486,9 +806,26 @@ bool SceneModel::addCurveInternal(std::shared_ptr<CurveModelAbs> curve)
 
     // Listen to curve changes
     connect(curve.get(), &CurveModelAbs::selectedChanged, this, &SceneModel::curveSelectionChanged);
-    connect(curve.get(), &CurveModelAbs::pointRemoved, this, &SceneModel::curvePointRemoved);
+    connect(curve.get(), &CurveModelAbs::pointRemoved, this, &SceneModel::curvePointsRemoved);
+    connect(curve.get(), &CurveModelAbs::pointsRemoved, this, &SceneModel::curvePointsRemoved);
+
+    // Listen to curve content changes to keep track of modified curves
+    connect(curve.get(), &CurveModelAbs::nameChanged, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::timeRangeChanged, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointAdded, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointsAdded, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointUpdated, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointsUpdated, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointRemoved, this, &SceneModel::curveContentChanged);
+    connect(curve.get(), &CurveModelAbs::pointsRemoved, this, &SceneModel::curveContentChanged);
+
+    if (std::shared_ptr<CurveModel> splineCurve = CurveModelAbs::getAsSplineCurve(curve))
+        connect(splineCurve.get(), &CurveModel::valueRangeChanged, this, &SceneModel::curveContentChanged);
+    if (std::shared_ptr<StepCurveModel> stepCurve = CurveModelAbs::getAsStepCurve(curve))
+        connect(stepCurve.get(), &StepCurveModel::optionsChanged, this, &SceneModel::curveContentChanged);
 
     m_curves.push_back(curve);
+    m_evaluationCursors.remove(curve.get());
     return true;
 }
 
@@ -497,6 +834,8 @@ void SceneModel::removeCurve(std::shared_ptr<CurveModelAbs> curve)
     if (!removeCurveInternal(curve))
         return;
 
+    markModified();
+
     if (curve->isSelected())
         emit curveDeselected(curve);
 
@@ -519,13 +858,14 @@ bool SceneModel::removeCurveInternal(std::shared_ptr<CurveModelAbs> curve)
 
     // Deselect curve on removal
     curve->setSelected(false);
-    // No longer listen to curve changes
-    disconnect(curve.get(), &CurveModelAbs::selectedChanged, this, &SceneModel::curveSelectionChanged);
-    disconnect(curve.get(), &CurveModelAbs::pointRemoved, this, &SceneModel::curvePointRemoved);
+    // No longer listen to any curve changes
+    disconnect(curve.get(), nullptr, this, nullptr);
     disconnect(this, &SceneModel::timeRangeChanged, curve.get(), &CurveModelAbs::setTimeRange);
 
     // Remove all instance, just in case
     m_curves.removeAll(curve);
+    m_savedCurveBlocks.remove(curve.get());
+    m_evaluationCursors.remove(curve.get());
 
     return true;
 }
@@ -535,6 +875,7 @@ void SceneModel::setTimeRange(RangeF newTimeRange)
     if (m_timeRange != newTimeRange)
     {
         m_timeRange = newTimeRange;
+        markModified();
         emit timeRangeChanged(m_timeRange);
     }
 }
@@ -544,6 +885,8 @@ void SceneModel::setBeatOffset(double beatOffset)
     if (m_beatOffset != beatOffset)
     {
         m_beatOffset = beatOffset;
+        clearPackedCurveBlocks();
+        markModified();
         emit beatOffsetChanged(m_beatOffset);
     }
 }
@@ -553,6 +896,8 @@ void SceneModel::setBpm(double bpm)
     if (m_bpm != bpm)
     {
         m_bpm = bpm;
+        clearPackedCurveBlocks();
+        markModified();
         emit bpmChanged(m_bpm);
     }
 }
@@ -608,10 +953,8 @@ void SceneModel::curveSelectionChanged(bool status)
     qWarning() << "Manual selection change notification from unknown curve" << status;
 }
 
-void SceneModel::curvePointRemoved(PointId point)
+void SceneModel::curvePointsRemoved()
 {
-    Q_UNUSED(point);
-
     const void* sendingCurve = sender();
 
     // Find the curve that sent the notification and emit (de)selection
@@ -628,29 +971,42 @@ void SceneModel::curvePointRemoved(PointId point)
     qWarning() << "Point removed notification from unknown curve";
 }
 
+void SceneModel::curveContentChanged()
+{
+    const CurveModelAbs* sendingCurve = qobject_cast<const CurveModelAbs*>(sender());
+    if (!sendingCurve)
+    {
+        qWarning() << "Content change notification from unknown sender";
+        return;
+    }
+
+    // Saved block no longer matches the curve
+    m_savedCurveBlocks.remove(sendingCurve);
+    markModified();
+}
+
+void SceneModel::markModified()
+{
+    ++m_revision;
+}
+
+void SceneModel::clearPackedCurveBlocks()
+{
+    // Packed keys depend on the beat grid
+    if (m_packedKeys)
+        m_savedCurveBlocks.clear();
+}
+
 void SceneModel::serialize(QXmlStreamWriter& stream)
 {
+    const std::shared_ptr<const SceneSnapshot> scene = snapshot();
+
     // Serialize scene data
     stream.writeStartElement("scene");
-    {
-        stream.writeStartElement("timerange");
-        stream.writeAttribute("valid", m_timeRange.isValid() ? "true" : "false");
-        if (m_timeRange.isValid())
-        {
-            stream.writeAttribute("start", QString("%1").arg(m_timeRange.min));
-            stream.writeAttribute("end", QString("%1").arg(m_timeRange.max));
-        }
-        stream.writeEndElement();
-    }
-    {
-        stream.writeStartElement("music");
-        stream.writeAttribute("firstBeatOffset", QString("%1").arg(m_beatOffset));
-        stream.writeAttribute("beatsPerMinute", QString("%1").arg(m_bpm));
-        stream.writeEndElement();
-    }
+    writeProperties(*scene, stream);
 
     // Serialize curves
-    serializeCurves(stream);
+    writeCurves(*scene, stream, m_packedKeys);
 
     // End scene
     stream.writeEndElement();
@@ -658,35 +1014,277 @@ void SceneModel::serialize(QXmlStreamWriter& stream)
 
 void SceneModel::serializeCurves(QXmlStreamWriter& stream)
 {
-    stream.writeStartElement("curves");
+    // Exported curves are always plain xml
+    writeCurves(*snapshot(), stream, false);
+}
+
+namespace {
+
+/** @return True if the saved file is still as it was written, so its curve blocks can be copied */
+bool isSavedFileIntact(const QFileInfo& file, qint64 size, const QDateTime& modified)
+{
+    return file.exists() && file.size() == size && file.lastModified() == modified;
+}
 
+} // anonymous namespace
+
+SceneModel::ChunkSource SceneModel::chunkSource() const
+{
+    ChunkSource source;
+    source.scene = snapshot();
+    source.packedKeys = m_packedKeys;
+    source.savedFileName = m_savedFileName;
+    source.savedFileSize = m_savedFileSize;
+    source.savedFileModified = m_savedFileModified;
+
+    source.savedBlocks.reserve(m_curves.size());
     for (auto &curve : m_curves)
+        source.savedBlocks.push_back(m_savedCurveBlocks.value(curve.get(), CurveBlock{ 0, 0 }));
+
+    return source;
+}
+
+SceneModel::Chunks SceneModel::serializeChunks() const
+{
+    return serializeChunks(chunkSource());
+}
+
+SceneModel::Chunks SceneModel::serializeChunks(const ChunkSource& source)
+{
+    const SceneSnapshot& scene = *source.scene;
+
+    Chunks chunks;
+    chunks.revision = scene.revision();
+    chunks.savedFileName = source.savedFileName;
+    chunks.savedFileSize = source.savedFileSize;
+    chunks.savedFileModified = source.savedFileModified;
+
     {
-        std::shared_ptr<CurveModel> splineCurve = CurveModelAbs::getAsSplineCurve(curve);
-        std::shared_ptr<StepCurveModel> stepCurve = CurveModelAbs::getAsStepCurve(curve);
+        // Header and footer from one document, split where the curves go
+        QByteArray document;
+        QXmlStreamWriter stream(&document);
+        stream.setAutoFormatting(true);
+        stream.writeStartDocument("1.0");
+        stream.writeStartElement("scene");
+        writeProperties(scene, stream);
+        stream.writeStartElement("curves");
+        // Finish the curves start tag before splitting
+        stream.writeCharacters("");
+        const int curvesStart = document.size();
+        stream.writeEndElement();
+        stream.writeEndElement();
+        stream.writeEndDocument();
 
-        bool retVal = false;
+        chunks.header = document.left(curvesStart);
+        chunks.footer = document.mid(curvesStart);
+    }
 
-        if (splineCurve)
-            retVal |= serializeCurve(splineCurve, stream);
-        else if (stepCurve)
-            retVal |= serializeStepCurve(stepCurve, stream);
+    // Saved blocks can be copied only from the file as it was written, otherwise serialize every curve
+    const bool savedFileIntact = !source.savedFileName.isEmpty()
+        && isSavedFileIntact(QFileInfo(source.savedFileName), source.savedFileSize, source.savedFileModified);
+    const CurveKeyCodec::TimeGrid grid = CurveKeyCodec::TimeGrid::fromTempo(scene.beatOffset(), scene.bpm());
+
+    for (int i = 0; i < scene.curves().size(); ++i)
+    {
+        const CurveSnapshot& curve = *scene.curves()[i];
+        CurveChunk chunk = { QByteArray(), { 0, 0 } };
+
+        const CurveBlock saved = i < source.savedBlocks.size() ? source.savedBlocks[i] : CurveBlock{ 0, 0 };
+        if (savedFileIntact && saved.size > 0)
+        {
+            chunk.saved = saved;
+        }
         else
-            qWarning() << "Trying to seralize unknown curve type" << curve->name();
+        {
+            // Curve modified since last save, serialize it
+            chunk.data.reserve(estimateChunkSize(curve, source.packedKeys));
+            QXmlStreamWriter stream(&chunk.data);
+            stream.setAutoFormatting(true);
+            if (!serializeAnyCurve(curve, stream, source.packedKeys ? &grid : nullptr))
+            {
+                qWarning() << "Scene curve serialization failed" << curve.name();
+                continue;
+            }
+        }
+
+        chunks.curves.push_back(chunk);
+    }
+
+    return chunks;
+}
 
-        if (!retVal)
+namespace {
+
+/** Size of the buffer for copying saved curve blocks */
+const qint64 COPY_BUFFER_SIZE = 64 * 1024;
+
+/** Copy a block of bytes from one device to another */
+bool copyBlock(QIODevice& source, SceneModel::CurveBlock block, QIODevice& target)
+{
+    if (!source.seek(block.offset))
+        return false;
+
+    qint64 remaining = block.size;
+    while (remaining > 0)
+    {
+        const QByteArray data = source.read(qMin(remaining, COPY_BUFFER_SIZE));
+        if (data.isEmpty() || target.write(data) != data.size())
+            return false;
+
+        remaining -= data.size();
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+bool SceneModel::writeChunks(const Chunks& chunks, QIODevice& device, QVector<CurveBlock>* curveBlocks)
+{
+    if (curveBlocks)
+        curveBlocks->clear();
+
+    if (device.write(chunks.header) != chunks.header.size())
+        return false;
+
+    // Saved file is opened only if some curve is copied from it
+    QFile savedFile(chunks.savedFileName);
+
+    for (auto &chunk : chunks.curves)
+    {
+        const qint64 offset = device.pos();
+
+        if (chunk.data.isEmpty())
         {
-            qWarning() << "Scene curve serialization failed";
-            return;
+            if (!savedFile.isOpen())
+            {
+                if (!isSavedFileIntact(QFileInfo(chunks.savedFileName), chunks.savedFileSize, chunks.savedFileModified)
+                    || !savedFile.open(QIODevice::ReadOnly))
+                {
+                    qWarning() << "Saved scene file changed, unable to copy unmodified curves:" << chunks.savedFileName;
+                    return false;
+                }
+            }
+
+            if (!copyBlock(savedFile, chunk.saved, device))
+                return false;
         }
+        else if (device.write(chunk.data) != chunk.data.size())
+        {
+            return false;
+        }
+
+        if (curveBlocks)
+            curveBlocks->push_back({ offset, device.pos() - offset });
     }
 
-    stream.writeEndElement();
-    stream.writeEndDocument();
+    return device.write(chunks.footer) == chunks.footer.size();
+}
+
+namespace {
+
+/** Evaluation of one curve at all times of a scene evaluation */
+struct EvaluationJob
+{
+    const CurveModelAbs* curve;
+    const CurveModel* splineCurve; ///< Null for step curves
+    CurveModel::SplineCursor* cursor; ///< Spline cursor of a spline curve, kept between evaluations
+    int column; ///< Curve index in the output
+    int columnCount; ///< Number of curves in the output
+    const float* times;
+    int timeCount;
+    float* out;
+};
+
+void evaluateJob(const EvaluationJob& job)
+{
+    const bool useCursor = job.splineCurve && job.splineCurve->spline().data().size() > 0;
+    for (int i = 0; i < job.timeCount; ++i)
+    {
+        float& value = job.out[i * job.columnCount + job.column];
+        if (useCursor)
+            value = job.cursor->value_at(job.times[i]);
+        else
+            value = job.curve->valueAt(job.times[i]);
+    }
 }
 
+} // anonymous namespace
+
+void SceneModel::evaluate(float time, float* out) const
+{
+    evaluate(&time, 1, out);
+}
+
+void SceneModel::evaluate(const float* times, int timeCount, float* out) const
+{
+    const int curveCount = m_curves.size();
+    if (curveCount == 0 || timeCount <= 0)
+        return;
+
+    QVector<EvaluationJob> jobs;
+    jobs.reserve(curveCount);
+    for (int i = 0; i < curveCount; ++i)
+    {
+        // Cursors are kept per curve until it is removed, a rebuilt spline needs a new one.
+        // Hash values are not moved by later inserts, so jobs can point to them.
+        const CurveModel* splineCurve = CurveModelAbs::getAsSplineCurve(m_curves[i]).get();
+        CurveModel::SplineCursor* cursor = nullptr;
+        if (splineCurve)
+        {
+            cursor = &m_evaluationCursors[splineCurve];
+            if (cursor->spline() != &splineCurve->spline())
+                *cursor = CurveModel::SplineCursor(splineCurve->spline());
+        }
+
+        EvaluationJob job = { m_curves[i].get(), splineCurve, cursor, i, curveCount, times, timeCount, out };
+        jobs.push_back(job);
+    }
+
+    if (curveCount < 2 || curveCount * timeCount < PARALLEL_EVALUATION_THRESHOLD)
+    {
+        for (const EvaluationJob& job : jobs)
+            evaluateJob(job);
+        return;
+    }
+
+    // Curves are independent, each job writes its own column
+    QtConcurrent::blockingMap(jobs, evaluateJob);
+}
 
 void SceneModel::setFileName(const QString& fileName)
 {
     m_fileName = fileName;
 }
+
+void SceneModel::setSaved(quint64 revision, const QVector<CurveBlock>& curveBlocks)
+{
+    m_savedRevision = revision;
+    m_savedCurveBlocks.clear();
+    m_savedFileName.clear();
+    m_savedFileSize = 0;
+    m_savedFileModified = QDateTime();
+
+    // Blocks of a different revision may not match the curves anymore
+    if (revision != m_revision || curveBlocks.size() != m_curves.size())
+        return;
+
+    for (int i = 0; i < m_curves.size(); ++i)
+        m_savedCurveBlocks.insert(m_curves[i].get(), curveBlocks[i]);
+
+    const QFileInfo savedFile(m_fileName);
+    m_savedFileName = m_fileName;
+    m_savedFileSize = savedFile.size();
+    m_savedFileModified = savedFile.lastModified();
+}
+
+void SceneModel::setPackedKeys(bool packed)
+{
+    if (m_packedKeys != packed)
+    {
+        m_packedKeys = packed;
+        m_savedCurveBlocks.clear();
+        // Saved file uses the previous key encoding
+        markModified();
+    }
+}
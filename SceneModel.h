@@ -3,16 +3,26 @@
 
 #include "PointId.h"
 #include "RangeF.h"
+#include "pt/math/kb_spline.h"
+#include "pt/math/spline_cursor.h"
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+#include <QVector>
+#include <functional>
 #include <memory>
 
 class CurveModelAbs;
 class CurveModel;
 class StepCurveModel;
 class EditorModel;
+class SceneSnapshot;
 
 QT_BEGIN_NAMESPACE
+class QIODevice;
+class QThread;
 class QXmlStreamReader;
 class QXmlStreamWriter;
 QT_END_NAMESPACE
@@ -35,12 +45,34 @@ public:
     /** @brief Destructor. */
     ~SceneModel();
 
+    /**
+     * @brief Progress callback for scene deserialization.
+     *
+     * Called after each curve and periodically while reading long curves.
+     * The argument is the number of curves read so far. Returning false cancels the load.
+     */
+    using LoadProgress = std::function<bool(int curvesRead)>;
+
     /**
      * @brief Deserialize new scenemodel from xml stream.
+     *
+     * Keys are saved packed if the stream had packed keys (@see packedKeys), and the scene is not modified.
+     *
      * @param stream The stream
-     * @return Deserialized scene model or null object if creation failed
+     * @param progress Optional progress callback, can be used to cancel the load
+     * @return Deserialized scene model or null object if creation failed or was cancelled
      */
-    static std::shared_ptr<SceneModel> create(QXmlStreamReader& stream);
+    static std::shared_ptr<SceneModel> create(QXmlStreamReader& stream, const LoadProgress& progress = LoadProgress());
+
+    /**
+     * @brief Change thread affinity of the scene, its editors and curves.
+     *
+     * Used to hand over a scene created in a background thread. Must be called
+     * from the thread the scene currently lives in.
+     *
+     * @param thread Target thread
+     */
+    void moveModelsToThread(QThread* thread);
 
     /** @return Curves contained in this scene. */
     QList<std::shared_ptr<CurveModelAbs>> curves() const;
@@ -61,6 +93,135 @@ public:
     /** @return File name associated with the scene. */
     const QString& fileName() const;
 
+    /** @return True if curve keys are saved packed with CurveKeyCodec instead of plain xml elements. */
+    bool packedKeys() const;
+
+    /** @return Scene content revision. Incremented on every change that affects the serialized scene. */
+    quint64 revision() const;
+
+    /** @return True if the scene has been modified since it was last saved. */
+    bool isModified() const;
+
+    /** @return Curves modified since the scene was last saved, or all curves if their saved blocks are unknown. */
+    QList<std::shared_ptr<CurveModelAbs>> dirtyCurves() const;
+
+    /**
+     * @brief Take an immutable snapshot of the scene for reading in other threads.
+     *
+     * Curve snapshots are shared with the curves until they change, @see CurveModelAbs::snapshot.
+     * Must be called from the thread of the scene.
+     *
+     * @return Scene data at the current revision
+     */
+    std::shared_ptr<const SceneSnapshot> snapshot() const;
+
+    /** @brief Location of a serialized curve in a scene file */
+    struct CurveBlock
+    {
+        qint64 offset; ///< Offset of the curve from the start of the file in bytes
+        qint64 size; ///< Size of the curve in bytes
+    };
+
+    /** @brief One curve of a serialized scene. */
+    struct CurveChunk
+    {
+        QByteArray data; ///< Serialized curve, empty for a curve copied from the saved file
+        CurveBlock saved; ///< Block of an unmodified curve in the saved file
+    };
+
+    /**
+     * @brief Scene serialized as xml chunks, written block by block.
+     *
+     * Header, curve chunks and footer written one after another form a complete scene
+     * document readable with create(). Curves modified since the scene was last saved
+     * are serialized, unmodified curves are copied from their blocks in the saved file
+     * when written. The data is implicitly shared and can be written from any thread.
+     */
+    struct Chunks
+    {
+        quint64 revision; ///< Scene revision the chunks were serialized from
+        QByteArray header; ///< Document start, scene properties and curves start
+        QList<CurveChunk> curves; ///< One chunk per curve
+        QByteArray footer; ///< Curves and document end
+        QString savedFileName; ///< Saved scene file unmodified curves are copied from
+        qint64 savedFileSize; ///< Size of the saved file when it was written
+        QDateTime savedFileModified; ///< Modification time of the saved file when it was written
+    };
+
+    /**
+     * @brief Scene to serialize into chunks, readable from any thread.
+     *
+     * Taking one costs a snapshot of the scene, the curves are serialized later
+     * with serializeChunks(const ChunkSource&), for example in a worker thread.
+     */
+    struct ChunkSource
+    {
+        std::shared_ptr<const SceneSnapshot> scene; ///< Scene data to serialize
+        bool packedKeys; ///< Save keys packed with CurveKeyCodec
+        QVector<CurveBlock> savedBlocks; ///< Block of each curve in the saved file, size 0 for modified curves
+        QString savedFileName; ///< Saved scene file unmodified curves are copied from
+        qint64 savedFileSize; ///< Size of the saved file when it was written
+        QDateTime savedFileModified; ///< Modification time of the saved file when it was written
+    };
+
+    /**
+     * @brief Take the scene state needed to serialize it into chunks.
+     * Must be called from the thread of the scene.
+     * @return Snapshot of the scene and its saved curve blocks
+     */
+    ChunkSource chunkSource() const;
+
+    /**
+     * @brief Serialize scene into chunks.
+     *
+     * Only curves modified since the scene was last saved are serialized. Unmodified curves
+     * refer to the saved file, which must not be replaced before the chunks are written.
+     *
+     * @return Serialized scene
+     */
+    Chunks serializeChunks() const;
+
+    /**
+     * @brief Serialize scene into chunks in any thread.
+     * @param source Scene taken with chunkSource()
+     * @return Serialized scene, @see serializeChunks()
+     */
+    static Chunks serializeChunks(const ChunkSource& source);
+
+    /**
+     * @brief Write serialized scene chunks to a device.
+     * @param chunks Serialized scene
+     * @param device Output device, written as is without text mode conversions
+     * @param curveBlocks [out] Optional location of each written curve in the device
+     * @return True if all data was written
+     */
+    static bool writeChunks(const Chunks& chunks, QIODevice& device, QVector<CurveBlock>* curveBlocks = nullptr);
+
+    /** Number of curve evaluations from which evaluate() spreads the curves to a thread pool */
+    static const int PARALLEL_EVALUATION_THRESHOLD = 16384;
+
+    /**
+     * @brief Evaluate all curves at a time.
+     *
+     * A spline cursor is kept for each curve between calls, so evaluating at slowly
+     * advancing times (playback) costs O(1) per curve.
+     * Not to be called concurrently or while curves are modified, evaluate a snapshot()
+     * in other threads instead.
+     *
+     * @param time Time
+     * @param out Output for one value per curve, in the order of curves()
+     */
+    void evaluate(float time, float* out) const;
+
+    /**
+     * @brief Evaluate all curves at several times.
+     * @param times Times, preferably in increasing order
+     * @param timeCount Number of times
+     * @param out Output for timeCount * curve count values. Value of curve c at time t is at out[t * curve count + c].
+     * @see evaluate(float, float*)
+     */
+    void evaluate(const float* times, int timeCount, float* out) const;
+
 signals:
     /** @brief A curve wad added to the scene. */
     void curveAdded(std::shared_ptr<CurveModelAbs> curve);
@@ -126,13 +287,13 @@ public slots:
 
     /**
      * @brief Serialize scene to xml.
-     * @param stream Xml output stream
+     * @param stream Xml output stream, a byte array output is sized up front from the number of keys
      */
     void serialize(QXmlStreamWriter& stream);
 
     /**
      * @brief Serialize scene curves to xml.
-     * @param stream Xml output stream
+     * @param stream Xml output stream, a byte array output is sized up front from the number of keys
      */
     void serializeCurves(QXmlStreamWriter& stream);
 
@@ -142,6 +303,23 @@ public slots:
      */
     void setFileName(const QString& fileName);
 
+    /**
+     * @brief Mark scene saved.
+     *
+     * Curve blocks let the next save copy unmodified curves from the saved file instead of
+     * serializing them again. Without them all curves are serialized on the next save.
+     *
+     * @param revision Revision that was saved (@see revision)
+     * @param curveBlocks Location of each curve in the saved file (@see writeChunks)
+     */
+    void setSaved(quint64 revision, const QVector<CurveBlock>& curveBlocks = QVector<CurveBlock>());
+
+    /**
+     * @brief Select how curve keys are saved. Exported curves are always plain xml.
+     * @param packed True to save keys packed with CurveKeyCodec, false for plain xml elements.
+     */
+    void setPackedKeys(bool packed);
+
 private slots:
     /**
      * @brief Notification of curve model selection change.
@@ -154,14 +332,21 @@ private slots:
     void curveSelectionChanged(bool status);
 
     /**
-     * @brief Notification of curve point being removed. Used to remove empty curves from the scene
+     * @brief Notification of curve points being removed, one or several at once. Used to remove
+     * empty curves from the scene
      *
      * Expected only from curves currently in the scene. Note: The curve sending this signal
      * is retrieved using QObject::sender().
+     */
+    void curvePointsRemoved();
+
+    /**
+     * @brief Notification of any curve change affecting its serialization. Marks the curve dirty.
      *
-     * @param point Remove point id (not used)
+     * Expected only from curves currently in the scene. Note: The curve sending this signal
+     * is retrieved using QObject::sender().
      */
-    void curvePointRemoved(PointId point);
+    void curveContentChanged();
 
 private:
     /** Curve containers */
@@ -171,6 +356,8 @@ private:
     /** Internal helpers */
     bool addCurveInternal(std::shared_ptr<CurveModelAbs> curve);
     bool removeCurveInternal(std::shared_ptr<CurveModelAbs> curve);
+    void markModified();
+    void clearPackedCurveBlocks();
 
     RangeF m_timeRange; /**< Scene time range */
 
@@ -181,6 +368,16 @@ private:
     std::shared_ptr<EditorModel> m_SelectedCurvesEditor; /**< Editor model containing selected curves */
 
     QString m_fileName; /**< File name associated with this scene */
+
+    quint64 m_revision; /**< Content revision, incremented on modification */
+    quint64 m_savedRevision; /**< Last saved revision */
+    QHash<const CurveModelAbs*, CurveBlock> m_savedCurveBlocks; /**< Blocks of curves unmodified since saving */
+    QString m_savedFileName; /**< File the saved curve blocks are in */
+    qint64 m_savedFileSize; /**< Size of the saved file when it was written */
+    QDateTime m_savedFileModified; /**< Modification time of the saved file when it was written */
+    bool m_packedKeys; /**< Save keys packed with CurveKeyCodec */
+    using SplineCursor = pt::math::spline_cursor<pt::math::kb_spline<float>>;
+    mutable QHash<const CurveModelAbs*, SplineCursor> m_evaluationCursors; /**< Spline cursor of each spline curve kept between evaluations */
 };
 
 #endif // SCENEMODEL_H
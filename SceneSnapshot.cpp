@@ -0,0 +1,41 @@
+#include "SceneSnapshot.h"
+
+SceneSnapshot::SceneSnapshot(quint64 revision, RangeF timeRange, double beatOffset, double bpm, const Curves& curves)
+  : m_revision(revision),
+    m_timeRange(timeRange),
+    m_beatOffset(beatOffset),
+    m_bpm(bpm),
+    m_curves(curves)
+{
+}
+
+quint64 SceneSnapshot::revision() const
+{
+    return m_revision;
+}
+
+RangeF SceneSnapshot::timeRange() const
+{
+    return m_timeRange;
+}
+
+double SceneSnapshot::beatOffset() const
+{
+    return m_beatOffset;
+}
+
+double SceneSnapshot::bpm() const
+{
+    return m_bpm;
+}
+
+const SceneSnapshot::Curves& SceneSnapshot::curves() const
+{
+    return m_curves;
+}
+
+void SceneSnapshot::evaluate(float time, float* out) const
+{
+    for (int i = 0; i < m_curves.size(); ++i)
+        out[i] = m_curves[i]->valueAt(time);
+}
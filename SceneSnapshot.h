@@ -0,0 +1,62 @@
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include "CurveSnapshot.h"
+#include "RangeF.h"
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Immutable copy of scene data, readable from any thread.
+ *
+ * Taken with SceneModel::snapshot() in the thread of the scene. Holds a snapshot
+ * of each curve, so taking one costs only a pointer per curve.
+ */
+class SceneSnapshot
+{
+public:
+    using Curves = QVector<std::shared_ptr<const CurveSnapshot>>;
+
+    /** @return Scene revision the snapshot was taken at, @see SceneModel::revision */
+    quint64 revision() const;
+
+    /** @return Scene time range */
+    RangeF timeRange() const;
+
+    /** @return Offset to first beat in seconds */
+    double beatOffset() const;
+    /** @return Rhythm in beats per minute */
+    double bpm() const;
+
+    /** @return Curve snapshots in the order of SceneModel::curves() */
+    const Curves& curves() const;
+
+    /**
+     * @brief Evaluate all curves at a time.
+     * @param time Time
+     * @param out Output for one value per curve, in the order of curves()
+     */
+    void evaluate(float time, float* out) const;
+
+private:
+    /** Snapshots are created by the scene */
+    friend class SceneModel;
+
+    /**
+     * @brief Construct SceneSnapshot
+     * @param revision Scene revision
+     * @param timeRange Scene time range
+     * @param beatOffset Scene beat offset
+     * @param bpm Scene bpm
+     * @param curves Curve snapshots
+     */
+    SceneSnapshot(quint64 revision, RangeF timeRange, double beatOffset, double bpm, const Curves& curves);
+
+    const quint64 m_revision;
+    const RangeF m_timeRange;
+    const double m_beatOffset;
+    const double m_bpm;
+    const Curves m_curves;
+};
+
+#endif // SCENESNAPSHOT_H
@@ -0,0 +1,188 @@
+#include "SplineTessellator.h"
+
+#include <cmath>
+#include <algorithm>
+
+constexpr float SplineTessellator::DEFAULT_TOLERANCE;
+
+SplineTessellator::SplineTessellator(float timeScale, float valueScale, float tolerance)
+  : m_timeScale(timeScale),
+    m_valueScale(valueScale),
+    m_tolerance(tolerance)
+{
+}
+
+float SplineTessellator::timeScale() const
+{
+    return m_timeScale;
+}
+
+float SplineTessellator::valueScale() const
+{
+    return m_valueScale;
+}
+
+void SplineTessellator::setScale(float timeScale, float valueScale)
+{
+    m_timeScale = timeScale;
+    m_valueScale = valueScale;
+}
+
+int SplineTessellator::steps(const Spline& spline, int segment) const
+{
+    return steps(spline.data().get(segment));
+}
+
+int SplineTessellator::steps(PointIterator segmentStart) const
+{
+    auto cur = segmentStart;
+    auto next = cur + 1;
+
+    // At most one line per horizontal pixel
+    const double width = (next->time() - cur->time()) * static_cast<double>(m_timeScale);
+    if (!(width > 1.0))
+        return 1;
+
+    // Segment as a cubic Bezier in value, time is linear in the curve parameter
+    const double b0 = cur->value();
+    const double b1 = cur->value() + cur->starting_tangent() / 3.0;
+    const double b2 = next->value() - next->ending_tangent() / 3.0;
+    const double b3 = next->value();
+
+    // Distance between n uniform lines and a Bezier is at most max|B''| / (8 n^2),
+    // where max|B''| = 6 * max(|b0 - 2 b1 + b2|, |b1 - 2 b2 + b3|).
+    const double curvature = std::max(std::fabs(b0 - 2.0 * b1 + b2), std::fabs(b1 - 2.0 * b2 + b3));
+    const double pixelCurvature = curvature * std::fabs(m_valueScale);
+    const double steps = std::ceil(std::sqrt(0.75 * pixelCurvature / m_tolerance));
+
+    const double maxSteps = std::min(std::ceil(width), static_cast<double>(MAX_STEPS_PER_SEGMENT));
+    return static_cast<int>(std::max(1.0, std::min(steps, maxSteps)));
+}
+
+QPolygonF SplineTessellator::tessellateSegment(const Spline& spline, int segment) const
+{
+    return tessellateSegment(spline.data().get(segment));
+}
+
+QPolygonF SplineTessellator::tessellateSegment(PointIterator segmentStart) const
+{
+    auto cur = segmentStart;
+    auto next = cur + 1;
+
+    const int stepCount = steps(cur);
+    const float startTime = cur->time();
+    const float step = (next->time() - startTime) / stepCount;
+
+    QPolygonF lines;
+    lines.reserve(stepCount);
+
+    // Interior points, the interval is known so no need to search it
+    for (int i = 1; i < stepCount; ++i)
+    {
+        const float time = startTime + i * step;
+        lines.append(QPointF(time, Spline::interpolate(cur, next, time)));
+    }
+
+    // End the segment exactly at the next point
+    lines.append(QPointF(next->time(), next->value()));
+    return lines;
+}
+
+QPolygonF SplineTessellator::tessellate(const Spline& spline) const
+{
+    QPolygonF lines;
+    if (spline.data().size() == 0)
+        return lines;
+
+    auto first = spline.data().begin();
+    lines.append(QPointF(first->time(), first->value()));
+
+    const int segmentCount = static_cast<int>(spline.data().size()) - 1;
+    for (int i = 0; i < segmentCount; ++i)
+        lines += tessellateSegment(spline, i);
+
+    return lines;
+}
+
+RangeF SplineTessellator::envelope(const Spline& spline, float start, float end)
+{
+    const auto& data = spline.data();
+    if (data.size() == 0)
+        return RangeF();
+
+    // Curve is drawn from the first to the last point
+    auto first = data.begin();
+    auto last = data.end() - 1;
+    start = std::max(start, first->time());
+    end = std::min(end, last->time());
+    if (start > end)
+        return RangeF();
+
+    if (first == last)
+        return RangeF(first->value(), first->value());
+
+    // Segment containing range start
+    auto compareTime = [](float time, const pt::math::kb_data_set<float>::point& point) { return time < point.time(); };
+    auto cur = std::upper_bound(first, last, start, compareTime) - 1;
+
+    RangeF range;
+    auto include = [&range](float value) { range = RangeF::makeUnion(range, RangeF(value, value)); };
+
+    for (; cur != last && cur->time() <= end; ++cur)
+    {
+        auto next = cur + 1;
+        const double h = next->time() - cur->time();
+        if (!(h > 0.0))
+        {
+            include(next->value());
+            continue;
+        }
+
+        // Clip range to the segment in curve parameter [0, 1]
+        const double t0 = std::max(0.0, (start - cur->time()) / h);
+        const double t1 = std::min(1.0, (end - cur->time()) / h);
+
+        const double p0 = cur->value();
+        const double p1 = next->value();
+        const double m0 = cur->starting_tangent();
+        const double m1 = next->ending_tangent();
+        auto value = [=](double t)
+        {
+            const double t2 = t * t;
+            const double t3 = t2 * t;
+            return (2.0 * t3 - 3.0 * t2 + 1.0) * p0 + (t3 - 2.0 * t2 + t) * m0
+                + (-2.0 * t3 + 3.0 * t2) * p1 + (t3 - t2) * m1;
+        };
+
+        include(static_cast<float>(value(t0)));
+        include(static_cast<float>(value(t1)));
+
+        // Extrema where derivative a t^2 + b t + c is zero
+        const double a = 6.0 * p0 + 3.0 * m0 - 6.0 * p1 + 3.0 * m1;
+        const double b = -6.0 * p0 - 4.0 * m0 + 6.0 * p1 - 2.0 * m1;
+        const double c = m0;
+        double roots[2];
+        int rootCount = 0;
+        if (std::fabs(a) < 1e-12)
+        {
+            if (std::fabs(b) > 1e-12)
+                roots[rootCount++] = -c / b;
+        }
+        else
+        {
+            const double discriminant = b * b - 4.0 * a * c;
+            if (discriminant >= 0.0)
+            {
+                const double root = std::sqrt(discriminant);
+                roots[rootCount++] = (-b - root) / (2.0 * a);
+                roots[rootCount++] = (-b + root) / (2.0 * a);
+            }
+        }
+
+        for (int i = 0; i < rootCount; ++i)
+            if (roots[i] > t0 && roots[i] < t1)
+                include(static_cast<float>(value(roots[i])));
+    }
+
+    return range;
+}
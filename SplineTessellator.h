@@ -0,0 +1,104 @@
+#ifndef SPLINETESSELLATOR_H
+#define SPLINETESSELLATOR_H
+
+#include "RangeF.h"
+#include "pt/math/kb_spline.h"
+#include <QPolygonF>
+
+/**
+ * @brief Approximates spline segments with line strips for drawing.
+ *
+ * The number of lines per segment adapts to the on-screen size and curvature
+ * of the segment: a segment is split so that the distance between the lines
+ * and the curve stays within the given tolerance in pixels. A segment gets
+ * at most one line per horizontal pixel it covers. Vertex count thus follows
+ * the pixels the curve covers instead of the number of keys.
+ *
+ * Segment i spans spline points i and i + 1.
+ */
+class SplineTessellator
+{
+public:
+    using Spline = pt::math::kb_spline<float>;
+    /** Iterator to spline points. Also iterates a std::vector copy of spline points. */
+    using PointIterator = Spline::const_iterator;
+
+    /** Default maximum distance between the lines and the curve in pixels */
+    static constexpr float DEFAULT_TOLERANCE = 0.25f;
+    /** Upper limit for lines per segment */
+    static const int MAX_STEPS_PER_SEGMENT = 4096;
+
+    /**
+     * @brief Construct SplineTessellator
+     * @param timeScale Pixels per time unit
+     * @param valueScale Pixels per value unit
+     * @param tolerance Maximum distance between the lines and the curve in pixels
+     */
+    SplineTessellator(float timeScale = 1.0f, float valueScale = 1.0f, float tolerance = DEFAULT_TOLERANCE);
+
+    /** @return Pixels per time unit */
+    float timeScale() const;
+    /** @return Pixels per value unit */
+    float valueScale() const;
+
+    /**
+     * @brief Set on-screen scale.
+     * @param timeScale Pixels per time unit
+     * @param valueScale Pixels per value unit
+     */
+    void setScale(float timeScale, float valueScale);
+
+    /**
+     * @brief Number of lines needed for a segment.
+     * @param spline The spline
+     * @param segment Segment index
+     * @return Number of lines, at least one
+     */
+    int steps(const Spline& spline, int segment) const;
+
+    /**
+     * @brief Number of lines needed for a segment.
+     * @param segmentStart First point of the segment, followed by the last point
+     * @return Number of lines, at least one
+     */
+    int steps(PointIterator segmentStart) const;
+
+    /**
+     * @brief Tessellate a segment.
+     * @param spline The spline
+     * @param segment Segment index
+     * @return Line strip vertices excluding the start point of the segment, which is the end point of the previous one.
+     */
+    QPolygonF tessellateSegment(const Spline& spline, int segment) const;
+
+    /**
+     * @brief Tessellate a segment.
+     * @param segmentStart First point of the segment, followed by the last point
+     * @return Line strip vertices excluding the start point of the segment.
+     */
+    QPolygonF tessellateSegment(PointIterator segmentStart) const;
+
+    /**
+     * @brief Tessellate whole spline.
+     * @param spline The spline
+     * @return Line strip vertices
+     */
+    QPolygonF tessellate(const Spline& spline) const;
+
+    /**
+     * @brief Value range of a spline within a time range.
+     * @param spline The spline
+     * @param start Range start
+     * @param end Range end
+     * @return Exact minimum and maximum including extrema between points,
+     * invalid if the range does not overlap the spline.
+     */
+    static RangeF envelope(const Spline& spline, float start, float end);
+
+private:
+    float m_timeScale;
+    float m_valueScale;
+    float m_tolerance;
+};
+
+#endif // SPLINETESSELLATOR_H
@@ -1,4 +1,5 @@
 #include "StepCurveModel.h"
+#include <algorithm>
 #include <assert.h>
 #include <utility>
 #include <QDebug>
@@ -29,6 +30,7 @@ void StepCurveModel::setOptions(const Options& newOptions)
         return;
 
     m_options = newOptions;
+    markChanged();
     int previousValue = m_options.firstKey();
 
     // Ensure all points fit map to a valid option, if not, change to previous value
@@ -44,6 +46,46 @@ void StepCurveModel::setOptions(const Options& newOptions)
     emit optionsChanged(m_options);
 }
 
+float StepCurveModel::valueAt(float time) const
+{
+    // Points at time and the ones right before and after it
+    bool found = false;
+    float value = 0.0f;
+    forEachPointInRange(RangeF(time, time), 1, [time, &found, &value](const Point& p)
+    {
+        if (!found || p.time() <= time)
+            value = p.value().toFloat();
+        found = true;
+    });
+    return value;
+}
+
+void StepCurveModel::sample(RangeF range, int count, float* out) const
+{
+    if (count <= 0)
+        return;
+
+    // Hold the latest point value, first point value before it
+    const QList<Point> points = pointsInRange(range, 1);
+    if (points.isEmpty())
+    {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    const float step = count > 1 ? (range.max - range.min) / (count - 1) : 0.0f;
+    int next = 0;
+    float value = points.first().value().toFloat();
+    for (int i = 0; i < count; ++i)
+    {
+        const float time = range.min + static_cast<float>(i) * step;
+        while (next < points.size() && points[next].time() <= time)
+            value = points[next++].value().toFloat();
+
+        out[i] = value;
+    }
+}
+
 StepCurveModel* StepCurveModel::getAsStepCurve()
 {
     return this;
@@ -76,6 +118,11 @@ void StepCurveModel::removePointInternal(PointId id)
     Q_UNUSED(id)
 }
 
+CurveSnapshot::Options StepCurveModel::snapshotOptions() const
+{
+    return m_options;
+}
+
 QVariant StepCurveModel::limitValueToRange(const QVariant& value) const
 {
     bool ok;
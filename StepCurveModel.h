@@ -27,6 +27,11 @@ public:
     /** @return Possible value options */
     Options options() const;
 
+    /** @see CurveModelAbs::valueAt. Value of the latest point at or before time, first point value before it. */
+    virtual float valueAt(float time) const override;
+    /** @see CurveModelAbs::sample */
+    virtual void sample(RangeF range, int count, float* out) const override;
+
 signals:
     /** @brief Possible value options changed. */
     void optionsChanged(const Options& newOptions);
@@ -50,6 +55,8 @@ private:
 
     /** @see CurveModelAbs::limitValueToRange */
     virtual QVariant limitValueToRange(const QVariant& value) const override;
+    /** @see CurveModelAbs::snapshotOptions */
+    virtual CurveSnapshot::Options snapshotOptions() const override;
 
     Options m_options;
 };
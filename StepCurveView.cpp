@@ -1,6 +1,5 @@
 #include "StepCurveView.h"
-#include "PointView.h"
-#include <QGraphicsPathItem>
+#include "CurvePathItem.h"
 #include <QDebug>
 #include <QPen>
 #include <assert.h>
@@ -9,7 +8,7 @@ StepCurveView::StepCurveView(std::shared_ptr<StepCurveModel> model, QGraphicsIte
 :   CurveViewAbs(model, parent),
     m_model(model)
 {
-    m_curveView = new QGraphicsPathItem(this);
+    m_curveView = new CurvePathItem(this);
     connect(m_model.get(), &StepCurveModel::optionsChanged, this, &StepCurveView::updateOptions);
 
     updateTransformation();
@@ -34,29 +33,46 @@ void StepCurveView::updateOptions(StepCurveModel::Options options)
 
 bool StepCurveView::internalAddPoint(PointId id)
 {
-    Q_UNUSED(id)
+    const float time = m_model->point(id).time();
+    m_pointTimes.insert(id, time);
+    invalidateHold(time);
     return true;
 }
 
 bool StepCurveView::internalUpdatePoint(PointId id)
 {
-    Q_UNUSED(id)
+    const float oldTime = m_pointTimes.value(id);
+    const float newTime = m_model->point(id).time();
+    m_pointTimes.insert(id, newTime);
+
+    // Both the hold left behind and the new hold change
+    invalidateHold(oldTime);
+    invalidateHold(newTime);
     return true;
 }
 
 bool StepCurveView::internalRemovePoint(PointId id)
 {
-    Q_UNUSED(id)
+    // Previous point holds over the removed point
+    invalidateHold(m_pointTimes.take(id));
     return true;
 }
 
-std::pair<float, QVariant> StepCurveView::placeNewPoint(PointId id, PointId nextId) const
+void StepCurveView::invalidateHold(float time)
 {
-    const Point point = m_model->point(id);
+    // Last one of the points around time is the next point after it, if any
+    float endTime = time;
+    m_model->forEachPointInRange(RangeF(time, time), 1, [&endTime](const Point& point) { endTime = qMax(endTime, point.time()); });
+    invalidateEnvelope(RangeF(time, endTime));
+}
+
+std::pair<float, QVariant> StepCurveView::placeNewPoint(const CurveSnapshot& curve, PointId id, PointId nextId) const
+{
+    const Point point = curve.point(id);
 
     if (nextId.isValid())
     {
-        const Point nextPoint = m_model->point(nextId);
+        const Point nextPoint = curve.point(nextId);
         float insertTime = (point.time() + nextPoint.time()) / 2.0f;
         return std::make_pair(insertTime, point.value());
     }
@@ -65,6 +81,31 @@ std::pair<float, QVariant> StepCurveView::placeNewPoint(PointId id, PointId next
     return std::make_pair(point.time() + 1.0, point.value());
 }
 
+RangeF StepCurveView::valueEnvelope(float start, float end) const
+{
+    // Value held at range start and values of points within the range.
+    // Curve ends at the last point, nothing is held after it.
+    RangeF range;
+    RangeF held;
+    bool continues = false;
+    m_model->forEachPointInRange(RangeF(start, end), 1, [&](const Point& point)
+    {
+        const float value = point.value().toInt();
+        if (point.time() < start)
+        {
+            held = RangeF(value, value);
+        }
+        else
+        {
+            continues = true;
+            if (point.time() <= end)
+                range = RangeF::makeUnion(range, RangeF(value, value));
+        }
+    });
+
+    return continues ? RangeF::makeUnion(range, held) : range;
+}
+
 void StepCurveView::updateCurves()
 {
     QPen curvePen(Qt::blue);
@@ -76,44 +117,52 @@ void StepCurveView::updateCurves()
         curvePen.setColor(curvePen.color().darker(100));
     }
 
-    QList<PointId> ids = m_model->pointIds();
-    if (ids.isEmpty())
+    const QPolygonF envelopeLines = levelOfDetailLines();
+    if (!envelopeLines.isEmpty())
     {
-        // No points
-        m_curveView->setPath(QPainterPath());
+        // Points are denser than pixels, draw value envelope instead of individual steps
+        QPainterPath path;
+        path.addPolygon(envelopeLines);
+        m_curveView->setPen(curvePen);
+        m_curveView->setPath(path);
         return;
     }
 
-//    const QList<int> optionKeys = m_model->options().keys();
-
-    auto cur = ids.begin();
+    const QPolygonF lines = stepLines(*m_model, renderTimeRange());
 
-    // Start by moving to the first point
     QPainterPath path;
-    Point currentPoint = m_model->point(*cur);
-    path.moveTo(QPointF(currentPoint.time(), currentPoint.value().toInt()));
-
-    auto next = cur + 1;
-    while (next != ids.end())
-    {
-        const Point nextPoint = m_model->point(*next);
-        const float endTime = nextPoint.time();
-
-        // Draw horizontal line to from current point to next point time
-        path.lineTo(QPointF(endTime, currentPoint.value().toInt()));
-        // Draw vertical line from current point value to next point value at next point time
-        path.lineTo(QPointF(endTime, nextPoint.value().toInt()));
-
-        // Move to next point
-        currentPoint = nextPoint;
-        ++cur;
-        ++next;
-    }
-
+    path.addPolygon(lines);
     m_curveView->setPen(curvePen);
     m_curveView->setPath(path);
 }
 
+QPolygonF StepCurveView::stepLines(const CurveModelAbs& model, RangeF timeRange)
+{
+    // Points within the range and one on both sides to draw lines crossing the range edges
+    QPolygonF lines;
+    bool first = true;
+    int value = 0;
+    model.forEachPointInRange(timeRange, 1, [&](const Point& point)
+    {
+        if (first)
+        {
+            // Start from the first point
+            first = false;
+        }
+        else
+        {
+            // Draw horizontal line from the previous point to this point time
+            lines.append(QPointF(point.time(), value));
+        }
+
+        // Draw vertical line from the previous value to this point value, or start from the first point
+        value = point.value().toInt();
+        lines.append(QPointF(point.time(), value));
+    });
+
+    return lines;
+}
+
 void StepCurveView::updateTransformation()
 {
     // Set transformation
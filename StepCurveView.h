@@ -3,12 +3,11 @@
 
 #include "CurveViewAbs.h"
 #include "StepCurveModel.h"
+#include <QHash>
 #include <QObject>
 #include <memory>
 
-QT_BEGIN_NAMESPACE
-class QGraphicsPathItem;
-QT_END_NAMESPACE
+class CurvePathItem;
 
 /**
  * View for a step curve.
@@ -36,6 +35,14 @@ public:
      */
     static StepCurveView* create(std::shared_ptr<StepCurveModel> model, QGraphicsItem* parent);
 
+    /**
+     * @brief Lines of a step curve, built in a single ordered pass over the model points.
+     * @param model Step curve model
+     * @param timeRange Time range to draw, lines crossing the range edges are included
+     * @return Line strip vertices, empty if there are no points
+     */
+    static QPolygonF stepLines(const CurveModelAbs& model, RangeF timeRange);
+
 private slots:
     void updateOptions(StepCurveModel::Options options);
 
@@ -44,13 +51,20 @@ private:
     virtual bool internalUpdatePoint(PointId id) override;
     virtual bool internalRemovePoint(PointId id) override;
 
-    virtual std::pair<float, QVariant> placeNewPoint(PointId id, PointId nextId) const override;
+    virtual std::pair<float, QVariant> placeNewPoint(const CurveSnapshot& curve, PointId id, PointId nextId) const override;
 
+    virtual RangeF valueEnvelope(float start, float end) const override;
     virtual void updateCurves() override;
     void updateTransformation();
 
+    /** Update envelope for the time a point value is held, from the given time until the next point */
+    void invalidateHold(float time);
+
     std::shared_ptr<StepCurveModel> m_model;
-    QGraphicsPathItem* m_curveView;
+    CurvePathItem* m_curveView;
+
+    /** Point times as last seen, to know where a point moved or was removed from */
+    QHash<PointId, float> m_pointTimes;
 };
 
 #endif // STEPCURVEVIEW_H
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui
+QT += core gui concurrent
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = curveeditor
@@ -21,13 +21,8 @@ SOURCES += \
     CurveView.cpp \
     EditorModel.cpp \
     EditorView.cpp \
-    GraphicsItem.cpp \
-    GraphicsItemDelegate.cpp \
-    GraphicsItemEvent.cpp \
     main.cpp \
     MainWindow.cpp \
-    PointItem.cpp \
-    PointView.cpp \
     RangeF.cpp \
     ScaleView.cpp \
     ScrollPositionKeeper.cpp \
@@ -44,18 +39,25 @@ SOURCES += \
     CurveViewAbs.cpp \
     StepCurveModel.cpp \
     StepCurveView.cpp \
+    SceneLoader.cpp \
+    SceneAutosaver.cpp \
+    CurveKeyCodec.cpp \
+    SceneBaker.cpp \
+    SplineTessellator.cpp \
+    MinMaxPyramid.cpp \
+    PointHandleLayer.cpp \
+    RedrawScheduler.cpp \
+    CurvePathItem.cpp \
+    CurveGeometry.cpp \
+    CurveSnapshot.cpp \
+    SceneSnapshot.cpp \
 
 HEADERS  += \
     CurveModel.h \
     CurveView.h \
     EditorModel.h \
     EditorView.h \
-    GraphicsItem.h \
-    GraphicsItemDelegate.h \
-    GraphicsItemEvent.h \
     MainWindow.h \
-    PointItem.h \
-    PointView.h \
     RangeF.h \
     ScaleView.h \
     ScrollPositionKeeper.h \
@@ -63,6 +65,7 @@ HEADERS  += \
     pt/math/cubic_hermite_spline.h \
     pt/math/kb_data_set.h \
     pt/math/kb_spline.h \
+    pt/math/spline_cursor.h \
     SceneModel.h \
     ScenePropertiesWidget.h \
     PointId.h \
@@ -74,3 +77,15 @@ HEADERS  += \
     CurveViewAbs.h \
     StepCurveModel.h \
     StepCurveView.h \
+    SceneLoader.h \
+    SceneAutosaver.h \
+    CurveKeyCodec.h \
+    SceneBaker.h \
+    SplineTessellator.h \
+    MinMaxPyramid.h \
+    PointHandleLayer.h \
+    RedrawScheduler.h \
+    CurvePathItem.h \
+    CurveGeometry.h \
+    CurveSnapshot.h \
+    SceneSnapshot.h \
@@ -1,13 +1,18 @@
 #ifndef PT_MATH_CUBIC_HERMITE_SPLINE_H
 #define PT_MATH_CUBIC_HERMITE_SPLINE_H
 
+#include <cassert>
+#include <cstddef>
+
 namespace pt { namespace math {
 
 template<typename DataSet>
 class cubic_hermite_spline
 {
 public:
+    typedef DataSet data_set;
     typedef typename DataSet::result_type result_type;
+    typedef typename DataSet::const_iterator const_iterator;
 
 public:
     cubic_hermite_spline();
@@ -17,6 +22,21 @@ public:
         return *this;
     }
     result_type value_at(float time) const;
+
+    /**
+     * Evaluate spline at evenly spaced times start_time + i * step, i = 0..count-1.
+     * Intervals are walked forward instead of searched separately for each sample.
+     * Results equal to value_at. Step must not be negative.
+     */
+    template<typename OutputIterator>
+    void sample(float start_time, float step, size_t count, OutputIterator out) const;
+
+    /**
+     * Evaluate spline within a known interval, first->time() < time < second->time().
+     * Skips the interval search of value_at.
+     */
+    static result_type interpolate(const_iterator first, const_iterator second, float time);
+
     DataSet& data()
     {
     	return m_data;
@@ -26,24 +26,7 @@ inline typename cubic_hermite_spline<DataSet>::result_type
             return points.first->value();
         }
 
-        float p0 = points.first->value();
-        float p1 = points.second->value();
-        float t0 = points.first->starting_tangent();
-        float t1 = points.second->ending_tangent();
-
-        float h = points.second->time() - points.first->time();
-        float t = (time - points.first->time()) / h;
-        float t2 = t * t;
-        float t3 = t * t * t;
-
-        float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
-        float h10 = t3 - 2.0f * t2 + t;
-        float h01 = -2.0f * t3 + 3.0f * t2;
-        float h11 = t3 - t2;
-
-        float p = h00 * p0 + h10 * t0 + h01 * p1 + h11 * t1;
-
-        return  p;
+        return interpolate(points.first, points.second, time);
     }
     else
     {
@@ -51,6 +34,74 @@ inline typename cubic_hermite_spline<DataSet>::result_type
     }
 }
 
+template<typename DataSet>
+template<typename OutputIterator>
+inline void cubic_hermite_spline<DataSet>::sample(float start_time, float step,
+    size_t count, OutputIterator out) const
+{
+    assert(m_data.size() > 0);
+    assert(step >= 0.0f);
+
+    const_iterator first = m_data.begin();
+    const_iterator last = m_data.end() - 1;
+    const_iterator current = first;
+
+    for (size_t i = 0; i < count; ++i, ++out)
+    {
+        float time = start_time + static_cast<float>(i) * step;
+
+        if (time <= first->time())
+        {
+            *out = first->value();
+            continue;
+        }
+        if (time >= last->time())
+        {
+            *out = last->value();
+            continue;
+        }
+
+        // Advance to the last point before time, same interval as get_interval would find
+        while ((current + 1)->time() < time)
+            ++current;
+
+        const_iterator next = current + 1;
+        if (next->time() == time)
+        {
+            // exact match.
+            *out = next->value();
+            continue;
+        }
+
+        *out = interpolate(current, next, time);
+    }
+}
+
+template<typename DataSet>
+inline typename cubic_hermite_spline<DataSet>::result_type
+    cubic_hermite_spline<DataSet>::interpolate(const_iterator first,
+        const_iterator second, float time)
+{
+    float p0 = first->value();
+    float p1 = second->value();
+    float t0 = first->starting_tangent();
+    float t1 = second->ending_tangent();
+
+    float h = second->time() - first->time();
+    float t = (time - first->time()) / h;
+    float t2 = t * t;
+    float t3 = t * t * t;
+
+    float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+    float h10 = t3 - 2.0f * t2 + t;
+    float h01 = -2.0f * t3 + 3.0f * t2;
+    float h11 = t3 - t2;
+
+    float p = h00 * p0 + h10 * t0 + h01 * p1 + h11 * t1;
+
+    return  p;
+}
+
 }} // namespace pt::math
 
 #endif
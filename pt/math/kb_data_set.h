@@ -1,7 +1,10 @@
 #ifndef PT_MATH_KB_DATA_SET_H
 #define PT_MATH_KB_DATA_SET_H
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
+#include <vector>
 #include "../../PointId.h"
 
 namespace pt { namespace math {
@@ -88,9 +91,16 @@ public:
     point_pair points_at(float time) const;
 
     iterator get_point(PointId id);
+    /** Find a point with a known time. Binary search instead of the linear get_point. */
+    iterator find(PointId id, float time);
 
     iterator add(point const& p);
     iterator erase(iterator pos);
+    /**
+     * Replace a point. Updated in place when the new point keeps the order,
+     * otherwise moved to its place. Returns iterator to the new point.
+     */
+    iterator replace(iterator pos, point const& p);
     
     const_iterator begin() const
     {
@@ -124,6 +134,8 @@ private: // private helpers
     void update(iterator point);
     
 	iterator add_point(point const& point);
+    /** Order of points, primarily by time and secondarily by value */
+    static bool is_before(point const& a, point const& b);
     
 private: // data members
     std::vector<point> m_points;
@@ -306,6 +318,21 @@ inline typename kb_data_set<T>::iterator
     return it;
 }
 
+template<typename T>
+inline typename kb_data_set<T>::iterator
+    kb_data_set<T>::find(PointId id, float time)
+{
+    auto compare_time = [](point const& p, float t) { return p.time() < t; };
+    auto it = std::lower_bound(m_points.begin(), m_points.end(), time, compare_time);
+    for (; it != m_points.end() && it->time() == time; ++it)
+    {
+        if (it->id() == id)
+            return it;
+    }
+
+    return m_points.end();
+}
+
 template<typename T>
 typename kb_data_set<T>::iterator kb_data_set<T>::add(point const& p)
 {
@@ -331,28 +358,23 @@ typename kb_data_set<T>::iterator kb_data_set<T>::add(point const& p)
 template<typename T>
 typename kb_data_set<T>::iterator kb_data_set<T>::add_point(point const& point)
 {
-    iterator i = m_points.begin();
-    while (i != m_points.end())
+    // Fast path for points added in order
+    if (m_points.empty() || m_points.back().time() < point.time()
+        || (m_points.back().time() == point.time() && m_points.back().value() < point.value()))
     {
-        if (i->time() < point.time())
-        {
-            // Order primarily based on time
-            ++i;
-            continue;
-        }
-        else if (i->time() == point.time() && i->value() < point.value())
-        {
-            // Order secondarily based on value
-            ++i;
-            continue;
-        }
-
-        break;
+        return m_points.insert(m_points.end(), point);
     }
 
+    iterator i = std::lower_bound(m_points.begin(), m_points.end(), point, &kb_data_set<T>::is_before);
     return m_points.insert(i, point);
 }
 
+template<typename T>
+inline bool kb_data_set<T>::is_before(point const& a, point const& b)
+{
+    return a.time() < b.time() || (a.time() == b.time() && a.value() < b.value());
+}
+
     
 template<typename T>
 typename kb_data_set<T>::iterator kb_data_set<T>::erase(kb_data_set<T>::iterator pos)
@@ -371,6 +393,34 @@ typename kb_data_set<T>::iterator kb_data_set<T>::erase(kb_data_set<T>::iterator
     return next;
 }
 
+template<typename T>
+typename kb_data_set<T>::iterator kb_data_set<T>::replace(iterator pos, point const& p)
+{
+    if (pos == m_points.end())
+        return m_points.end();
+
+    const bool after_prev = pos == m_points.begin() || !is_before(p, *(pos - 1));
+    const bool before_next = pos + 1 == m_points.end() || !is_before(*(pos + 1), p);
+    if (!after_prev || !before_next)
+    {
+        erase(pos);
+        return add(p);
+    }
+
+    // Same place, only tangents around the point change
+    *pos = p;
+
+    if (pos != m_points.begin())
+        update(pos - 1);
+
+    update(pos);
+
+    if (pos + 1 != m_points.end())
+        update(pos + 1);
+
+    return pos;
+}
+
 template<typename DataSet>
 inline typename DataSet::const_iterator get_optional_endpoint(float time,
     DataSet const& data)
@@ -397,34 +447,28 @@ typename DataSet::point_pair get_interval(float time, DataSet const& data)
 {
     assert(data.size() > 0);
 
-    typename DataSet::const_iterator current = data.begin();
-    typename DataSet::const_iterator next = current + 1;
+    // Binary search for the first point after time
+    typedef typename DataSet::const_iterator const_iterator;
+    typedef typename DataSet::point point;
+    const_iterator next = std::upper_bound(data.begin(), data.end(), time,
+        [](float t, point const& p) { return t < p.time(); });
 
-    assert(current != data.end());
-
-    if (time < current->time())
+    if (next == data.begin())
         return typename DataSet::point_pair(data.end(), data.end());
 
-    while (next != data.end())
+    const_iterator current = next - 1;
+    if (current->time() == time)
     {
-        if (current->time() == time)
-        {
-            // Exact match for key.
-            next = data.end();
-            return typename DataSet::point_pair(current, next);
-        }
-
-        if (current->time() < time && time < next->time())
-            return typename DataSet::point_pair(current, next);
-
-        ++current;
-        ++next;
+        // Exact match for key. First of the points sharing the time.
+        current = std::lower_bound(data.begin(), current, time,
+            [](point const& p, float t) { return p.time() < t; });
+        return typename DataSet::point_pair(current, data.end());
     }
 
-    if (time == current->time())
-        return typename DataSet::point_pair(current, next);
+    if (next == data.end())
+        return typename DataSet::point_pair(data.end(), data.end());
 
-    return typename DataSet::point_pair(data.end(), data.end());
+    return typename DataSet::point_pair(current, next);
 }
 
 }} // namespace pt::math
@@ -0,0 +1,138 @@
+#ifndef PT_MATH_SPLINE_CURSOR_H
+#define PT_MATH_SPLINE_CURSOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace pt { namespace math {
+
+/**
+ * Evaluates a spline at nearby times one after another, as in playback.
+ *
+ * Remembers the interval of the previous evaluation and steps a few intervals
+ * forward or backward from it, falling back to a binary search for seeks.
+ * Sequential evaluation thus costs O(1) per sample. Results equal to value_at.
+ *
+ * The spline may change between evaluations; the previous interval is only
+ * a starting point for the search.
+ */
+template<typename Spline>
+class spline_cursor
+{
+public:
+    typedef typename Spline::result_type result_type;
+    typedef typename Spline::const_iterator const_iterator;
+
+    /** Intervals stepped from the previous one before searching */
+    static const size_t max_steps = 4;
+
+public:
+    spline_cursor();
+    explicit spline_cursor(Spline const& spline);
+
+    Spline const* spline() const
+    {
+        return m_spline;
+    }
+
+    /** Evaluate spline at time. Spline must have points. */
+    result_type value_at(float time);
+
+    /** Forget the previous interval */
+    void reset();
+
+private: // private helpers
+    /** Search interval start for time, first->time() < time <= last->time() */
+    size_t find_interval(float time, const_iterator first, const_iterator last) const;
+
+private: // data members
+    Spline const* m_spline;
+    size_t m_index; ///< Start point of the previous interval
+};
+
+// .inl
+
+template<typename Spline>
+inline spline_cursor<Spline>::spline_cursor()
+:   m_spline(nullptr)
+,   m_index(0)
+{
+}
+
+template<typename Spline>
+inline spline_cursor<Spline>::spline_cursor(Spline const& spline)
+:   m_spline(&spline)
+,   m_index(0)
+{
+}
+
+template<typename Spline>
+inline void spline_cursor<Spline>::reset()
+{
+    m_index = 0;
+}
+
+template<typename Spline>
+inline typename spline_cursor<Spline>::result_type
+    spline_cursor<Spline>::value_at(float time)
+{
+    assert(m_spline);
+    assert(m_spline->data().size() > 0);
+
+    const_iterator first = m_spline->data().begin();
+    const_iterator last = m_spline->data().end() - 1;
+
+    // End points as in value_at
+    if (time <= first->time())
+        return first->value();
+    if (time >= last->time())
+        return last->value();
+
+    m_index = find_interval(time, first, last);
+
+    const_iterator current = first + m_index;
+    const_iterator next = current + 1;
+    if (next->time() == time)
+    {
+        // exact match, first of the points at time.
+        return next->value();
+    }
+
+    return Spline::interpolate(current, next, time);
+}
+
+template<typename Spline>
+inline size_t spline_cursor<Spline>::find_interval(float time,
+    const_iterator first, const_iterator last) const
+{
+    // Previous interval might not exist anymore
+    const size_t last_interval = static_cast<size_t>(last - first) - 1;
+    size_t index = std::min(m_index, last_interval);
+
+    for (size_t steps = 0; steps < max_steps; ++steps)
+    {
+        const_iterator current = first + index;
+        if (current->time() >= time)
+        {
+            --index; // never before first, as first->time() < time
+            continue;
+        }
+        if ((current + 1)->time() < time)
+        {
+            ++index; // never past last, as time < last->time()
+            continue;
+        }
+
+        return index;
+    }
+
+    // Seek, last point before time
+    const_iterator next = std::lower_bound(first, last, time,
+        [](typename Spline::data_set::point const& p, float t) { return p.time() < t; });
+    return static_cast<size_t>(next - first) - 1;
+}
+
+}} // namespace pt::math
+
+#endif
@@ -29,12 +29,43 @@ public slots:
         ++updatedCount;
     }
     
+    void pointsUpdated(QList<PointId> ids)
+    {
+        lastBatchUpdated = ids;
+        ++batchUpdatedCount;
+    }
+
+    void pointsAdded(QList<PointId> ids)
+    {
+        lastBatchAdded = ids;
+        ++batchAddedCount;
+    }
+
     void pointRemoved(PointId id)
     {
         lastRemoved = id;
         ++removedCount;
     }
 
+    void pointsRemoved(QList<PointId> ids)
+    {
+        lastBatchRemoved = ids;
+        ++batchRemovedCount;
+    }
+
+    void pointDeselected(PointId id)
+    {
+        Q_UNUSED(id);
+        ++deselectedCount;
+    }
+
+    void pointsSelectedChanged(QList<PointId> ids, bool isSelected)
+    {
+        lastBatchSelected = ids;
+        lastBatchSelectedStatus = isSelected;
+        ++batchSelectedCount;
+    }
+
     void timeRangeChanged(RangeF newRange)
     {
         lastTimeRange = newRange;
@@ -56,10 +87,20 @@ public slots:
 public:
     PointId lastAdded;
     int addedCount;
+    QList<PointId> lastBatchAdded;
+    int batchAddedCount;
 	PointId lastUpdated;
     int updatedCount;
+    QList<PointId> lastBatchUpdated;
+    int batchUpdatedCount;
 	PointId lastRemoved;
     int removedCount;
+    QList<PointId> lastBatchRemoved;
+    int batchRemovedCount;
+    int deselectedCount;
+    QList<PointId> lastBatchSelected;
+    bool lastBatchSelectedStatus;
+    int batchSelectedCount;
     
     RangeF lastTimeRange;
     int timeRangeChangeCount;
@@ -73,10 +114,20 @@ public:
     {
         lastAdded = PointId::invalidId();
         addedCount = 0;
+        lastBatchAdded.clear();
+        batchAddedCount = 0;
         lastUpdated = PointId::invalidId();
         updatedCount = 0;
+        lastBatchUpdated.clear();
+        batchUpdatedCount = 0;
         lastRemoved = PointId::invalidId();
         removedCount = 0;
+        lastBatchRemoved.clear();
+        batchRemovedCount = 0;
+        deselectedCount = 0;
+        lastBatchSelected.clear();
+        lastBatchSelectedStatus = false;
+        batchSelectedCount = 0;
 
         lastTimeRange = RangeF();
         timeRangeChangeCount = 0;
@@ -96,7 +147,12 @@ public:
 
     	connect(&curve, &CurveModel::pointAdded, this, &CurveTestReceiver::pointAdded);
     	connect(&curve, &CurveModel::pointUpdated, this, &CurveTestReceiver::pointUpdated);
+        connect(&curve, &CurveModel::pointsUpdated, this, &CurveTestReceiver::pointsUpdated);
+        connect(&curve, &CurveModel::pointsAdded, this, &CurveTestReceiver::pointsAdded);
         connect(&curve, &CurveModel::pointRemoved, this, &CurveTestReceiver::pointRemoved);
+        connect(&curve, &CurveModel::pointsRemoved, this, &CurveTestReceiver::pointsRemoved);
+        connect(&curve, &CurveModel::pointDeselected, this, &CurveTestReceiver::pointDeselected);
+        connect(&curve, &CurveModel::pointsSelectedChanged, this, &CurveTestReceiver::pointsSelectedChanged);
         connect(&curve, &CurveModel::selectedChanged, this, &CurveTestReceiver::selectedChanged);
     }
     
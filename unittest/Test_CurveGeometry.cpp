@@ -0,0 +1,187 @@
+#include "Test_CurveGeometry.h"
+
+#include "../CurveGeometry.h"
+
+#include <QDebug>
+
+namespace {
+
+/** Store a tessellation for all segments of a level */
+void fillSegments(CurveGeometry& geometry, CurveGeometry::DetailLevel level)
+{
+    geometry.storeSegments(level, 0, QVector<QPolygonF>(geometry.segmentCount(), QPolygonF() << QPointF(0, 0)));
+}
+
+/** @return Indices of the segments of a level that need tessellation */
+QList<int> invalidSegments(const CurveGeometry& geometry, CurveGeometry::DetailLevel level)
+{
+    QList<int> invalid;
+    const QVector<QPolygonF> segments = geometry.segments(level);
+    for (int i = 0; i < segments.size(); ++i)
+        if (segments[i].isEmpty())
+            invalid.append(i);
+    return invalid;
+}
+
+} // anonymous namespace
+
+void Test_CurveGeometry::testSharing()
+{
+    std::shared_ptr<CurveModel> curve(new CurveModel("Name"));
+    std::shared_ptr<CurveModel> otherCurve(new CurveModel("Other"));
+
+    std::shared_ptr<CurveGeometry> geometry = CurveGeometry::forModel(curve);
+    QVERIFY(geometry);
+    QCOMPARE(CurveGeometry::forModel(curve), geometry);
+    QVERIFY(CurveGeometry::forModel(otherCurve) != geometry);
+
+    // Geometry is created again for the current points once released by all holders
+    geometry.reset();
+    curve->addPoint(0, 1.0f);
+    curve->addPoint(1, 1.0f);
+    geometry = CurveGeometry::forModel(curve);
+    QCOMPARE(geometry->segmentCount(), 1);
+}
+
+void Test_CurveGeometry::testSegmentsFollowSpline()
+{
+    std::shared_ptr<CurveModel> curve(new CurveModel("Name"));
+    curve->addPoint(0, 0.0f);
+    std::shared_ptr<CurveGeometry> geometry = CurveGeometry::forModel(curve);
+    QCOMPARE(geometry->segmentCount(), 0);
+
+    int changedCount = 0;
+    connect(geometry.get(), &CurveGeometry::changed, [&changedCount](int, RangeF) { ++changedCount; });
+
+    const PointId last = curve->addPoint(2, 2.0f);
+    const PointId middle = curve->addPoint(1, 1.0f);
+    QCOMPARE(geometry->segmentCount(), 2);
+    QCOMPARE(changedCount, 2);
+
+    // Moving past a neighbour is a remove and an insert
+    curve->updatePoint(middle, 3, 3.0f);
+    QCOMPARE(geometry->segmentCount(), 2);
+    QCOMPARE(changedCount, 4);
+
+    curve->removePoint(last);
+    QCOMPARE(geometry->segmentCount(), 1);
+    QCOMPARE(changedCount, 5);
+
+    // Large batch rebuilds the spline once
+    QVector<CurveModelAbs::PointUpdate> updates;
+    for (int i = 0; i < 100; ++i)
+        updates.append(CurveModelAbs::PointUpdate(curve->addPoint(10 + i, 0.0f), 200 - i, 1.0f));
+    changedCount = 0;
+    curve->updatePoints(updates);
+    QCOMPARE(geometry->segmentCount(), 101);
+    QCOMPARE(changedCount, 1);
+}
+
+void Test_CurveGeometry::testDetailLevels()
+{
+    std::shared_ptr<CurveModel> curve(new CurveModel("Name"));
+    for (int i = 0; i < 4; ++i)
+        curve->addPoint(i, 0.0f);
+    std::shared_ptr<CurveGeometry> geometry = CurveGeometry::forModel(curve);
+
+    QObject firstView;
+    QObject secondView;
+    const CurveGeometry::DetailLevel level(1.0f, 1.0f);
+    const CurveGeometry::DetailLevel otherLevel(2.0f, 1.0f);
+    QVERIFY(geometry->segments(level).isEmpty());
+
+    // Both views see the tessellation stored through either one
+    geometry->useDetailLevel(&firstView, level);
+    geometry->useDetailLevel(&secondView, level);
+    QCOMPARE(geometry->segments(level).size(), 3);
+
+    QVector<QPolygonF> tessellated(3, QPolygonF() << QPointF(0, 0));
+    geometry->storeSegments(level, 0, tessellated);
+    QCOMPARE(geometry->segments(level), tessellated);
+
+    // Point change invalidates the segments around it
+    curve->addPoint(4, 0.0f);
+    QCOMPARE(geometry->segments(level).size(), 4);
+    QVERIFY(!geometry->segments(level)[0].isEmpty());
+    QVERIFY(geometry->segments(level)[3].isEmpty());
+
+    // Level left by a view is kept for zooming back until the curve changes
+    geometry->useDetailLevel(&firstView, otherLevel);
+    geometry->useDetailLevel(&secondView, otherLevel);
+    QCOMPARE(geometry->segments(level).size(), 4);
+    curve->addPoint(5, 0.0f);
+    QVERIFY(geometry->segments(level).isEmpty());
+    QCOMPARE(geometry->segments(otherLevel).size(), 5);
+
+    geometry->releaseDetailLevel(&firstView);
+    geometry->releaseDetailLevel(&secondView);
+    QCOMPARE(geometry->segments(otherLevel).size(), 5);
+}
+
+void Test_CurveGeometry::testSegmentInvalidation()
+{
+    std::shared_ptr<CurveModel> curve(new CurveModel("Name"));
+    QList<PointId> ids;
+    for (int i = 0; i < 8; ++i)
+        ids.append(curve->addPoint(i * 10, 0.0f));
+    std::shared_ptr<CurveGeometry> geometry = CurveGeometry::forModel(curve);
+
+    QObject view;
+    const CurveGeometry::DetailLevel level(1.0f, 1.0f);
+    geometry->useDetailLevel(&view, level);
+
+    // Views are told the first changed segment
+    int firstChanged = -1;
+    connect(geometry.get(), &CurveGeometry::changed, [&firstChanged](int first, RangeF) { firstChanged = first; });
+
+    // Insert before the first point: the new segment and the next one, whose start tangent changed
+    fillSegments(*geometry, level);
+    const PointId first = curve->addPoint(-10, 0.0f);
+    QCOMPARE(geometry->segmentCount(), 8);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 0 << 1);
+    QCOMPARE(firstChanged, 0);
+
+    // Insert after the last point: the new segment and the previous one
+    fillSegments(*geometry, level);
+    const PointId last = curve->addPoint(80, 0.0f);
+    QCOMPARE(geometry->segmentCount(), 9);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 7 << 8);
+    QCOMPARE(firstChanged, 7);
+
+    // Insert in the middle: the two new segments and one more on each side
+    fillSegments(*geometry, level);
+    const PointId middle = curve->addPoint(25, 0.0f);
+    QCOMPARE(geometry->segmentCount(), 10);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 2 << 3 << 4 << 5);
+    QCOMPARE(firstChanged, 2);
+
+    // Move between the neighbours: the same segments
+    fillSegments(*geometry, level);
+    curve->updatePoint(middle, 26, 1.0f);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 2 << 3 << 4 << 5);
+
+    // Move past the neighbours: segments around the old and the new place
+    fillSegments(*geometry, level);
+    curve->updatePoint(middle, 55, 1.0f);
+    QCOMPARE(geometry->segmentCount(), 10);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 2 << 3 << 4 << 5 << 6 << 7 << 8);
+
+    // Remove the first point: only the segment starting from the new first point
+    fillSegments(*geometry, level);
+    curve->removePoint(first);
+    QCOMPARE(geometry->segmentCount(), 9);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 0);
+
+    // Remove the last point: only the segment ending at the new last point
+    fillSegments(*geometry, level);
+    curve->removePoint(last);
+    QCOMPARE(geometry->segmentCount(), 8);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 7);
+    QCOMPARE(firstChanged, 7);
+
+    // Remove from the middle: the joined segment and one on each side
+    fillSegments(*geometry, level);
+    curve->removePoint(ids[4]);
+    QCOMPARE(geometry->segmentCount(), 7);
+    QCOMPARE(invalidSegments(*geometry, level), QList<int>() << 2 << 3 << 4);
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_CURVEGEOMETRY_H
+#define TEST_CURVEGEOMETRY_H
+
+#include <QtTest/QtTest>
+
+class Test_CurveGeometry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSharing();
+    void testSegmentsFollowSpline();
+    void testDetailLevels();
+    void testSegmentInvalidation();
+};
+
+#endif // TEST_CURVEGEOMETRY_H
@@ -0,0 +1,301 @@
+#include "Test_CurveKeyCodec.h"
+
+#include "../CurveKeyCodec.h"
+#include "../SceneModel.h"
+#include "../CurveModel.h"
+#include "../StepCurveModel.h"
+#include "UnitTestHelpers.h"
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+
+const double BPM = 128;
+const double BEAT_OFFSET = 0.5;
+
+/** Generate smoothly changing spline keys on sixteenth notes with occasional KB params */
+QVector<CurveKeyCodec::SplineKey> generateSplineKeys(int count)
+{
+    const double sixteenth = 60.0 / BPM / 4;
+
+    QVector<CurveKeyCodec::SplineKey> keys;
+    for (int i = 0; i < count; ++i)
+    {
+        CurveKeyCodec::SplineKey key;
+        key.time = static_cast<float>(BEAT_OFFSET + i * sixteenth);
+        key.value = static_cast<float>(std::sin(i * 0.05) * 0.5 + 0.5);
+        key.tension = (i % 16 == 0) ? 0.5f : 0.0f;
+        key.bias = 0.0f;
+        key.continuity = (i % 32 == 0) ? -0.25f : 0.0f;
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+/** Generate a scene with keys on sixteenth notes */
+std::shared_ptr<SceneModel> generateBeatScene(int curveCount, int keysPerCurve)
+{
+    std::shared_ptr<SceneModel> scene = generateScene(curveCount, keysPerCurve, 60.0 / BPM / 4, BEAT_OFFSET);
+    scene->setBpm(BPM);
+    scene->setBeatOffset(BEAT_OFFSET);
+    return scene;
+}
+
+QByteArray serializeScene(SceneModel& scene)
+{
+    QByteArray data;
+    QXmlStreamWriter stream(&data);
+    stream.setAutoFormatting(true);
+    stream.writeStartDocument("1.0");
+    scene.serialize(stream);
+    stream.writeEndDocument();
+    return data;
+}
+
+bool sameSplineKeys(const QVector<CurveKeyCodec::SplineKey>& a, const QVector<CurveKeyCodec::SplineKey>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (int i = 0; i < a.size(); ++i)
+    {
+        if (a[i].time != b[i].time || a[i].value != b[i].value || a[i].tension != b[i].tension ||
+            a[i].bias != b[i].bias || a[i].continuity != b[i].continuity)
+            return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+void Test_CurveKeyCodec::testSplineKeys()
+{
+    const CurveKeyCodec::TimeGrid grid = CurveKeyCodec::TimeGrid::fromTempo(BEAT_OFFSET, BPM);
+
+    { // No keys
+        QVector<CurveKeyCodec::SplineKey> keys;
+        QVector<CurveKeyCodec::SplineKey> decoded;
+        QVERIFY(CurveKeyCodec::decode(CurveKeyCodec::encode(keys, grid), decoded));
+        QVERIFY(decoded.isEmpty());
+    }
+
+    { // Keys on grid are decoded exactly
+        const QVector<CurveKeyCodec::SplineKey> keys = generateSplineKeys(1000);
+        const QByteArray data = CurveKeyCodec::encode(keys, grid);
+
+        QVector<CurveKeyCodec::SplineKey> decoded;
+        QVERIFY(CurveKeyCodec::decode(data, decoded));
+        QVERIFY(sameSplineKeys(keys, decoded));
+
+        // Clearly smaller than raw floats
+        QVERIFY(data.size() < keys.size() * 2 * static_cast<int>(sizeof(float)));
+    }
+}
+
+void Test_CurveKeyCodec::testStepKeys()
+{
+    const CurveKeyCodec::TimeGrid grid = CurveKeyCodec::TimeGrid::fromTempo(BEAT_OFFSET, BPM);
+
+    QVector<CurveKeyCodec::StepKey> keys;
+    for (int i = 0; i < 1000; ++i)
+    {
+        CurveKeyCodec::StepKey key = { static_cast<float>(BEAT_OFFSET + i * 60.0 / BPM), (i % 7) - 3 };
+        keys.push_back(key);
+    }
+    // Extreme values
+    CurveKeyCodec::StepKey last = { keys.last().time + 1.0f, std::numeric_limits<int>::min() };
+    keys.push_back(last);
+    last.time += 1.0f;
+    last.value = std::numeric_limits<int>::max();
+    keys.push_back(last);
+
+    const QByteArray data = CurveKeyCodec::encode(keys, grid);
+
+    QVector<CurveKeyCodec::StepKey> decoded;
+    QVERIFY(CurveKeyCodec::decode(data, decoded));
+    QCOMPARE(decoded.size(), keys.size());
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        QCOMPARE(decoded[i].time, keys[i].time);
+        QCOMPARE(decoded[i].value, keys[i].value);
+    }
+
+    // Spline keys can't be decoded from step keys
+    QVector<CurveKeyCodec::SplineKey> splineKeys;
+    QVERIFY(!CurveKeyCodec::decode(data, splineKeys));
+}
+
+void Test_CurveKeyCodec::testOffGridTimes()
+{
+    QVector<CurveKeyCodec::SplineKey> keys = generateSplineKeys(100);
+    keys[50].time += 0.001f;
+
+    { // Grid
+        QVector<CurveKeyCodec::SplineKey> decoded;
+        QVERIFY(CurveKeyCodec::decode(CurveKeyCodec::encode(keys, CurveKeyCodec::TimeGrid::fromTempo(BEAT_OFFSET, BPM)), decoded));
+        QVERIFY(sameSplineKeys(keys, decoded));
+    }
+
+    { // No grid
+        QVector<CurveKeyCodec::SplineKey> decoded;
+        QVERIFY(CurveKeyCodec::decode(CurveKeyCodec::encode(keys, CurveKeyCodec::TimeGrid()), decoded));
+        QVERIFY(sameSplineKeys(keys, decoded));
+    }
+}
+
+void Test_CurveKeyCodec::testCorruptData()
+{
+    const QByteArray data = CurveKeyCodec::encode(generateSplineKeys(100), CurveKeyCodec::TimeGrid::fromTempo(BEAT_OFFSET, BPM));
+
+    QVector<CurveKeyCodec::SplineKey> decoded;
+    QVERIFY(!CurveKeyCodec::decode(QByteArray(), decoded));
+    QVERIFY(!CurveKeyCodec::decode(data.left(data.size() - 1), decoded));
+    QVERIFY(decoded.isEmpty());
+    QVERIFY(!CurveKeyCodec::decode(data + QByteArray(1, '\0'), decoded));
+
+    QByteArray badVersion = data;
+    badVersion[0] = 0x7f;
+    QVERIFY(!CurveKeyCodec::decode(badVersion, decoded));
+}
+
+void Test_CurveKeyCodec::testScenePackedKeys()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    std::shared_ptr<SceneModel> scene = generateBeatScene(4, 50);
+    auto spline = CurveModelAbs::getAsSplineCurve(scene->curves()[0]);
+    spline->updatePointParams(spline->pointIds()[1], 0.5f, -0.5f, 0.25f);
+
+    const QByteArray plain = serializeScene(*scene);
+
+    // Changing the encoding changes the saved file
+    scene->setSaved(scene->revision());
+    scene->setPackedKeys(true);
+    QVERIFY(scene->isModified());
+    scene->setSaved(scene->revision());
+    scene->setPackedKeys(true);
+    QVERIFY(!scene->isModified());
+
+    const QByteArray packed = serializeScene(*scene);
+
+    QVERIFY(packed.contains("packed_keys"));
+    QVERIFY(packed.size() < plain.size());
+
+    // Packed scene loads the same as the original
+    QXmlStreamReader packedStream(packed);
+    std::shared_ptr<SceneModel> packedScene = SceneModel::create(packedStream);
+    QVERIFY(packedScene.get());
+    QCOMPARE(packedScene->curves().size(), scene->curves().size());
+
+    for (int c = 0; c < scene->curves().size(); ++c)
+    {
+        auto curve = scene->curves()[c];
+        auto packedCurve = packedScene->curves()[c];
+        QCOMPARE(packedCurve->name(), curve->name());
+
+        const QList<PointId> ids = curve->pointIds();
+        const QList<PointId> packedIds = packedCurve->pointIds();
+        QCOMPARE(packedIds.size(), ids.size());
+        for (int i = 0; i < ids.size(); ++i)
+        {
+            QCOMPARE(packedCurve->point(packedIds[i]).time(), curve->point(ids[i]).time());
+            QCOMPARE(packedCurve->point(packedIds[i]).value().toFloat(), curve->point(ids[i]).value().toFloat());
+        }
+    }
+
+    auto loadedSpline = CurveModelAbs::getAsSplineCurve(packedScene->curves()[0]);
+    const CurveModel::KbParams params = loadedSpline->params(loadedSpline->pointIds()[1]);
+    QCOMPARE(params.tension(), 0.5f);
+    QCOMPARE(params.bias(), -0.5f);
+    QCOMPARE(params.continuity(), 0.25f);
+}
+
+void Test_CurveKeyCodec::testLoadedKeyEncoding()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    std::shared_ptr<SceneModel> scene = generateBeatScene(2, 10);
+    const QByteArray plain = serializeScene(*scene);
+    scene->setPackedKeys(true);
+    const QByteArray packed = serializeScene(*scene);
+
+    // Loaded scene keeps the encoding of its file and is not modified by it
+    QXmlStreamReader plainStream(plain);
+    std::shared_ptr<SceneModel> plainScene = SceneModel::create(plainStream);
+    QVERIFY(plainScene.get());
+    QVERIFY(!plainScene->packedKeys());
+    QVERIFY(!plainScene->isModified());
+
+    QXmlStreamReader packedStream(packed);
+    std::shared_ptr<SceneModel> packedScene = SceneModel::create(packedStream);
+    QVERIFY(packedScene.get());
+    QVERIFY(packedScene->packedKeys());
+    QVERIFY(!packedScene->isModified());
+}
+
+void Test_CurveKeyCodec::benchmarkCompression()
+{
+    std::shared_ptr<SceneModel> scene;
+    QByteArray plain;
+    QByteArray packed;
+    {
+        SUPPRESS_DEBUG_IN_SCOPE
+        scene = generateBeatScene(16, 10000);
+        plain = serializeScene(*scene);
+        scene->setPackedKeys(true);
+    }
+
+    QBENCHMARK {
+        packed = serializeScene(*scene);
+    }
+
+    qDebug() << "Scene of 16 x 10000 keys: plain" << plain.size() << "bytes, packed" << packed.size()
+             << "bytes, ratio" << static_cast<double>(plain.size()) / packed.size();
+}
+
+void Test_CurveKeyCodec::benchmarkDecode()
+{
+    const int keyCount = 1000000;
+    const QByteArray data = CurveKeyCodec::encode(generateSplineKeys(keyCount), CurveKeyCodec::TimeGrid::fromTempo(BEAT_OFFSET, BPM));
+
+    QVector<CurveKeyCodec::SplineKey> decoded;
+    QElapsedTimer timer;
+    timer.start();
+    int rounds = 0;
+
+    QBENCHMARK {
+        CurveKeyCodec::decode(data, decoded);
+        ++rounds;
+    }
+
+    const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+    qDebug() << "Decoded" << static_cast<double>(data.size()) / keyCount << "bytes/key," << (static_cast<double>(rounds) * keyCount / elapsed / 1000.0) << "M keys/s";
+    QCOMPARE(decoded.size(), keyCount);
+}
+
+void Test_CurveKeyCodec::benchmarkSceneLoad_data()
+{
+    QTest::addColumn<bool>("packedKeys");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("packed") << true;
+}
+
+void Test_CurveKeyCodec::benchmarkSceneLoad()
+{
+    QFETCH(bool, packedKeys);
+
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    std::shared_ptr<SceneModel> scene = generateBeatScene(8, 2000);
+    scene->setPackedKeys(packedKeys);
+    const QByteArray data = serializeScene(*scene);
+
+    QBENCHMARK {
+        QXmlStreamReader stream(data);
+        SceneModel::create(stream);
+    }
+}
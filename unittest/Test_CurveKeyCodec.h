@@ -0,0 +1,24 @@
+#ifndef TEST_CURVEKEYCODEC_H
+#define TEST_CURVEKEYCODEC_H
+
+#include <QtTest/QtTest>
+
+class Test_CurveKeyCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSplineKeys();
+    void testStepKeys();
+    void testOffGridTimes();
+    void testCorruptData();
+    void testScenePackedKeys();
+    void testLoadedKeyEncoding();
+
+    void benchmarkCompression();
+    void benchmarkDecode();
+    void benchmarkSceneLoad_data();
+    void benchmarkSceneLoad();
+};
+
+#endif // TEST_CURVEKEYCODEC_H
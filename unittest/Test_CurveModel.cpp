@@ -1,11 +1,42 @@
 #include "Test_CurveModel.h"
 
 #include "../CurveModel.h"
+#include "../StepCurveModel.h"
 #include "CurveTestReceiver.h"
 #include "UnitTestHelpers.h"
 
 #include <QDebug>
 
+namespace
+{
+
+/** Verify that the spline kept by the curve matches one built from scratch */
+void verifySpline(const CurveModel& curve)
+{
+    using SplineDataSet = pt::math::kb_data_set<float>;
+
+    CurveModel::Spline expected;
+    for (const Point& p : curve.points())
+    {
+        const CurveModel::KbParams params = curve.params(p.id());
+        expected.data().add(SplineDataSet::point(p.id(), p.time(), p.value().toFloat(),
+            pt::math::kochanek_bartels_parameters(params.tension(), params.bias(), params.continuity())));
+    }
+
+    const SplineDataSet& data = curve.spline().data();
+    QCOMPARE(static_cast<int>(data.size()), static_cast<int>(expected.data().size()));
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        QVERIFY(data.get(i)->id() == expected.data().get(i)->id());
+        QCOMPARE(data.get(i)->time(), expected.data().get(i)->time());
+        QCOMPARE(data.get(i)->value(), expected.data().get(i)->value());
+        QCOMPARE(data.get(i)->starting_tangent(), expected.data().get(i)->starting_tangent());
+        QCOMPARE(data.get(i)->ending_tangent(), expected.data().get(i)->ending_tangent());
+    }
+}
+
+}
+
 void Test_CurveModel::init()
 {
 }
@@ -171,3 +202,409 @@ void Test_CurveModel::testSelection()
     QCOMPARE(receiver.selectionChangeCount, 2);
     QCOMPARE(receiver.lastSelectionStatus, curve.isSelected());
 }
+
+void Test_CurveModel::testPointsInOrder()
+{
+    CurveModel curve("Name");
+    QVERIFY(curve.points().isEmpty());
+
+    const PointId third = curve.addPoint(3, 30);
+    const PointId first = curve.addPoint(1, 10);
+    const PointId second = curve.addPoint(2, 20);
+
+    // Points are in time order, matching point ids
+    const QList<Point> points = curve.points();
+    QCOMPARE(points.size(), 3);
+    QVERIFY(points[0].id() == first);
+    QVERIFY(points[1].id() == second);
+    QVERIFY(points[2].id() == third);
+    QCOMPARE(points[0].time(), 1.0f);
+    QCOMPARE(points[2].value().toFloat(), 30.0f);
+
+    const QList<PointId> ids = curve.pointIds();
+    for (int i = 0; i < points.size(); ++i)
+        QVERIFY(points[i].id() == ids[i]);
+
+    // Updated point moves in order
+    curve.updatePoint(first, 4, 40);
+    QVERIFY(curve.points().last().id() == first);
+}
+
+void Test_CurveModel::testPointsInRange()
+{
+    CurveModel curve("Name");
+    QVERIFY(curve.pointsInRange(RangeF(0, 10)).isEmpty());
+
+    for (int i = 0; i < 10; ++i)
+        curve.addPoint(i, i * 10);
+
+    // Inclusive range
+    QList<Point> points = curve.pointsInRange(RangeF(2, 4));
+    QCOMPARE(points.size(), 3);
+    QCOMPARE(points.first().time(), 2.0f);
+    QCOMPARE(points.last().time(), 4.0f);
+
+    // Range between points
+    QVERIFY(curve.pointsInRange(RangeF(2.2f, 2.8f)).isEmpty());
+
+    // Margin includes neighbours outside the range
+    points = curve.pointsInRange(RangeF(2.2f, 2.8f), 1);
+    QCOMPARE(points.size(), 2);
+    QCOMPARE(points.first().time(), 2.0f);
+    QCOMPARE(points.last().time(), 3.0f);
+
+    // Margin is limited by curve ends
+    points = curve.pointsInRange(RangeF(-5, 1), 2);
+    QCOMPARE(points.size(), 4);
+    QCOMPARE(points.first().time(), 0.0f);
+
+    // Invalid range has no points
+    QVERIFY(curve.pointsInRange(RangeF()).isEmpty());
+
+    // Counting stops at the limit
+    QCOMPARE(curve.numberOfPointsInRange(RangeF(2, 4), 10), 3);
+    QCOMPARE(curve.numberOfPointsInRange(RangeF(0, 9), 5), 5);
+    QCOMPARE(curve.numberOfPointsInRange(RangeF(2.2f, 2.8f), 10), 0);
+    QCOMPARE(curve.numberOfPointsInRange(RangeF(), 10), 0);
+}
+
+void Test_CurveModel::testPointLookup()
+{
+    CurveModel curve("Name");
+
+    // Points sharing the same time are found by id
+    const PointId first = curve.addPoint(1, 10);
+    const PointId second = curve.addPoint(1, 20);
+    const PointId third = curve.addPoint(2, 30);
+    QCOMPARE(curve.point(first).value().toFloat(), 10.0f);
+    QCOMPARE(curve.point(second).value().toFloat(), 20.0f);
+    QVERIFY(!curve.nextPointId(third).isValid());
+
+    // Moved point is found from its new time
+    curve.updatePoint(first, 3, 40);
+    QCOMPARE(curve.point(first).time(), 3.0f);
+    QCOMPARE(curve.point(first).value().toFloat(), 40.0f);
+    QVERIFY(curve.nextPointId(third) == first);
+    QCOMPARE(curve.point(second).time(), 1.0f);
+
+    // Removed point is not found
+    curve.removePoint(second);
+    QVERIFY(!curve.point(second).isValid());
+    QCOMPARE(curve.point(third).time(), 2.0f);
+}
+
+void Test_CurveModel::testUpdatePoints()
+{
+    CurveModel curve("Name");
+    CurveTestReceiver receiver(curve);
+
+    const PointId first = curve.addPoint(1, 10);
+    const PointId second = curve.addPoint(2, 20);
+    const PointId third = curve.addPoint(3, 30);
+    receiver.reset();
+
+    // Moved points notified with a single batch, unchanged and unknown points skipped
+    QVector<CurveModelAbs::PointUpdate> updates;
+    updates.append({first, 4.0f, 40});
+    updates.append({second, 2.0f, 20});
+    updates.append({third, 0.5f, 5});
+    updates.append({PointId::invalidId(), 1.0f, 1});
+    curve.updatePoints(updates);
+
+    QCOMPARE(receiver.batchUpdatedCount, 1);
+    QCOMPARE(receiver.updatedCount, 0);
+    QCOMPARE(receiver.lastBatchUpdated.size(), 2);
+    QVERIFY(receiver.lastBatchUpdated.contains(first));
+    QVERIFY(receiver.lastBatchUpdated.contains(third));
+
+    // Points reordered by their new times
+    const QList<Point> points = curve.points();
+    QCOMPARE(points.size(), 3);
+    QVERIFY(points[0].id() == third);
+    QVERIFY(points[1].id() == second);
+    QVERIFY(points[2].id() == first);
+    QCOMPARE(curve.point(first).value().toFloat(), 40.0f);
+
+    // Nothing changed, nothing notified
+    receiver.reset();
+    curve.updatePoints(QVector<CurveModelAbs::PointUpdate>());
+    QCOMPARE(receiver.batchUpdatedCount, 0);
+}
+
+void Test_CurveModel::testSelectedPoints()
+{
+    CurveModel curve("Name");
+    const PointId first = curve.addPoint(1, 10);
+    const PointId second = curve.addPoint(2, 20);
+    const PointId third = curve.addPoint(3, 30);
+    QCOMPARE(curve.numberOfSelectedPoints(), 0);
+
+    curve.pointSelectedChanged(first, true);
+    curve.pointSelectedChanged(third, true);
+    curve.pointSelectedChanged(third, true);
+    QCOMPARE(curve.numberOfSelectedPoints(), 2);
+    QVERIFY(curve.selectedPointIds().contains(first));
+    QVERIFY(curve.selectedPointIds().contains(third));
+
+    // Moving keeps selection
+    curve.updatePoint(first, 5, 10);
+    QCOMPARE(curve.numberOfSelectedPoints(), 2);
+
+    curve.pointSelectedChanged(first, false);
+    QCOMPARE(curve.numberOfSelectedPoints(), 1);
+    QVERIFY(curve.selectedPointIds().first() == third);
+
+    // Removed points are no longer selected
+    curve.removePoint(third);
+    QCOMPARE(curve.numberOfSelectedPoints(), 0);
+
+    curve.pointSelectedChanged(second, true);
+    curve.removePoints(QList<PointId>() << second);
+    QCOMPARE(curve.numberOfSelectedPoints(), 0);
+}
+
+void Test_CurveModel::testSetPointsSelected()
+{
+    CurveModel curve("Name");
+    const PointId first = curve.addPoint(1, 10);
+    const PointId second = curve.addPoint(2, 20);
+    const PointId third = curve.addPoint(3, 30);
+    CurveTestReceiver receiver(curve);
+
+    // One notification and one version bump for the whole batch
+    const quint64 version = curve.version();
+    curve.setPointsSelected(QList<PointId>() << first << second, true);
+    QCOMPARE(receiver.batchSelectedCount, 1);
+    QCOMPARE(receiver.lastBatchSelected, QList<PointId>() << first << second);
+    QVERIFY(receiver.lastBatchSelectedStatus);
+    QCOMPARE(curve.version(), version + 1);
+    QCOMPARE(curve.numberOfSelectedPoints(), 2);
+
+    // Already selected points are not reported again
+    curve.setPointsSelected(QList<PointId>() << first << third, true);
+    QCOMPARE(receiver.batchSelectedCount, 2);
+    QCOMPARE(receiver.lastBatchSelected, QList<PointId>() << third);
+    QCOMPARE(curve.numberOfSelectedPoints(), 3);
+
+    // Nothing changes, nothing is notified
+    curve.setPointsSelected(QList<PointId>() << first << third, true);
+    curve.setPointsSelected(QList<PointId>(), false);
+    QCOMPARE(receiver.batchSelectedCount, 2);
+
+    curve.setPointsSelected(curve.selectedPointIds(), false);
+    QCOMPARE(receiver.batchSelectedCount, 3);
+    QVERIFY(!receiver.lastBatchSelectedStatus);
+    QCOMPARE(receiver.lastBatchSelected.size(), 3);
+    QCOMPARE(receiver.deselectedCount, 0);
+    QCOMPARE(curve.numberOfSelectedPoints(), 0);
+}
+
+void Test_CurveModel::testAddRemovePoints()
+{
+    CurveModel curve("Name");
+    CurveTestReceiver receiver(curve);
+    curve.addPoint(0, 0);
+    receiver.reset();
+
+    // Added points notified with a single batch
+    QVector<CurveModelAbs::NewPoint> newPoints;
+    newPoints.append(CurveModelAbs::NewPoint(2, 20));
+    newPoints.append(CurveModelAbs::NewPoint(1, 10));
+    const QList<PointId> added = curve.addPoints(newPoints);
+    QCOMPARE(added.size(), 2);
+    QCOMPARE(receiver.batchAddedCount, 1);
+    QCOMPARE(receiver.addedCount, 0);
+    QVERIFY(receiver.lastBatchAdded == added);
+    QCOMPARE(curve.point(added[1]).time(), 1.0f);
+    verifySpline(curve);
+
+    // Selected points deselected before removing, unknown points skipped
+    curve.pointSelectedChanged(added[0], true);
+    receiver.reset();
+    {
+        EXPECT_ERRORS;
+        curve.removePoints(QList<PointId>() << added[0] << PointId::invalidId() << added[1]);
+    }
+    QCOMPARE(receiver.batchRemovedCount, 1);
+    QCOMPARE(receiver.removedCount, 0);
+    QCOMPARE(receiver.deselectedCount, 1);
+    QCOMPARE(receiver.lastBatchRemoved.size(), 2);
+    QCOMPARE(curve.numberOfPoints(), 1);
+    verifySpline(curve);
+
+    // Large batches are added and removed with a single spline rebuild
+    for (int i = 0; i < 200; ++i)
+        newPoints.append(CurveModelAbs::NewPoint(200 - i, i % 10));
+    const QList<PointId> many = curve.addPoints(newPoints);
+    QCOMPARE(curve.numberOfPoints(), 1 + newPoints.size());
+    verifySpline(curve);
+
+    curve.removePoints(many.mid(0, 150));
+    QCOMPARE(curve.numberOfPoints(), 1 + newPoints.size() - 150);
+    verifySpline(curve);
+
+    // Nothing changed, nothing notified
+    receiver.reset();
+    curve.addPoints(QVector<CurveModelAbs::NewPoint>());
+    curve.removePoints(QList<PointId>());
+    QCOMPARE(receiver.batchAddedCount, 0);
+    QCOMPARE(receiver.batchRemovedCount, 0);
+}
+
+void Test_CurveModel::testSpline()
+{
+    CurveModel curve("Name");
+    QCOMPARE(static_cast<int>(curve.spline().data().size()), 0);
+
+    // Added out of order
+    const PointId first = curve.addPoint(2, 20);
+    const PointId second = curve.addPoint(0, 0);
+    const PointId third = curve.addPoint(1, 30);
+    curve.addPoint(3, -10);
+    verifySpline(curve);
+    QCOMPARE(curve.spline().value_at(1.0f), 30.0f);
+
+    // Moved in place and past neighbours
+    curve.updatePoint(third, 1.5f, 10);
+    verifySpline(curve);
+    curve.updatePoint(second, 2.5f, 5);
+    verifySpline(curve);
+
+    curve.updatePointParams(first, 0.5f, -0.5f, 0.25f);
+    verifySpline(curve);
+
+    curve.removePoint(third);
+    verifySpline(curve);
+
+    // Small batch is updated in place, large one rebuilt
+    QVector<CurveModelAbs::PointUpdate> updates;
+    updates.append(CurveModelAbs::PointUpdate(first, 4.0f, 40));
+    curve.updatePoints(updates);
+    verifySpline(curve);
+
+    for (int i = 0; i < 100; ++i)
+        updates.append(CurveModelAbs::PointUpdate(curve.addPoint(10 + i, i), 200 - i, i));
+    curve.updatePoints(updates);
+    verifySpline(curve);
+    QCOMPARE(curve.spline().value_at(200.0f), 0.0f);
+}
+
+void Test_CurveModel::testEvaluation()
+{
+    CurveModel curve("Name");
+    QCOMPARE(curve.valueAt(1.0f), 0.0f);
+
+    float samples[5] = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+    curve.sample(RangeF(0, 4), 5, samples);
+    QCOMPARE(samples[4], 0.0f);
+
+    curve.addPoint(1, 10);
+    curve.addPoint(2, 30);
+    curve.addPoint(3, 20);
+
+    // Point values at points, end point values outside the points
+    QCOMPARE(curve.valueAt(2.0f), 30.0f);
+    QCOMPARE(curve.valueAt(0.0f), 10.0f);
+    QCOMPARE(curve.valueAt(4.0f), 20.0f);
+
+    // Samples match single evaluations, end of range included
+    float values[9];
+    curve.sample(RangeF(0, 4), 9, values);
+    for (int i = 0; i < 9; ++i)
+        QCOMPARE(values[i], curve.valueAt(i * 0.5f));
+
+    curve.sample(RangeF(1.5f, 3), 1, values);
+    QCOMPARE(values[0], curve.valueAt(1.5f));
+}
+
+void Test_CurveModel::testStepEvaluation()
+{
+    StepCurveModel curve("Name");
+    StepCurveModel::Options options;
+    for (int i = 0; i < 3; ++i)
+        options.insert(i, QString::number(i));
+    curve.setOptions(options);
+    QCOMPARE(curve.valueAt(1.0f), 0.0f);
+
+    curve.addPoint(1, 1);
+    curve.addPoint(2, 2);
+    curve.addPoint(3, 0);
+
+    // Latest point value held, first point value before the first point
+    QCOMPARE(curve.valueAt(0.0f), 1.0f);
+    QCOMPARE(curve.valueAt(1.0f), 1.0f);
+    QCOMPARE(curve.valueAt(2.5f), 2.0f);
+    QCOMPARE(curve.valueAt(3.0f), 0.0f);
+    QCOMPARE(curve.valueAt(10.0f), 0.0f);
+
+    float values[9];
+    curve.sample(RangeF(0, 4), 9, values);
+    for (int i = 0; i < 9; ++i)
+        QCOMPARE(values[i], curve.valueAt(i * 0.5f));
+}
+
+void Test_CurveModel::benchmarkSample()
+{
+    CurveModel curve("Name");
+    const int pointCount = 10000;
+    for (int i = 0; i < pointCount; ++i)
+        curve.addPoint(i, (i * 37) % 200 - 100);
+
+    QVector<float> values(100000);
+    QBENCHMARK
+    {
+        curve.sample(RangeF(0, pointCount), values.size(), values.data());
+    }
+}
+
+void Test_CurveModel::benchmarkUpdatePoints_data()
+{
+    QTest::addColumn<int>("pointCount");
+    QTest::addColumn<int>("movedCount");
+
+    QTest::newRow("10k of 10k") << 10000 << 10000;
+    QTest::newRow("10k of 100k") << 100000 << 10000;
+}
+
+void Test_CurveModel::benchmarkUpdatePoints()
+{
+    QFETCH(int, pointCount);
+    QFETCH(int, movedCount);
+
+    CurveModel curve("Name");
+    QList<PointId> ids;
+    for (int i = 0; i < pointCount; ++i)
+        ids.append(curve.addPoint(i, i % 10));
+
+    // One drag step moving a block of points
+    const int firstMoved = (pointCount - movedCount) / 2;
+    QVector<CurveModelAbs::PointUpdate> updates(movedCount);
+    float offset = 0.0f;
+    QBENCHMARK {
+        offset += 0.25f;
+        for (int i = 0; i < movedCount; ++i)
+            updates[i] = {ids[firstMoved + i], firstMoved + i + offset, (firstMoved + i) % 10};
+        curve.updatePoints(updates);
+    }
+    QCOMPARE(curve.numberOfPoints(), pointCount);
+}
+
+void Test_CurveModel::benchmarkRemoveSelectedPoints()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    static const int POINT_COUNT = 200000;
+
+    QBENCHMARK_ONCE {
+        CurveModel curve("Name");
+        for (int i = 0; i < POINT_COUNT; ++i)
+        {
+            const PointId id = curve.addPoint(i, i % 10);
+            if (i % 2 == 0)
+                curve.pointSelectedChanged(id, true);
+        }
+
+        curve.removePoints(curve.selectedPointIds());
+        QCOMPARE(curve.numberOfPoints(), POINT_COUNT / 2);
+    }
+}
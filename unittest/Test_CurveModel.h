@@ -14,6 +14,21 @@ private slots:
     void testConstruction();
     void testPointAddUpdateRemove();
     void testSelection();
+    void testPointsInOrder();
+    void testPointsInRange();
+    void testPointLookup();
+    void testUpdatePoints();
+    void testSelectedPoints();
+    void testSetPointsSelected();
+    void testAddRemovePoints();
+    void testSpline();
+    void testEvaluation();
+    void testStepEvaluation();
+
+    void benchmarkSample();
+    void benchmarkUpdatePoints_data();
+    void benchmarkUpdatePoints();
+    void benchmarkRemoveSelectedPoints();
 };
 
 #endif // TEST_CURVEMODEL_H
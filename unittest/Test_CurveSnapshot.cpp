@@ -0,0 +1,241 @@
+#include "Test_CurveSnapshot.h"
+
+#include "../CurveModel.h"
+#include "../StepCurveModel.h"
+#include "../SceneModel.h"
+#include "../SceneSnapshot.h"
+#include "UnitTestHelpers.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <cmath>
+
+void Test_CurveSnapshot::testVersion()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    CurveModel curve("Name");
+    const quint64 initialVersion = curve.version();
+
+    // Snapshot is cached until the curve changes
+    std::shared_ptr<const CurveSnapshot> snapshot = curve.snapshot();
+    QVERIFY(snapshot);
+    QCOMPARE(curve.snapshot(), snapshot);
+    QCOMPARE(snapshot->version(), initialVersion);
+
+    const PointId id = curve.addPoint(1, 1.0f);
+    QVERIFY(curve.version() > initialVersion);
+    QVERIFY(curve.snapshot() != snapshot);
+    QCOMPARE(curve.snapshot()->version(), curve.version());
+
+    // Every kind of content change increments version
+    quint64 version = curve.version();
+    curve.updatePoint(id, 2, 1.0f);
+    QVERIFY(curve.version() > version);
+
+    version = curve.version();
+    curve.updatePointParams(id, 0.5f, 0.0f, 0.0f);
+    QVERIFY(curve.version() > version);
+
+    version = curve.version();
+    curve.setName("Other");
+    QVERIFY(curve.version() > version);
+    QCOMPARE(curve.snapshot()->name(), QString("Other"));
+
+    // No change, no new version
+    version = curve.version();
+    curve.updatePoint(id, 2, 1.0f);
+    QCOMPARE(curve.version(), version);
+}
+
+void Test_CurveSnapshot::testSnapshotIsImmutable()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    CurveModel curve("Name");
+    const PointId first = curve.addPoint(0, 0.0f);
+    const PointId second = curve.addPoint(1, 10.0f);
+    const PointId last = curve.addPoint(2, 0.0f);
+
+    std::shared_ptr<const CurveSnapshot> snapshot = curve.snapshot();
+    QCOMPARE(snapshot->numberOfPoints(), 3);
+    QCOMPARE(snapshot->point(second).time(), 1.0f);
+    QVERIFY(snapshot->nextPointId(first) == second);
+    QVERIFY(!snapshot->nextPointId(last).isValid());
+    QVERIFY(!snapshot->isStep());
+    QCOMPARE(snapshot->valueAt(0.5f), curve.valueAt(0.5f));
+    const float oldValue = snapshot->valueAt(0.5f);
+
+    // Model changes don't show in the snapshot
+    curve.addPoint(3, 5.0f);
+    curve.updatePoint(first, 0, 20.0f);
+    QCOMPARE(snapshot->numberOfPoints(), 3);
+    QCOMPARE(snapshot->points().first().value().toFloat(), 0.0f);
+    QCOMPARE(snapshot->valueAt(0.5f), oldValue);
+    QVERIFY(curve.valueAt(0.5f) != oldValue);
+
+    curve.removePoint(first);
+    QCOMPARE(snapshot->numberOfPoints(), 3);
+    QVERIFY(snapshot->point(first).isValid());
+    QVERIFY(!curve.snapshot()->point(first).isValid());
+    QCOMPARE(static_cast<int>(snapshot->spline()->data().size()), 3);
+
+    // New snapshot follows the model
+    std::shared_ptr<const CurveSnapshot> current = curve.snapshot();
+    QCOMPARE(current->numberOfPoints(), 3);
+    QCOMPARE(current->points().first().time(), 1.0f);
+
+    int visited = 0;
+    current->forEachPointInRange(RangeF(1.5f, 2.5f), 1, [&visited](const Point&) { ++visited; });
+    QCOMPARE(visited, 3);
+}
+
+void Test_CurveSnapshot::testSplineCopyOnWrite()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    CurveModel curve("Name");
+    const PointId id = curve.addPoint(0, 0.0f);
+    curve.addPoint(1, 1.0f);
+
+    // Spline is shared with the snapshot until the curve changes
+    std::shared_ptr<const CurveSnapshot> snapshot = curve.snapshot();
+    QVERIFY(snapshot->spline() == &curve.spline());
+
+    curve.updatePoint(id, 0, 2.0f);
+    QVERIFY(snapshot->spline() != &curve.spline());
+    QCOMPARE(snapshot->spline()->data().get(0)->value(), 0.0f);
+    QCOMPARE(curve.spline().data().get(0)->value(), 2.0f);
+
+    // Snapshot cached only by the model is dropped before changes, the spline is modified in place
+    snapshot.reset();
+    curve.snapshot();
+    const CurveModel::Spline* spline = &curve.spline();
+    curve.updatePoint(id, 0, 3.0f);
+    QVERIFY(&curve.spline() == spline);
+    QCOMPARE(curve.snapshot()->spline()->data().get(0)->value(), 3.0f);
+
+    // Rebuilding the spline for a large batch is a change of its own
+    QVector<CurveModelAbs::NewPoint> newPoints;
+    for (int i = 0; i < 100; ++i)
+        newPoints.append(CurveModelAbs::NewPoint(200 - i, 1.0f));
+    const quint64 version = curve.version();
+    curve.addPoints(newPoints);
+    QVERIFY(curve.version() > version);
+    QVERIFY(curve.snapshot()->spline() == &curve.spline());
+    QCOMPARE(curve.snapshot()->version(), curve.version());
+}
+
+void Test_CurveSnapshot::testStepSnapshot()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    StepCurveModel curve("Name");
+    StepCurveModel::Options options;
+    options.insert(0, "Zero");
+    options.insert(1, "One");
+    options.insert(2, "Two");
+    curve.setOptions(options);
+
+    // Empty curve evaluates to zero
+    QCOMPARE(curve.snapshot()->valueAt(1.0f), 0.0f);
+
+    curve.addPoint(1, 1);
+    curve.addPoint(2, 2);
+    curve.addPoint(3, 0);
+
+    std::shared_ptr<const CurveSnapshot> snapshot = curve.snapshot();
+    QVERIFY(snapshot->isStep());
+    QVERIFY(!snapshot->spline());
+
+    const float times[] = { 0.0f, 1.0f, 1.5f, 2.0f, 2.99f, 3.0f, 4.0f };
+    for (float time : times)
+        QCOMPARE(snapshot->valueAt(time), curve.valueAt(time));
+
+    float samples[9];
+    float expected[9];
+    snapshot->sample(RangeF(0.0f, 4.0f), 9, samples);
+    curve.sample(RangeF(0.0f, 4.0f), 9, expected);
+    for (int i = 0; i < 9; ++i)
+        QCOMPARE(samples[i], expected[i]);
+
+    // All points are visited in time order
+    QList<float> visitedTimes;
+    snapshot->forEachPoint([&visitedTimes](const Point& p) { visitedTimes.append(p.time()); });
+    QCOMPARE(visitedTimes, QList<float>() << 1.0f << 2.0f << 3.0f);
+}
+
+void Test_CurveSnapshot::testSceneSnapshot()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    SceneModel scene(RangeF(0, 10));
+    auto first = std::make_shared<CurveModel>("First");
+    first->addPoint(0, 1.0f);
+    auto second = std::make_shared<CurveModel>("Second");
+    second->addPoint(0, 2.0f);
+    scene.addCurve(first);
+    scene.addCurve(second);
+
+    std::shared_ptr<const SceneSnapshot> snapshot = scene.snapshot();
+    QCOMPARE(snapshot->revision(), scene.revision());
+    QVERIFY(snapshot->timeRange() == RangeF(0, 10));
+    QCOMPARE(snapshot->curves().size(), 2);
+    QCOMPARE(snapshot->curves()[0], first->snapshot());
+
+    float values[2];
+    snapshot->evaluate(5.0f, values);
+    QCOMPARE(values[0], 1.0f);
+    QCOMPARE(values[1], 2.0f);
+
+    // Unchanged curves share their snapshots
+    first->addPoint(1, 5.0f);
+    QVERIFY(scene.snapshot()->curves()[0] != snapshot->curves()[0]);
+    QCOMPARE(scene.snapshot()->curves()[1], snapshot->curves()[1]);
+
+    // Scene changes don't show in the snapshot
+    scene.setTimeRange(RangeF(0, 20));
+    snapshot->evaluate(5.0f, values);
+    QCOMPARE(values[0], 1.0f);
+    QVERIFY(snapshot->timeRange() == RangeF(0, 10));
+    QVERIFY(scene.snapshot()->revision() > snapshot->revision());
+}
+
+void Test_CurveSnapshot::testConcurrentReaders()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    static const int POINT_COUNT = 1000;
+    static const int SAMPLE_COUNT = 10000;
+
+    CurveModel curve("Name");
+    QList<PointId> ids;
+    for (int i = 0; i < POINT_COUNT; ++i)
+        ids.append(curve.addPoint(i, static_cast<float>(std::sin(i * 0.3) * 50.0)));
+
+    std::shared_ptr<const CurveSnapshot> snapshot = curve.snapshot();
+    QVector<float> expected(SAMPLE_COUNT);
+    snapshot->sample(RangeF(0, POINT_COUNT), SAMPLE_COUNT, expected.data());
+
+    // Worker samples the snapshot repeatedly while the model changes
+    auto readSnapshot = [snapshot, expected]()
+    {
+        QVector<float> samples(SAMPLE_COUNT);
+        for (int round = 0; round < 20; ++round)
+        {
+            snapshot->sample(RangeF(0, POINT_COUNT), SAMPLE_COUNT, samples.data());
+            if (samples != expected)
+                return false;
+        }
+        return true;
+    };
+    QFuture<bool> reader = QtConcurrent::run(readSnapshot);
+
+    for (int i = 0; i < ids.size(); i += 2)
+        curve.updatePoint(ids[i], i, 0.0f);
+    for (int i = 1; i < ids.size(); i += 4)
+        curve.removePoint(ids[i]);
+
+    QVERIFY(reader.result());
+    QCOMPARE(snapshot->numberOfPoints(), POINT_COUNT);
+}
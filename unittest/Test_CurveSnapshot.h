@@ -0,0 +1,19 @@
+#ifndef TEST_CURVESNAPSHOT_H
+#define TEST_CURVESNAPSHOT_H
+
+#include <QtTest/QtTest>
+
+class Test_CurveSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testVersion();
+    void testSnapshotIsImmutable();
+    void testSplineCopyOnWrite();
+    void testStepSnapshot();
+    void testSceneSnapshot();
+    void testConcurrentReaders();
+};
+
+#endif // TEST_CURVESNAPSHOT_H
@@ -0,0 +1,180 @@
+#include "Test_MinMaxPyramid.h"
+
+#include "../MinMaxPyramid.h"
+
+#include <QVector>
+#include <cmath>
+
+namespace {
+
+/** Step function with a value per time unit, envelope computed by brute force */
+struct SampledCurve
+{
+    QVector<float> values;
+
+    RangeF envelope(float start, float end) const
+    {
+        RangeF range;
+        const int first = qMax(static_cast<int>(std::floor(start)), 0);
+        const int last = qMin(static_cast<int>(std::floor(end)), values.size() - 1);
+        for (int i = first; i <= last; ++i)
+            range = RangeF::makeUnion(range, RangeF(values[i], values[i]));
+        return range;
+    }
+};
+
+SampledCurve makeCurve(int length)
+{
+    SampledCurve curve;
+    for (int i = 0; i < length; ++i)
+        curve.values.append(static_cast<float>(std::sin(i * 0.37) * 100.0 + (i % 7)));
+    return curve;
+}
+
+} // anonymous namespace
+
+void Test_MinMaxPyramid::testBuild()
+{
+    const SampledCurve curve = makeCurve(100);
+    MinMaxPyramid pyramid([&curve](float start, float end) { return curve.envelope(start, end); });
+    QVERIFY(!pyramid.isBuilt());
+    QCOMPARE(pyramid.levelFor(100.0f), -1);
+
+    // 100 buckets halve down to one: 100, 50, 25, 13, 7, 4, 2, 1
+    pyramid.build(RangeF(0, 100), 1.0f);
+    QVERIFY(pyramid.isBuilt());
+    QCOMPARE(pyramid.levelCount(), 8);
+    QCOMPARE(pyramid.bucketLength(3), 8.0f);
+
+    QCOMPARE(pyramid.levelFor(0.5f), -1);
+    QCOMPARE(pyramid.levelFor(1.0f), 0);
+    QCOMPARE(pyramid.levelFor(5.0f), 2);
+    QCOMPARE(pyramid.levelFor(1000.0f), 7);
+
+    // Top level covers everything
+    const RangeF all = curve.envelope(0, 100);
+    QCOMPARE(pyramid.envelope(7, 0, 100), all);
+
+    pyramid.clear();
+    QVERIFY(!pyramid.isBuilt());
+    QVERIFY(!pyramid.timeRange().isValid());
+}
+
+void Test_MinMaxPyramid::testEnvelope()
+{
+    const SampledCurve curve = makeCurve(1000);
+    MinMaxPyramid pyramid([&curve](float start, float end) { return curve.envelope(start, end); });
+    pyramid.build(RangeF(0, 1000), 1.0f);
+
+    // Envelope of buckets on any level matches brute force over the same buckets
+    for (int level = 0; level < pyramid.levelCount(); ++level)
+    {
+        const float length = pyramid.bucketLength(level);
+        for (float start = 0; start < 1000; start += length)
+        {
+            // Buckets are closed ranges, sharing boundaries with neighbours
+            const RangeF expected = curve.envelope(start, start + length);
+            QCOMPARE(pyramid.envelope(level, start, start + length - 0.5f), expected);
+        }
+    }
+}
+
+void Test_MinMaxPyramid::testInvalidate()
+{
+    SampledCurve curve = makeCurve(1000);
+    MinMaxPyramid pyramid([&curve](float start, float end) { return curve.envelope(start, end); });
+    pyramid.build(RangeF(0, 1000), 1.0f);
+    for (int level = 0; level < pyramid.levelCount(); ++level)
+        pyramid.envelope(level, 0, 1000);
+
+    // Spike in the middle shows up on all levels after invalidation
+    curve.values[500] = 1000.0f;
+    QVERIFY(pyramid.envelope(pyramid.levelCount() - 1, 0, 1000).max < 1000.0f);
+    pyramid.invalidate(RangeF(500, 500));
+    for (int level = 0; level < pyramid.levelCount(); ++level)
+        QCOMPARE(pyramid.envelope(level, 500, 500).max, 1000.0f);
+    QCOMPARE(pyramid.envelope(0, 499, 499), curve.envelope(499, 500));
+
+    // Change outside covered range drops the pyramid
+    pyramid.invalidate(RangeF(990, 1010));
+    QVERIFY(!pyramid.isBuilt());
+}
+
+void Test_MinMaxPyramid::testLazyBuckets()
+{
+    const SampledCurve curve = makeCurve(100000);
+    int queries = 0;
+    MinMaxPyramid pyramid([&curve, &queries](float start, float end)
+    {
+        ++queries;
+        return curve.envelope(start, end);
+    });
+
+    // Setting up the levels queries nothing
+    pyramid.build(RangeF(0, 100000), 1.0f);
+    QCOMPARE(pyramid.levelCount(), 18);
+    QCOMPARE(queries, 0);
+
+    // Only the level 3 buckets under 101 columns of 10 are computed
+    const QPolygonF lines = pyramid.lines(RangeF(50000, 51000), 10.0f);
+    QCOMPARE(lines.size(), 2 * 101);
+    QVERIFY(queries > 0);
+    QVERIFY(queries <= 128);
+
+    // Computed buckets are reused
+    const int computed = queries;
+    QCOMPARE(pyramid.lines(RangeF(50000, 51000), 10.0f), lines);
+    QCOMPARE(queries, computed);
+
+    // Change computes again only the bucket it touched
+    pyramid.invalidate(RangeF(50500, 50500));
+    pyramid.lines(RangeF(50000, 51000), 10.0f);
+    QCOMPARE(queries, computed + 1);
+}
+
+void Test_MinMaxPyramid::testLines()
+{
+    const SampledCurve curve = makeCurve(10000);
+    MinMaxPyramid pyramid([&curve](float start, float end) { return curve.envelope(start, end); });
+    QVERIFY(pyramid.lines(RangeF(0, 10000), 10.0f).isEmpty());
+    pyramid.build(RangeF(0, 10000), 1.0f);
+
+    // A vertical line per column
+    const QPolygonF lines = pyramid.lines(RangeF(2000, 3000), 10.0f);
+    QCOMPARE(lines.size(), 2 * 101);
+    for (int i = 0; i < lines.size(); i += 2)
+    {
+        QCOMPARE(lines[i].x(), lines[i + 1].x());
+        const RangeF range(qMin(lines[i].y(), lines[i + 1].y()), qMax(lines[i].y(), lines[i + 1].y()));
+        const float start = lines[i].x();
+        QVERIFY(range.min <= curve.envelope(start, start + 9.5f).min);
+        QVERIFY(range.max >= curve.envelope(start, start + 9.5f).max);
+    }
+
+    // Clipped to covered range, columns at 9990 and 10000
+    QCOMPARE(pyramid.lines(RangeF(9995, 20000), 10.0f).size(), 4);
+}
+
+void Test_MinMaxPyramid::benchmarkLines_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("1M") << 1000000;
+}
+
+void Test_MinMaxPyramid::benchmarkLines()
+{
+    QFETCH(int, length);
+
+    const SampledCurve curve = makeCurve(length);
+    MinMaxPyramid pyramid([&curve](float start, float end) { return curve.envelope(start, end); });
+    pyramid.build(RangeF(0, length), 1.0f);
+
+    // Whole curve in 1000 pixels, cost follows pixels not curve length
+    QPolygonF lines;
+    QBENCHMARK {
+        lines = pyramid.lines(RangeF(0, length), length / 1000.0f);
+    }
+    QVERIFY(lines.size() <= 2 * 1001);
+}
@@ -0,0 +1,21 @@
+#ifndef TEST_MINMAXPYRAMID_H
+#define TEST_MINMAXPYRAMID_H
+
+#include <QtTest/QtTest>
+
+class Test_MinMaxPyramid : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBuild();
+    void testEnvelope();
+    void testInvalidate();
+    void testLazyBuckets();
+    void testLines();
+
+    void benchmarkLines_data();
+    void benchmarkLines();
+};
+
+#endif // TEST_MINMAXPYRAMID_H
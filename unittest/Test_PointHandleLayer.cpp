@@ -0,0 +1,126 @@
+#include "Test_PointHandleLayer.h"
+
+#include "../CurveModel.h"
+#include "../PointHandleLayer.h"
+#include "CurveTestReceiver.h"
+
+#include <QDebug>
+
+namespace {
+
+/** @return Ids of the selected points of a curve */
+QSet<PointId> selectedIds(const CurveModelAbs& curve)
+{
+    return curve.selectedPointIds().toSet();
+}
+
+} // anonymous namespace
+
+void Test_PointHandleLayer::testPointAt()
+{
+    auto curve = std::make_shared<CurveModel>("Name");
+    const PointId first = curve->addPoint(0, 0.0f);
+    curve->addPoint(20, 0.0f);
+    const PointId upper = curve->addPoint(20, 3.0f);
+
+    // Without a view a pixel is one curve unit, handles reach 5 units from the points
+    PointHandleLayer layer(curve, nullptr);
+    QCOMPARE(layer.pointAt(QPointF(1, 1)), first);
+    QCOMPARE(layer.pointAt(QPointF(-4.5, 4.5)), first);
+    QVERIFY(!layer.pointAt(QPointF(10, 0)).isValid());
+    QVERIFY(!layer.pointAt(QPointF(0, 6)).isValid());
+
+    // Closest of overlapping handles
+    QCOMPARE(layer.pointAt(QPointF(20, 2.5)), upper);
+    QVERIFY(layer.contains(QPointF(20, 2.5)));
+    QVERIFY(!layer.contains(QPointF(10, 0)));
+
+    // Handles keep their size in pixels when the curve is scaled
+    layer.setTransform(QTransform::fromScale(10, 10));
+    QCOMPARE(layer.pointAt(QPointF(0.4, 0)), first);
+    QVERIFY(!layer.pointAt(QPointF(0.6, 0)).isValid());
+}
+
+void Test_PointHandleLayer::testSelectInArea()
+{
+    auto curve = std::make_shared<CurveModel>("Name");
+    const PointId first = curve->addPoint(0, 0.0f);
+    const PointId lower = curve->addPoint(20, 0.0f);
+    const PointId upper = curve->addPoint(20, 3.0f);
+    PointHandleLayer layer(curve, nullptr);
+    CurveTestReceiver receiver(*curve);
+
+    // Area limits both time and value, the selection is notified in one batch
+    layer.selectInArea(QRectF(-1, -1, 22, 2), false);
+    QCOMPARE(selectedIds(*curve), QSet<PointId>() << first << lower);
+    QCOMPARE(receiver.batchSelectedCount, 1);
+
+    // Extending keeps the previous selection
+    layer.selectInArea(QRectF(19, 2, 2, 2), true);
+    QCOMPARE(selectedIds(*curve), QSet<PointId>() << first << lower << upper);
+
+    // Otherwise only the points in the area stay selected
+    layer.selectInArea(QRectF(19, 2, 2, 2), false);
+    QCOMPARE(selectedIds(*curve), QSet<PointId>() << upper);
+
+    layer.selectInArea(QRectF(5, -1, 10, 10), false);
+    QVERIFY(selectedIds(*curve).isEmpty());
+
+    // Deselecting several points is a single batch too
+    layer.selectInArea(QRectF(-1, -1, 22, 5), false);
+    receiver.reset();
+    layer.selectInArea(QRectF(5, -1, 10, 10), false);
+    QVERIFY(selectedIds(*curve).isEmpty());
+    QCOMPARE(receiver.batchSelectedCount, 1);
+    QCOMPARE(receiver.lastBatchSelected.size(), 3);
+    QCOMPARE(receiver.deselectedCount, 0);
+}
+
+void Test_PointHandleLayer::testDrag()
+{
+    auto curve = std::make_shared<CurveModel>("Name");
+    const PointId first = curve->addPoint(0, 0.0f);
+    const PointId second = curve->addPoint(10, 1.0f);
+    const PointId unselected = curve->addPoint(20, 2.0f);
+    curve->pointSelectedChanged(first, true);
+    curve->pointSelectedChanged(second, true);
+
+    PointHandleLayer layer(curve, nullptr);
+    CurveTestReceiver receiver(*curve);
+
+    // Offsets are from the positions at the start of the drag, each move is one update
+    layer.beginDrag();
+    layer.drag(QPointF(3, 1));
+    layer.drag(QPointF(4, 0.5));
+    layer.endDrag();
+    QCOMPARE(receiver.batchUpdatedCount, 2);
+    QCOMPARE(receiver.lastBatchUpdated.toSet(), QSet<PointId>() << first << second);
+    QCOMPARE(curve->point(first).time(), 4.0f);
+    QCOMPARE(curve->point(first).value().toFloat(), 0.5f);
+    QCOMPARE(curve->point(second).time(), 14.0f);
+    QCOMPARE(curve->point(second).value().toFloat(), 1.5f);
+    QCOMPARE(curve->point(unselected).time(), 20.0f);
+    QCOMPARE(curve->point(unselected).value().toFloat(), 2.0f);
+
+    // Drag after endDrag does nothing
+    layer.drag(QPointF(1, 1));
+    QCOMPARE(receiver.batchUpdatedCount, 2);
+
+    // Snap to the closest grid line in time and value
+    layer.setSnapGrid(QRectF(0, 0, 2, 0.25));
+    layer.beginDrag();
+    layer.drag(QPointF(1.2, 0.2));
+    layer.endDrag();
+    QCOMPARE(curve->point(first).time(), 6.0f);
+    QCOMPARE(curve->point(first).value().toFloat(), 0.75f);
+    QCOMPARE(curve->point(second).time(), 16.0f);
+    QCOMPARE(curve->point(second).value().toFloat(), 1.75f);
+
+    // Empty grid size in a direction does not snap in it
+    layer.setSnapGrid(QRectF(0, 0, 0, 0.25));
+    layer.beginDrag();
+    layer.drag(QPointF(0.3, 0.1));
+    layer.endDrag();
+    QCOMPARE(curve->point(first).time(), 6.3f);
+    QCOMPARE(curve->point(first).value().toFloat(), 0.75f);
+}
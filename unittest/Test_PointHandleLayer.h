@@ -0,0 +1,16 @@
+#ifndef TEST_POINTHANDLELAYER_H
+#define TEST_POINTHANDLELAYER_H
+
+#include <QtTest/QtTest>
+
+class Test_PointHandleLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testPointAt();
+    void testSelectInArea();
+    void testDrag();
+};
+
+#endif // TEST_POINTHANDLELAYER_H
@@ -0,0 +1,104 @@
+#include "Test_RedrawScheduler.h"
+
+#include "../RedrawScheduler.h"
+
+#include <QDebug>
+
+void Test_RedrawScheduler::testCoalescing()
+{
+    RedrawScheduler scheduler;
+    QObject first;
+    QObject second;
+    int firstRedraws = 0;
+    int secondRedraws = 0;
+
+    for (int i = 0; i < 3; ++i)
+        scheduler.schedule(&first, [&firstRedraws]() { ++firstRedraws; });
+    scheduler.schedule(&second, [&secondRedraws]() { ++secondRedraws; });
+    QVERIFY(scheduler.isScheduled(&first));
+    QVERIFY(scheduler.isScheduled(&second));
+    QCOMPARE(firstRedraws, 0);
+
+    // Each target redrawn once
+    scheduler.flush();
+    QCOMPARE(firstRedraws, 1);
+    QCOMPARE(secondRedraws, 1);
+    QVERIFY(!scheduler.isScheduled(&first));
+
+    QCOMPARE(scheduler.requestCount(), 4);
+    QCOMPARE(scheduler.redrawCount(), 2);
+    QCOMPARE(scheduler.avoidedCount(), 2);
+
+    // Nothing left to redraw
+    scheduler.flush();
+    QCOMPARE(firstRedraws, 1);
+
+    scheduler.resetCounters();
+    QCOMPARE(scheduler.requestCount(), 0);
+    QCOMPARE(scheduler.avoidedCount(), 0);
+}
+
+void Test_RedrawScheduler::testCancel()
+{
+    RedrawScheduler scheduler;
+    int redraws = 0;
+
+    { // Cancelled target is not redrawn
+        QObject target;
+        scheduler.schedule(&target, [&redraws]() { ++redraws; });
+        scheduler.cancel(&target);
+        QVERIFY(!scheduler.isScheduled(&target));
+        scheduler.flush();
+        QCOMPARE(redraws, 0);
+    }
+
+    { // Destroyed target is not redrawn
+        QObject* target = new QObject;
+        scheduler.schedule(target, [&redraws]() { ++redraws; });
+        delete target;
+        scheduler.flush();
+        QCOMPARE(redraws, 0);
+    }
+
+    QCOMPARE(scheduler.avoidedCount(), 2);
+}
+
+void Test_RedrawScheduler::testRescheduleDuringFlush()
+{
+    RedrawScheduler scheduler;
+    QObject target;
+    int redraws = 0;
+
+    // Redraw requesting another redraw is not run again within the same flush
+    std::function<void()> redraw = [&]()
+    {
+        ++redraws;
+        if (redraws == 1)
+            scheduler.schedule(&target, redraw);
+    };
+    scheduler.schedule(&target, redraw);
+
+    scheduler.flush();
+    QCOMPARE(redraws, 1);
+    QVERIFY(scheduler.isScheduled(&target));
+
+    scheduler.flush();
+    QCOMPARE(redraws, 2);
+    QVERIFY(!scheduler.isScheduled(&target));
+}
+
+void Test_RedrawScheduler::testFlushOnEventLoop()
+{
+    RedrawScheduler scheduler;
+    QObject target;
+    int redraws = 0;
+
+    scheduler.schedule(&target, [&redraws]() { ++redraws; });
+    scheduler.schedule(&target, [&redraws]() { ++redraws; });
+    QCOMPARE(redraws, 0);
+
+    // Flushed by the event loop within a frame
+    QTRY_COMPARE_WITH_TIMEOUT(redraws, 1, 10 * RedrawScheduler::FRAME_INTERVAL_MS);
+    QTest::qWait(2 * RedrawScheduler::FRAME_INTERVAL_MS);
+    QCOMPARE(redraws, 1);
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_REDRAWSCHEDULER_H
+#define TEST_REDRAWSCHEDULER_H
+
+#include <QtTest/QtTest>
+
+class Test_RedrawScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCoalescing();
+    void testCancel();
+    void testRescheduleDuringFlush();
+    void testFlushOnEventLoop();
+};
+
+#endif // TEST_REDRAWSCHEDULER_H
@@ -0,0 +1,226 @@
+#include "Test_SceneBaker.h"
+
+#include "../SceneBaker.h"
+#include "../SceneModel.h"
+#include "../CurveModel.h"
+#include "../StepCurveModel.h"
+#include "../pt/math/kb_spline.h"
+#include "UnitTestHelpers.h"
+
+#include <QBuffer>
+#include <QThreadPool>
+#include <QDebug>
+
+void Test_SceneBaker::testSplineCurve()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    auto curve = std::make_shared<CurveModel>("Spline");
+    const PointId first = curve->addPoint(1, 10);
+    curve->addPoint(2, -20);
+    curve->addPoint(4, 30);
+    curve->updatePointParams(first, 0.5f, 0.0f, -0.5f);
+
+    // Reference spline from the same keys
+    pt::math::kb_spline<float> spline;
+    for (auto id : curve->pointIds())
+    {
+        const Point p = curve->point(id);
+        const CurveModel::KbParams params = curve->params(id);
+        spline.data().add(pt::math::kb_data_set<float>::point(id, p.time(), p.value().toFloat(),
+            pt::math::kochanek_bartels_parameters(params.tension(), params.bias(), params.continuity())));
+    }
+
+    // 10 Hz from 0 to 5 seconds
+    const QVector<float> samples = SceneBaker::bakeCurve(curve, 0.0, 10.0, 51);
+    QCOMPARE(samples.size(), 51);
+
+    // Values hold before first and after last key
+    QCOMPARE(samples[0], 10.0f);
+    QCOMPARE(samples[50], 30.0f);
+
+    // Keys are hit exactly
+    QCOMPARE(samples[10], 10.0f);
+    QCOMPARE(samples[20], -20.0f);
+    QCOMPARE(samples[40], 30.0f);
+
+    for (int i = 0; i < samples.size(); ++i)
+        QCOMPARE(samples[i], spline.value_at(i * 0.1f));
+}
+
+void Test_SceneBaker::testStepCurve()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    auto curve = std::make_shared<StepCurveModel>("Step");
+    curve->addPoint(1, 3);
+    curve->addPoint(2, 5);
+    curve->addPoint(2.5, -1);
+
+    const QVector<float> samples = SceneBaker::bakeCurve(curve, 0.0, 4.0, 13);
+    const QVector<float> expected = QVector<float>()
+        << 3 << 3 << 3 << 3 // 0.0 - 0.75, first value
+        << 3 << 3 << 3 << 3 // 1.0 - 1.75
+        << 5 << 5           // 2.0 - 2.25
+        << -1 << -1 << -1;  // 2.5 - 3.0
+    QCOMPARE(samples, expected);
+
+    // Curve without keys is zero
+    auto empty = std::make_shared<StepCurveModel>("Empty");
+    QCOMPARE(SceneBaker::bakeCurve(empty, 0.0, 4.0, 3), QVector<float>() << 0 << 0 << 0);
+}
+
+void Test_SceneBaker::testScene()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    std::shared_ptr<SceneModel> scene = generateScene(8, 100);
+
+    const SceneBaker::Baked baked = SceneBaker::bake(*scene, 30.0);
+    QCOMPARE(baked.sampleRate, 30.0);
+    QCOMPARE(baked.startTime, 0.0);
+    QCOMPARE(baked.sampleCount, 100 * 30 + 1);
+    QCOMPARE(baked.curves.size(), 8);
+
+    // Parallel baking equals baking curves one by one
+    for (int c = 0; c < baked.curves.size(); ++c)
+    {
+        QCOMPARE(baked.curves[c].name, scene->curves()[c]->name());
+        QCOMPARE(baked.curves[c].isStep, (c % 4) == 3);
+        QCOMPARE(baked.curves[c].samples, SceneBaker::bakeCurve(scene->curves()[c], 0.0, 30.0, baked.sampleCount));
+    }
+
+    { // Invalid sample rate
+        EXPECT_ERRORS
+        QVERIFY(SceneBaker::bake(*scene, 0.0).curves.isEmpty());
+    }
+}
+
+void Test_SceneBaker::testWrite()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    std::shared_ptr<SceneModel> scene = generateScene(2, 10);
+    const SceneBaker::Baked baked = SceneBaker::bake(*scene, 2.0);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(SceneBaker::write(baked, buffer));
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream stream(&buffer);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    char magic[4];
+    QCOMPARE(stream.readRawData(magic, 4), 4);
+    QCOMPARE(QByteArray(magic, 4), QByteArray("CEBK"));
+
+    quint32 version, curveCount, sampleCount;
+    stream >> version >> curveCount >> sampleCount;
+    QCOMPARE(version, SceneBaker::FORMAT_VERSION);
+    QCOMPARE(curveCount, 2u);
+    QCOMPARE(sampleCount, 21u);
+
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    double sampleRate, startTime;
+    stream >> sampleRate >> startTime;
+    QCOMPARE(sampleRate, 2.0);
+    QCOMPARE(startTime, 0.0);
+
+    for (quint32 c = 0; c < curveCount; ++c)
+    {
+        quint8 type;
+        quint16 nameLength;
+        stream >> type >> nameLength;
+        QByteArray name(nameLength, '\0');
+        stream.readRawData(name.data(), nameLength);
+        QCOMPARE(type, quint8(0));
+        QCOMPARE(QString::fromUtf8(name), baked.curves[c].name);
+    }
+
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    for (quint32 c = 0; c < curveCount; ++c)
+    {
+        for (quint32 i = 0; i < sampleCount; ++i)
+        {
+            float sample;
+            stream >> sample;
+            QCOMPARE(sample, baked.curves[c].samples[i]);
+        }
+    }
+
+    QVERIFY(buffer.atEnd());
+}
+
+void Test_SceneBaker::testWriteLongName()
+{
+    // Two bytes per character in UTF-8, the length limit falls in the middle of one
+    SceneBaker::Curve curve;
+    curve.name = QString(40000, QChar(0x00e4));
+    curve.isStep = false;
+
+    SceneBaker::Baked baked;
+    baked.sampleRate = 1.0;
+    baked.startTime = 0.0;
+    baked.sampleCount = 0;
+    baked.curves.append(curve);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(SceneBaker::write(baked, buffer));
+    buffer.close();
+
+    // Skip magic, version, counts, sample rate and start time
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(buffer.seek(4 + 3 * 4 + 2 * 8));
+    QDataStream stream(&buffer);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint8 type;
+    quint16 nameLength;
+    stream >> type >> nameLength;
+    QCOMPARE(int(nameLength), 0xfffe);
+    QByteArray name(nameLength, '\0');
+    QCOMPARE(stream.readRawData(name.data(), nameLength), int(nameLength));
+    QCOMPARE(QString::fromUtf8(name), QString(0x7fff, QChar(0x00e4)));
+    QVERIFY(buffer.atEnd());
+}
+
+void Test_SceneBaker::benchmarkBake_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("single thread") << 1;
+    QTest::newRow("all cores") << QThread::idealThreadCount();
+}
+
+void Test_SceneBaker::benchmarkBake()
+{
+    QFETCH(int, threads);
+
+    std::shared_ptr<SceneModel> scene;
+    {
+        SUPPRESS_DEBUG_IN_SCOPE
+        scene = generateScene(64, 2000);
+    }
+
+    const int previousThreads = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    // 1 kHz over 2000 seconds for 64 curves
+    qint64 samples = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        const SceneBaker::Baked baked = SceneBaker::bake(*scene, 1000.0);
+        samples += static_cast<qint64>(baked.sampleCount) * baked.curves.size();
+    }
+
+    const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+    qDebug() << threads << "threads:" << (samples / elapsed / 1000.0) << "M samples/s";
+
+    QThreadPool::globalInstance()->setMaxThreadCount(previousThreads);
+}
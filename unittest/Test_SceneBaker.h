@@ -0,0 +1,21 @@
+#ifndef TEST_SCENEBAKER_H
+#define TEST_SCENEBAKER_H
+
+#include <QtTest/QtTest>
+
+class Test_SceneBaker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSplineCurve();
+    void testStepCurve();
+    void testScene();
+    void testWrite();
+    void testWriteLongName();
+
+    void benchmarkBake_data();
+    void benchmarkBake();
+};
+
+#endif // TEST_SCENEBAKER_H
@@ -2,10 +2,44 @@
 
 #include "../SceneModel.h"
 #include "../CurveModel.h"
+#include "../StepCurveModel.h"
 #include "../EditorModel.h"
 #include "SceneTestReceiver.h"
 #include "UnitTestHelpers.h"
 
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+namespace {
+
+/** Write scene chunks to a file like MainWindow saves scenes */
+bool saveChunks(const SceneModel::Chunks& chunks, const QString& fileName, QVector<SceneModel::CurveBlock>* curveBlocks)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    return SceneModel::writeChunks(chunks, file, curveBlocks) && file.commit();
+}
+
+/** Load a scene file */
+std::shared_ptr<SceneModel> loadScene(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QXmlStreamReader stream(&file);
+    return SceneModel::create(stream);
+}
+
+} // anonymous namespace
+
 void Test_SceneModel::init()
 {
 }
@@ -452,3 +486,358 @@ void Test_SceneModel::testStandardEditors()
     QVERIFY(allCurves->curves().isEmpty());
     QVERIFY(selectedCurves->curves().isEmpty());
 }
+
+void Test_SceneModel::testLoadProgress()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    // Serialize a scene with a few curves
+    QByteArray data;
+    {
+        SceneModel model(RangeF(0, 100));
+        for (int i = 0; i < 3; ++i)
+        {
+            auto curve = std::make_shared<CurveModel>(QString("Curve %1").arg(i));
+            curve->addPoint(10, 0);
+            curve->addPoint(20, 5);
+            model.addCurve(curve);
+        }
+
+        QXmlStreamWriter stream(&data);
+        stream.writeStartDocument("1.0");
+        model.serialize(stream);
+        stream.writeEndDocument();
+    }
+
+    { // Progress is reported for every curve
+        QList<int> reported;
+        QXmlStreamReader stream(data);
+        std::shared_ptr<SceneModel> model = SceneModel::create(stream, [&reported](int curvesRead)
+        {
+            reported.push_back(curvesRead);
+            return true;
+        });
+
+        QVERIFY(model.get());
+        QCOMPARE(model->curves().size(), 3);
+        QCOMPARE(reported, QList<int>() << 1 << 2 << 3);
+    }
+
+    { // Cancel after the first curve
+        QXmlStreamReader stream(data);
+        std::shared_ptr<SceneModel> model = SceneModel::create(stream, [](int curvesRead)
+        {
+            return curvesRead < 1;
+        });
+
+        QVERIFY(!model.get());
+    }
+}
+
+void Test_SceneModel::testModificationTracking()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    SceneModel model(RangeF(0, 100));
+    QVERIFY(!model.isModified());
+
+    auto first = std::make_shared<CurveModel>("First");
+    first->addPoint(10, 0);
+    auto second = std::make_shared<CurveModel>("Second");
+    second->addPoint(20, 5);
+    model.addCurve(first);
+    model.addCurve(second);
+
+    QVERIFY(model.isModified());
+    QCOMPARE(model.dirtyCurves().size(), 2);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    model.setFileName(dir.filePath("scene.xml"));
+
+    // Chunks make up the full scene, unsaved curves are serialized
+    SceneModel::Chunks chunks = model.serializeChunks();
+    QCOMPARE(chunks.revision, model.revision());
+    QCOMPARE(chunks.curves.size(), 2);
+    QVERIFY(!chunks.curves[0].data.isEmpty());
+    QVERIFY(!chunks.curves[1].data.isEmpty());
+
+    QVector<SceneModel::CurveBlock> curveBlocks;
+    QVERIFY(saveChunks(chunks, model.fileName(), &curveBlocks));
+    QCOMPARE(curveBlocks.size(), 2);
+    QCOMPARE(curveBlocks[0].size, qint64(chunks.curves[0].data.size()));
+    QCOMPARE(curveBlocks[1].offset, curveBlocks[0].offset + curveBlocks[0].size);
+
+    std::shared_ptr<SceneModel> loaded = loadScene(model.fileName());
+    QVERIFY(loaded.get());
+    QCOMPARE(loaded->curves().size(), 2);
+    QCOMPARE(loaded->curves()[1]->name(), QString("Second"));
+    QVERIFY(!loaded->isModified());
+
+    model.setSaved(chunks.revision, curveBlocks);
+    QVERIFY(!model.isModified());
+    QVERIFY(model.dirtyCurves().isEmpty());
+
+    // Only the changed curve is serialized, unchanged curve is copied from the saved file
+    second->addPoint(30, 1);
+    QVERIFY(model.isModified());
+    QCOMPARE(model.dirtyCurves(), QList<std::shared_ptr<CurveModelAbs>>() << second);
+
+    SceneModel::Chunks newChunks = model.serializeChunks();
+    QVERIFY(newChunks.curves[0].data.isEmpty());
+    QCOMPARE(newChunks.curves[0].saved.offset, curveBlocks[0].offset);
+    QCOMPARE(newChunks.curves[0].saved.size, curveBlocks[0].size);
+    QVERIFY(!newChunks.curves[1].data.isEmpty());
+
+    QVERIFY(saveChunks(newChunks, model.fileName(), &curveBlocks));
+    loaded = loadScene(model.fileName());
+    QVERIFY(loaded.get());
+    QCOMPARE(loaded->curves().size(), 2);
+    QCOMPARE(loaded->curves()[0]->name(), QString("First"));
+    QCOMPARE(loaded->curves()[0]->numberOfPoints(), 1);
+    QCOMPARE(loaded->curves()[1]->numberOfPoints(), 2);
+
+    // Scene properties dirty the scene but not the curves
+    model.setSaved(newChunks.revision, curveBlocks);
+    model.setBpm(120);
+    QVERIFY(model.isModified());
+    QVERIFY(model.dirtyCurves().isEmpty());
+
+    SceneModel::Chunks copiedChunks = model.serializeChunks();
+    QVERIFY(copiedChunks.curves[0].data.isEmpty());
+    QVERIFY(copiedChunks.curves[1].data.isEmpty());
+
+    // Saved file rewritten with the same size, all curves are serialized again
+    {
+        QFile rewritten(model.fileName());
+        QVERIFY(rewritten.open(QIODevice::ReadWrite));
+        const QByteArray content = rewritten.readAll();
+        QVERIFY(rewritten.seek(0));
+        QCOMPARE(rewritten.write(QByteArray(content.size(), ' ')), qint64(content.size()));
+        QVERIFY(rewritten.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    }
+    SceneModel::Chunks rewrittenChunks = model.serializeChunks();
+    QVERIFY(!rewrittenChunks.curves[0].data.isEmpty());
+    QVERIFY(!rewrittenChunks.curves[1].data.isEmpty());
+
+    // Chunks taken before the file changed are not written from it
+    QBuffer stale;
+    QVERIFY(stale.open(QIODevice::WriteOnly));
+    QVERIFY(!SceneModel::writeChunks(copiedChunks, stale));
+
+    // Saved file replaced by someone else, all curves are serialized again
+    QFile replaced(model.fileName());
+    QVERIFY(replaced.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    replaced.close();
+    SceneModel::Chunks fullChunks = model.serializeChunks();
+    QVERIFY(!fullChunks.curves[0].data.isEmpty());
+    QVERIFY(!fullChunks.curves[1].data.isEmpty());
+}
+
+void Test_SceneModel::testSerializeChunkSource()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    SceneModel model(RangeF(0, 100));
+    auto spline = std::make_shared<CurveModel>("Spline");
+    spline->setValueRange(RangeF(-50, 50));
+    const PointId key = spline->addPoint(10, 20);
+    spline->updatePointParams(key, 0.5f, -0.25f, 0.75f);
+    auto step = std::make_shared<StepCurveModel>("Step");
+    step->setOptions(StepCurveModel::Options { { 1, "One" }, { 2, "Two" } });
+    step->addPoint(5, 2);
+    model.addCurve(spline);
+    model.addCurve(step);
+
+    // Source keeps the scene as it was when taken
+    const SceneModel::ChunkSource source = model.chunkSource();
+    spline->setValueRange(RangeF(0, 10));
+    spline->addPoint(30, 5);
+    step->setOptions(StepCurveModel::Options { { 3, "Three" } });
+    QVERIFY(model.revision() > source.scene->revision());
+
+    const SceneModel::Chunks chunks = SceneModel::serializeChunks(source);
+    QCOMPARE(chunks.revision, source.scene->revision());
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(SceneModel::writeChunks(chunks, buffer));
+
+    QXmlStreamReader stream(buffer.data());
+    std::shared_ptr<SceneModel> loaded = SceneModel::create(stream);
+    QVERIFY(loaded.get());
+    QCOMPARE(loaded->curves().size(), 2);
+
+    auto loadedSpline = CurveModelAbs::getAsSplineCurve(loaded->curves()[0]);
+    QVERIFY(loadedSpline.get());
+    QCOMPARE(loadedSpline->valueRange(), RangeF(-50, 50));
+    QCOMPARE(loadedSpline->numberOfPoints(), 1);
+    const PointId loadedKey = loadedSpline->pointIds().first();
+    QCOMPARE(loadedSpline->point(loadedKey).value().toFloat(), 20.0f);
+    QCOMPARE(loadedSpline->params(loadedKey).tension(), 0.5f);
+    QCOMPARE(loadedSpline->params(loadedKey).bias(), -0.25f);
+    QCOMPARE(loadedSpline->params(loadedKey).continuity(), 0.75f);
+
+    auto loadedStep = CurveModelAbs::getAsStepCurve(loaded->curves()[1]);
+    QVERIFY(loadedStep.get());
+    QCOMPARE(loadedStep->options().size(), 2);
+    QCOMPARE(loadedStep->point(loadedStep->pointIds().first()).value().toInt(), 2);
+}
+
+void Test_SceneModel::testEvaluate()
+{
+    SceneModel model(RangeF(0, 100));
+
+    std::shared_ptr<CurveModel> spline(new CurveModel("Spline"));
+    spline->addPoint(10, 0);
+    spline->addPoint(20, 50);
+    spline->addPoint(30, -50);
+    model.addCurve(spline);
+
+    std::shared_ptr<StepCurveModel> step(new StepCurveModel("Step"));
+    StepCurveModel::Options options;
+    options.insert(0, "Off");
+    options.insert(1, "On");
+    step->setOptions(options);
+    step->addPoint(15, 1);
+    step->addPoint(25, 0);
+    model.addCurve(step);
+
+    const int curveCount = model.curves().size();
+    QCOMPARE(curveCount, 2);
+
+    // Values in the order of curves
+    QVector<float> values(curveCount);
+    model.evaluate(20.0f, values.data());
+    for (int c = 0; c < curveCount; ++c)
+        QCOMPARE(values[c], model.curves()[c]->valueAt(20.0f));
+
+    // Forward, backward and repeated times match single curve evaluation
+    QVector<float> times;
+    for (int i = 0; i <= 400; ++i)
+        times.append(i * 0.1f);
+    times << 5.0f << 35.0f << 12.5f << 12.5f << 30.0f;
+    values.resize(times.size() * curveCount);
+    model.evaluate(times.constData(), times.size(), values.data());
+    for (int t = 0; t < times.size(); ++t)
+    {
+        for (int c = 0; c < curveCount; ++c)
+            QCOMPARE(values[t * curveCount + c], model.curves()[c]->valueAt(times[t]));
+    }
+
+    // Cached intervals stay valid after the curve changes
+    spline->addPoint(12, 20);
+    model.evaluate(12.5f, values.data());
+    QCOMPARE(values[model.curves().indexOf(spline)], spline->valueAt(12.5f));
+
+    // Cursors follow their curves when curves are removed and added
+    std::shared_ptr<CurveModel> other(new CurveModel("Other"));
+    other->addPoint(0, 100);
+    other->addPoint(50, -100);
+    model.removeCurve(spline);
+    model.addCurve(other);
+    model.addCurve(spline);
+    values.fill(0.0f);
+    model.evaluate(12.5f, values.data());
+    for (int c = 0; c < model.curves().size(); ++c)
+        QCOMPARE(values[c], model.curves()[c]->valueAt(12.5f));
+}
+
+void Test_SceneModel::testEvaluateParallel()
+{
+    SceneModel model(RangeF(0, 100));
+    for (int c = 0; c < 200; ++c)
+    {
+        std::shared_ptr<CurveModel> curve(new CurveModel(QString::number(c)));
+        for (int i = 0; i <= 100; i += 5)
+            curve->addPoint(i, (i * c) % 100 - 50);
+        model.addCurve(curve);
+    }
+
+    // Enough evaluations to use the thread pool
+    QVector<float> times;
+    for (int i = 0; i < 1000; ++i)
+        times.append(i * 0.1f);
+    QVERIFY(times.size() * model.curves().size() >= SceneModel::PARALLEL_EVALUATION_THRESHOLD);
+
+    QVector<float> values(times.size() * model.curves().size());
+    model.evaluate(times.constData(), times.size(), values.data());
+
+    const int curveCount = model.curves().size();
+    for (int t = 0; t < times.size(); t += 37)
+    {
+        for (int c = 0; c < curveCount; ++c)
+            QCOMPARE(values[t * curveCount + c], model.curves()[c]->valueAt(times[t]));
+    }
+}
+
+void Test_SceneModel::benchmarkEvaluate_data()
+{
+    QTest::addColumn<int>("curveCount");
+
+    QTest::newRow("10 curves") << 10;
+    QTest::newRow("1000 curves") << 1000;
+}
+
+void Test_SceneModel::benchmarkEvaluate()
+{
+    QFETCH(int, curveCount);
+
+    SceneModel model(RangeF(0, 100));
+    for (int c = 0; c < curveCount; ++c)
+    {
+        std::shared_ptr<CurveModel> curve(new CurveModel(QString::number(c)));
+        for (int i = 0; i <= 100; ++i)
+            curve->addPoint(i, (i * c) % 100 - 50);
+        model.addCurve(curve);
+    }
+
+    // One second of playback at 60 frames per second
+    QVector<float> values(curveCount);
+    QBENCHMARK
+    {
+        for (int frame = 0; frame < 60; ++frame)
+            model.evaluate(frame / 60.0f, values.data());
+    }
+}
+
+void Test_SceneModel::benchmarkSave_data()
+{
+    QTest::addColumn<bool>("packedKeys");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("packed") << true;
+}
+
+void Test_SceneModel::benchmarkSave()
+{
+    QFETCH(bool, packedKeys);
+
+    // Scene of 1M keys in four curves
+    const int curveCount = 4;
+    const int keysPerCurve = 250000;
+
+    SceneModel model(RangeF(0, keysPerCurve));
+    {
+        SUPPRESS_DEBUG_IN_SCOPE
+
+        for (int c = 0; c < curveCount; ++c)
+        {
+            auto curve = std::make_shared<CurveModel>(QString("Curve %1").arg(c));
+            for (int i = 0; i < keysPerCurve; ++i)
+                curve->addPoint(i, static_cast<float>((i * 7 + c) % 200 - 100));
+            model.addCurve(curve);
+        }
+        model.setPackedKeys(packedKeys);
+    }
+
+    QByteArray data;
+    QBENCHMARK {
+        // Full save, the scene is never marked saved
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(SceneModel::writeChunks(model.serializeChunks(), buffer));
+    }
+
+    qDebug() << "Saved" << curveCount * keysPerCurve << "keys," << data.size() << "bytes";
+}
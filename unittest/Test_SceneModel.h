@@ -17,6 +17,16 @@ private slots:
     void testTimeRange();
     void testBeat();
     void testStandardEditors();
+    void testLoadProgress();
+    void testModificationTracking();
+    void testSerializeChunkSource();
+    void testEvaluate();
+    void testEvaluateParallel();
+
+    void benchmarkEvaluate_data();
+    void benchmarkEvaluate();
+    void benchmarkSave_data();
+    void benchmarkSave();
 };
 
 #endif // TEST_SCENEMODEL_H
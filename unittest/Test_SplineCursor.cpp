@@ -0,0 +1,104 @@
+#include "Test_SplineCursor.h"
+
+#include "../pt/math/kb_spline.h"
+#include "../pt/math/spline_cursor.h"
+#include "UnitTestHelpers.h"
+
+#include <QDebug>
+
+namespace {
+
+using Spline = pt::math::kb_spline<float>;
+using Cursor = pt::math::spline_cursor<Spline>;
+
+}
+
+void Test_SplineCursor::testSequential()
+{
+    const Spline spline = makeTestSpline(100);
+    Cursor cursor(spline);
+    QVERIFY(cursor.spline() == &spline);
+
+    // Forward and backward, within and outside the keys
+    for (float time = -1.0f; time < 51.0f; time += 0.01f)
+        QCOMPARE(cursor.value_at(time), spline.value_at(time));
+    for (float time = 51.0f; time > -1.0f; time -= 0.07f)
+        QCOMPARE(cursor.value_at(time), spline.value_at(time));
+
+    // Exactly at keys
+    for (int i = 0; i < 100; ++i)
+        QCOMPARE(cursor.value_at(i * 0.5f), spline.value_at(i * 0.5f));
+}
+
+void Test_SplineCursor::testSeek()
+{
+    const Spline spline = makeTestSpline(1000);
+    Cursor cursor(spline);
+
+    const float times[] = { 400.25f, 3.1f, 499.0f, 250.0f, 250.1f, 0.2f, 600.0f, 12.0f };
+    for (float time : times)
+        QCOMPARE(cursor.value_at(time), spline.value_at(time));
+
+    cursor.reset();
+    QCOMPARE(cursor.value_at(300.3f), spline.value_at(300.3f));
+}
+
+void Test_SplineCursor::testSharedTimes()
+{
+    // Points sharing a time, the first of them is used like in value_at
+    Spline spline;
+    addSplineKey(spline, 0, 0);
+    addSplineKey(spline, 1, 10);
+    addSplineKey(spline, 1, 20);
+    addSplineKey(spline, 2, 0);
+
+    Cursor cursor(spline);
+    for (float time = 2.5f; time > -0.5f; time -= 0.25f)
+        QCOMPARE(cursor.value_at(time), spline.value_at(time));
+    QCOMPARE(cursor.value_at(1.0f), 10.0f);
+}
+
+void Test_SplineCursor::testSplineChanges()
+{
+    Spline spline = makeTestSpline(100);
+    Cursor cursor(spline);
+    QCOMPARE(cursor.value_at(45.2f), spline.value_at(45.2f));
+
+    // Previous interval no longer exists
+    while (spline.data().size() > 10)
+        spline.data().erase(spline.data().end() - 1);
+    QCOMPARE(cursor.value_at(3.3f), spline.value_at(3.3f));
+    QCOMPARE(cursor.value_at(45.2f), spline.value_at(45.2f));
+
+    addSplineKey(spline, 3.25f, 100.0f);
+    QCOMPARE(cursor.value_at(3.3f), spline.value_at(3.3f));
+}
+
+void Test_SplineCursor::benchmarkPlayback_data()
+{
+    QTest::addColumn<bool>("useCursor");
+
+    QTest::newRow("value_at") << false;
+    QTest::newRow("cursor") << true;
+}
+
+void Test_SplineCursor::benchmarkPlayback()
+{
+    QFETCH(bool, useCursor);
+
+    // Ten minutes at 60 frames per second over a key every half second
+    const Spline spline = makeTestSpline(1200);
+    Cursor cursor(spline);
+    const int frameCount = 600 * 60;
+
+    float sum = 0.0f;
+    QBENCHMARK
+    {
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            const float time = frame / 60.0f;
+            sum += useCursor ? cursor.value_at(time) : spline.value_at(time);
+        }
+    }
+    QVERIFY(!std::isnan(sum));
+}
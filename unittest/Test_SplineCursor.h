@@ -0,0 +1,20 @@
+#ifndef TEST_SPLINECURSOR_H
+#define TEST_SPLINECURSOR_H
+
+#include <QtTest/QtTest>
+
+class Test_SplineCursor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSequential();
+    void testSeek();
+    void testSharedTimes();
+    void testSplineChanges();
+
+    void benchmarkPlayback_data();
+    void benchmarkPlayback();
+};
+
+#endif // TEST_SPLINECURSOR_H
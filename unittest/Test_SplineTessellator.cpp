@@ -0,0 +1,187 @@
+#include "Test_SplineTessellator.h"
+
+#include "../SplineTessellator.h"
+#include "UnitTestHelpers.h"
+
+#include <QDebug>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <cmath>
+
+namespace {
+
+using Spline = SplineTessellator::Spline;
+
+/** @return Maximum distance in pixels between line strip and spline */
+double maxPixelError(const Spline& spline, const QPolygonF& lines, float valueScale)
+{
+    double maxError = 0.0;
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        const QPointF a = lines[i - 1];
+        const QPointF b = lines[i];
+        for (int j = 1; j < 16; ++j)
+        {
+            const double f = j / 16.0;
+            const double time = a.x() + (b.x() - a.x()) * f;
+            const double lineValue = a.y() + (b.y() - a.y()) * f;
+            const double error = std::fabs(spline.value_at(static_cast<float>(time)) - lineValue) * valueScale;
+            maxError = std::max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+} // anonymous namespace
+
+void Test_SplineTessellator::testStraightLine()
+{
+    Spline spline;
+    addSplineKey(spline, 0, 0);
+    addSplineKey(spline, 10, 10);
+
+    // Two point spline is a straight line regardless of zoom
+    SplineTessellator tessellator(100.0f, 100.0f);
+    QCOMPARE(tessellator.steps(spline, 0), 1);
+
+    const QPolygonF lines = tessellator.tessellate(spline);
+    QCOMPARE(lines.size(), 2);
+    QCOMPARE(lines[0], QPointF(0, 0));
+    QCOMPARE(lines[1], QPointF(10, 10));
+}
+
+void Test_SplineTessellator::testErrorTolerance_data()
+{
+    QTest::addColumn<float>("timeScale");
+
+    // Zoom levels where segments are wide enough for the error bound to decide step count
+    QTest::newRow("100 px/s") << 100.0f;
+    QTest::newRow("1000 px/s") << 1000.0f;
+}
+
+void Test_SplineTessellator::testErrorTolerance()
+{
+    QFETCH(float, timeScale);
+
+    const Spline spline = makeTestSpline(200);
+    const float valueScale = 4.0f;
+    const float tolerance = 0.25f;
+
+    SplineTessellator tessellator(timeScale, valueScale, tolerance);
+    const QPolygonF lines = tessellator.tessellate(spline);
+
+    // Vertices pass through keys
+    QCOMPARE(lines.first().x(), 0.0);
+    QCOMPARE(lines.last().x(), 199 * 0.5);
+
+    QVERIFY(maxPixelError(spline, lines, valueScale) <= tolerance * 1.01);
+}
+
+void Test_SplineTessellator::testPixelLimit()
+{
+    const Spline spline = makeTestSpline(100);
+
+    // Highly curved segments get no more lines than they cover pixels
+    SplineTessellator tessellator(4.0f, 1000.0f);
+    for (int i = 0; i < 99; ++i)
+        QVERIFY(tessellator.steps(spline, i) <= 2);
+
+    // Zoomed out, a line per segment
+    tessellator.setScale(0.1f, 1000.0f);
+    QCOMPARE(tessellator.tessellate(spline).size(), 100);
+}
+
+void Test_SplineTessellator::testEnvelope()
+{
+    const Spline spline = makeTestSpline(100);
+
+    // Nothing outside the spline
+    QVERIFY(!SplineTessellator::envelope(spline, -10, -1).isValid());
+    QVERIFY(!SplineTessellator::envelope(spline, 50, 60).isValid());
+
+    // Envelope bounds densely sampled values and is reached by them
+    for (float start = -1.0f; start < 50.0f; start += 3.7f)
+    {
+        const float end = start + 2.3f;
+        const RangeF envelope = SplineTessellator::envelope(spline, start, end);
+        QVERIFY(envelope.isValid());
+
+        const float first = qMax(start, 0.0f);
+        RangeF sampled;
+        for (int i = 0; i <= 1000; ++i)
+        {
+            const float value = spline.value_at(first + (end - first) * i / 1000.0f);
+            sampled = RangeF::makeUnion(sampled, RangeF(value, value));
+        }
+
+        QVERIFY(envelope.min <= sampled.min + 1e-3f);
+        QVERIFY(envelope.max >= sampled.max - 1e-3f);
+        QVERIFY(envelope.min >= sampled.min - 0.01f);
+        QVERIFY(envelope.max <= sampled.max + 0.01f);
+    }
+}
+
+void Test_SplineTessellator::benchmarkTessellate_data()
+{
+    QTest::addColumn<float>("timeScale");
+
+    QTest::newRow("0.1 px/s") << 0.1f;
+    QTest::newRow("1 px/s") << 1.0f;
+    QTest::newRow("10 px/s") << 10.0f;
+    QTest::newRow("100 px/s") << 100.0f;
+}
+
+void Test_SplineTessellator::benchmarkTessellate()
+{
+    QFETCH(float, timeScale);
+
+    // 20k keys in a 400 pixel high view
+    const int keyCount = 20000;
+    const Spline spline = makeTestSpline(keyCount);
+    SplineTessellator tessellator(timeScale, 400.0f / 100.0f);
+
+    QPolygonF lines;
+    QBENCHMARK {
+        lines = tessellator.tessellate(spline);
+    }
+
+    // Fixed tessellation used 20 lines per segment
+    qDebug() << "Vertices" << lines.size() << "for" << keyCount * 0.5 * timeScale << "pixels, fixed 20 per segment would be" << (keyCount - 1) * 20 + 1;
+}
+
+void Test_SplineTessellator::benchmarkFrame_data()
+{
+    benchmarkTessellate_data();
+}
+
+void Test_SplineTessellator::benchmarkFrame()
+{
+    QFETCH(float, timeScale);
+
+    // 20k keys in a 800x400 pixel view, values [-50, 50] fill the height
+    const int keyCount = 20000;
+    const Spline spline = makeTestSpline(keyCount);
+    const QSize viewSize(800, 400);
+    const float valueScale = viewSize.height() / 100.0f;
+    SplineTessellator tessellator(timeScale, valueScale);
+
+    QImage frame(viewSize, QImage::Format_ARGB32_Premultiplied);
+    const QTransform toView = QTransform::fromScale(timeScale, -valueScale) * QTransform::fromTranslate(0, viewSize.height() / 2.0);
+    QPen pen(Qt::black);
+    pen.setCosmetic(true);
+
+    // Frame like a curve view redraw: tessellate, build the path and paint it antialiased
+    QBENCHMARK {
+        const QPolygonF lines = tessellator.tessellate(spline);
+        QPainterPath path;
+        path.addPolygon(lines);
+
+        frame.fill(Qt::white);
+        QPainter painter(&frame);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+        painter.setTransform(toView);
+        painter.setPen(pen);
+        painter.drawPath(path);
+    }
+}
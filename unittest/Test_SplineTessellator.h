@@ -0,0 +1,23 @@
+#ifndef TEST_SPLINETESSELLATOR_H
+#define TEST_SPLINETESSELLATOR_H
+
+#include <QtTest/QtTest>
+
+class Test_SplineTessellator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStraightLine();
+    void testErrorTolerance_data();
+    void testErrorTolerance();
+    void testPixelLimit();
+    void testEnvelope();
+
+    void benchmarkTessellate_data();
+    void benchmarkTessellate();
+    void benchmarkFrame_data();
+    void benchmarkFrame();
+};
+
+#endif // TEST_SPLINETESSELLATOR_H
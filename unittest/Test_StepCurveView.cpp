@@ -0,0 +1,129 @@
+#include "Test_StepCurveView.h"
+
+#include "../StepCurveModel.h"
+#include "../StepCurveView.h"
+#include "UnitTestHelpers.h"
+
+#include <QDebug>
+
+namespace
+{
+
+/** @return Options 0..count-1 */
+StepCurveModel::Options makeOptions(int count)
+{
+    StepCurveModel::Options options;
+    for (int i = 0; i < count; ++i)
+        options.insert(i, QString::number(i));
+    return options;
+}
+
+}
+
+void Test_StepCurveView::testStepLines()
+{
+    StepCurveModel curve("Name");
+    curve.setOptions(makeOptions(3));
+    QVERIFY(StepCurveView::stepLines(curve, RangeF(0, 10)).isEmpty());
+
+    curve.addPoint(0, 0);
+    curve.addPoint(1, 2);
+    curve.addPoint(2, 1);
+    curve.addPoint(3, 0);
+
+    // Horizontal hold and vertical step for each point after the first
+    QPolygonF expected;
+    expected << QPointF(0, 0)
+             << QPointF(1, 0) << QPointF(1, 2)
+             << QPointF(2, 2) << QPointF(2, 1)
+             << QPointF(3, 1) << QPointF(3, 0);
+    QCOMPARE(StepCurveView::stepLines(curve, RangeF(0, 3)), expected);
+
+    // Steps crossing the range edges are included
+    QPolygonF middle;
+    middle << QPointF(1, 2)
+           << QPointF(2, 2) << QPointF(2, 1);
+    QCOMPARE(StepCurveView::stepLines(curve, RangeF(1.5f, 1.8f)), middle);
+
+    // Invalid range has no lines
+    QVERIFY(StepCurveView::stepLines(curve, RangeF()).isEmpty());
+}
+
+void Test_StepCurveView::testDuplicateSelectedPoints()
+{
+    SUPPRESS_DEBUG_IN_SCOPE
+
+    // Enough selected points in several curves to place new points in the thread pool
+    const int curveCount = 3;
+    const int pointCount = CurveViewAbs::PARALLEL_DUPLICATE_THRESHOLD / 2;
+    QVERIFY(curveCount * pointCount >= CurveViewAbs::PARALLEL_DUPLICATE_THRESHOLD);
+
+    QList<std::shared_ptr<StepCurveModel>> curves;
+    QList<CurveViewAbs*> views;
+    for (int c = 0; c < curveCount; ++c)
+    {
+        std::shared_ptr<StepCurveModel> curve(new StepCurveModel(QString::number(c)));
+        curve->setOptions(makeOptions(3));
+
+        QVector<CurveModelAbs::NewPoint> points;
+        for (int i = 0; i < pointCount; ++i)
+            points.append(CurveModelAbs::NewPoint(i, (i + c) % 3));
+        for (PointId id : curve->addPoints(points))
+            curve->pointSelectedChanged(id, true);
+
+        curves.append(curve);
+        views.append(StepCurveView::create(curve, nullptr));
+    }
+
+    CurveViewAbs::duplicateSelectedPoints(views);
+
+    // New point halfway to the next point with the same value, last one a second after the last point
+    for (int c = 0; c < curveCount; ++c)
+    {
+        const QList<Point> points = curves[c]->points();
+        QCOMPARE(points.size(), 2 * pointCount);
+        for (int i = 0; i < pointCount; ++i)
+        {
+            const Point& original = points[2 * i];
+            const Point& added = points[2 * i + 1];
+            const float addedTime = i + 1 < pointCount ? i + 0.5f : i + 1.0f;
+            QCOMPARE(original.time(), float(i));
+            QCOMPARE(added.time(), addedTime);
+            QCOMPARE(added.value().toInt(), (i + c) % 3);
+            QVERIFY(!added.isSelected());
+        }
+    }
+
+    qDeleteAll(views);
+}
+
+void Test_StepCurveView::benchmarkRedraw_data()
+{
+    QTest::addColumn<int>("stepCount");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void Test_StepCurveView::benchmarkRedraw()
+{
+    QFETCH(int, stepCount);
+
+    StepCurveModel curve("Name");
+    curve.setOptions(makeOptions(4));
+
+    QList<PointId> ids;
+    for (int i = 0; i < stepCount; ++i)
+        ids.append(curve.addPoint(i, i % 4));
+
+    // Point change followed by a redraw of the whole curve
+    const PointId moved = ids[stepCount / 2];
+    QPolygonF lines;
+    int value = 0;
+    QBENCHMARK {
+        value = (value + 1) % 4;
+        curve.updatePoint(moved, curve.point(moved).time(), value);
+        lines = StepCurveView::stepLines(curve, RangeF(0, stepCount));
+    }
+    QCOMPARE(lines.size(), 2 * stepCount - 1);
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_STEPCURVEVIEW_H
+#define TEST_STEPCURVEVIEW_H
+
+#include <QtTest/QtTest>
+
+class Test_StepCurveView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStepLines();
+    void testDuplicateSelectedPoints();
+
+    void benchmarkRedraw_data();
+    void benchmarkRedraw();
+};
+
+#endif // TEST_STEPCURVEVIEW_H
@@ -1,5 +1,10 @@
 #include "UnitTestHelpers.h"
 
+#include "../SceneModel.h"
+#include "../CurveModel.h"
+#include "../StepCurveModel.h"
+#include <cmath>
+
 namespace {
 
 /** Current error count */
@@ -69,3 +74,46 @@ ExpectErrors::~ExpectErrors()
     QVERIFY2(m_startErrorCount < g_errorCount, msgBuffer);
     qInstallMessageHandler(m_prevHandler);
 }
+
+
+////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////
+
+void addSplineKey(TestSpline& spline, float time, float value)
+{
+    spline.data().add(pt::math::kb_data_set<float>::point(PointId::generateId(), time, value,
+        pt::math::kochanek_bartels_parameters(0.0f, 0.0f, 0.0f)));
+}
+
+TestSpline makeTestSpline(int keyCount)
+{
+    TestSpline spline;
+    for (int i = 0; i < keyCount; ++i)
+        addSplineKey(spline, i * 0.5f, static_cast<float>(std::sin(i * 0.7) * 50.0));
+    return spline;
+}
+
+std::shared_ptr<SceneModel> generateScene(int curveCount, int keysPerCurve, double keyInterval, double firstKeyTime)
+{
+    auto scene = std::make_shared<SceneModel>(RangeF(0, static_cast<float>(firstKeyTime + keysPerCurve * keyInterval)));
+
+    for (int c = 0; c < curveCount; ++c)
+    {
+        if (c % 4 == 3)
+        {
+            auto curve = std::make_shared<StepCurveModel>(QString("Step %1").arg(c));
+            for (int i = 0; i < keysPerCurve; ++i)
+                curve->addPoint(static_cast<float>(firstKeyTime + i * keyInterval), (i / 8) % 5);
+            scene->addCurve(curve);
+        }
+        else
+        {
+            auto curve = std::make_shared<CurveModel>(QString("Spline %1").arg(c));
+            for (int i = 0; i < keysPerCurve; ++i)
+                curve->addPoint(static_cast<float>(firstKeyTime + i * keyInterval), static_cast<float>(std::sin(i * 0.1 + c) * 50.0));
+            scene->addCurve(curve);
+        }
+    }
+
+    return scene;
+}
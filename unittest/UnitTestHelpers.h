@@ -1,8 +1,12 @@
 #ifndef UNITTESTHELPERS_H
 #define UNITTESTHELPERS_H
 
+#include "../pt/math/kb_spline.h"
 #include <QtTest/QtTest>
 #include <QDebug>
+#include <memory>
+
+class SceneModel;
 
 /**
  * @brief Output message handler to suppress any debug prints.
@@ -68,4 +72,33 @@ private:
 
 #define EXPECT_ERRORS ExpectErrors expectErrorsStartingFromLine(__FILE__, __LINE__);
 
+/** Spline made by the spline helpers */
+using TestSpline = pt::math::kb_spline<float>;
+
+/**
+ * @brief Add a key with default KB params to a spline
+ * @param spline Spline
+ * @param time Key time
+ * @param value Key value
+ */
+void addSplineKey(TestSpline& spline, float time, float value);
+
+/**
+ * @brief Make a spline with a key every half second, values jumping around [-50, 50]
+ * @param keyCount Number of keys
+ * @return The spline
+ */
+TestSpline makeTestSpline(int keyCount);
+
+/**
+ * @brief Generate a scene of spline curves with every fourth curve a step curve.
+ * Spline values follow a sine around [-50, 50], step values cycle through 0..4 every 8 keys.
+ * @param curveCount Number of curves
+ * @param keysPerCurve Number of keys in each curve
+ * @param keyInterval Time between keys
+ * @param firstKeyTime Time of the first key
+ * @return Scene with time range from 0 to the end of the keys
+ */
+std::shared_ptr<SceneModel> generateScene(int curveCount, int keysPerCurve, double keyInterval = 1.0, double firstKeyTime = 0.0);
+
 #endif // UNITTESTHELPERS_H
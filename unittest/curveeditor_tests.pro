@@ -21,7 +21,17 @@ SOURCES += maintest.cpp \
     UnitTestHelpers.cpp \
     Test_CurveModel.cpp \
     Test_SceneModel.cpp \
-    Test_EditorModel.cpp
+    Test_EditorModel.cpp \
+    Test_CurveKeyCodec.cpp \
+    Test_SceneBaker.cpp \
+    Test_SplineTessellator.cpp \
+    Test_MinMaxPyramid.cpp \
+    Test_StepCurveView.cpp \
+    Test_RedrawScheduler.cpp \
+    Test_CurveGeometry.cpp \
+    Test_SplineCursor.cpp \
+    Test_CurveSnapshot.cpp \
+    Test_PointHandleLayer.cpp
 
 HEADERS += \
     UnitTestHelpers.h \
@@ -30,5 +40,15 @@ HEADERS += \
     Test_SceneModel.h \
     SceneTestReceiver.h \
     Test_EditorModel.h \
-    EditorTestReceiver.h
+    EditorTestReceiver.h \
+    Test_CurveKeyCodec.h \
+    Test_SceneBaker.h \
+    Test_SplineTessellator.h \
+    Test_MinMaxPyramid.h \
+    Test_StepCurveView.h \
+    Test_RedrawScheduler.h \
+    Test_CurveGeometry.h \
+    Test_SplineCursor.h \
+    Test_CurveSnapshot.h \
+    Test_PointHandleLayer.h
 
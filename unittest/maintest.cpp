@@ -3,9 +3,22 @@
 #include "Test_CurveModel.h"
 #include "Test_SceneModel.h"
 #include "Test_EditorModel.h"
+#include "Test_CurveKeyCodec.h"
+#include "Test_SceneBaker.h"
+#include "Test_SplineTessellator.h"
+#include "Test_MinMaxPyramid.h"
+#include "Test_StepCurveView.h"
+#include "Test_RedrawScheduler.h"
+#include "Test_CurveGeometry.h"
+#include "Test_SplineCursor.h"
+#include "Test_CurveSnapshot.h"
+#include "Test_PointHandleLayer.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+    // Event loop for tests relying on timers
+    QCoreApplication app(argc, argv);
+
     {
         Test_CurveModel test;
         QTest::qExec(&test);
@@ -18,6 +31,46 @@ int main()
         Test_EditorModel test;
         QTest::qExec(&test);
     }
+    {
+        Test_CurveKeyCodec test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_SceneBaker test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_SplineTessellator test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_MinMaxPyramid test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_StepCurveView test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_RedrawScheduler test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_CurveGeometry test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_SplineCursor test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_CurveSnapshot test;
+        QTest::qExec(&test);
+    }
+    {
+        Test_PointHandleLayer test;
+        QTest::qExec(&test);
+    }
 
     return 0;
 }